@@ -0,0 +1,430 @@
+/*
+    性能测试：生成几类有代表性的文本 分别测量解析、生成和释放的速度
+    用法：cjson_bench [-n 次数] [-s 每类文本的MB数] [-j 结果JSON文件]
+    需要用Release方式构建(cmake -DCMAKE_BUILD_TYPE=Release) 否则测量的是未优化的代码
+    每项测量重复多次 报告中位数和p99 结果同时写成JSON便于比较不同版本
+*/
+
+/* clock_gettime() getrusage() 必须在包含任何头文件之前声明*/
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "leptjson.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h> /* getrusage() */
+    #define BENCH_HAVE_RUSAGE
+#endif
+
+/*
+    通过lept_set_allocator()统计库申请内存的次数(alloc和realloc) 基准程序自己的内存不计入
+    多线程解析NDJSON时各线程同时申请 计数是原子的
+*/
+#if defined(__GNUC__) || defined(__clang__)
+    #define BENCH_ATOMIC_INC(p) __atomic_add_fetch(p, 1, __ATOMIC_RELAXED)
+    #define BENCH_ATOMIC_LOAD(p) __atomic_load_n(p, __ATOMIC_RELAXED)
+#elif defined(_MSC_VER)
+    #include <intrin.h> /* _InterlockedIncrement() */
+    #define BENCH_ATOMIC_INC(p) _InterlockedIncrement(p)
+    #define BENCH_ATOMIC_LOAD(p) (*(volatile long*)(p))
+#else
+    /* 没有原子操作时ndjson_mt的计数可能偏少*/
+    #define BENCH_ATOMIC_INC(p) (++*(p))
+    #define BENCH_ATOMIC_LOAD(p) (*(p))
+#endif
+
+static long bench_allocs = 0;
+
+static void* bench_alloc(void* user, size_t size) {
+    (void)user;
+    BENCH_ATOMIC_INC(&bench_allocs);
+    return malloc(size);
+}
+
+static void* bench_realloc(void* user, void* p, size_t size) {
+    (void)user;
+    BENCH_ATOMIC_INC(&bench_allocs);
+    return realloc(p, size);
+}
+
+static void bench_dealloc(void* user, void* p) {
+    (void)user;
+    free(p);
+}
+
+static const lept_allocator bench_allocator = { bench_alloc, bench_realloc, bench_dealloc, NULL };
+
+#define BENCH_ALLOCS() BENCH_ATOMIC_LOAD(&bench_allocs)
+
+/* 文本生成用的伪随机数 固定种子 每次生成的文本相同*/
+static uint64_t bench_seed = 88172645463325252u;
+
+static unsigned bench_rand(void) {
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 7;
+    bench_seed ^= bench_seed << 17;
+    return (unsigned)(bench_seed >> 32);
+}
+
+/* 生成文本用的缓冲区 按2倍增长*/
+typedef struct {
+    char* s;
+    size_t len, size;
+} bench_buffer;
+
+static void bench_puts(bench_buffer* b, const char* s, size_t len) {
+    if (b->len + len + 1 > b->size) {
+        while (b->len + len + 1 > b->size) {
+            b->size = b->size ? b->size * 2 : 4096;
+        }
+        b->s = (char*)realloc(b->s, b->size);
+    }
+    memcpy(b->s + b->len, s, len);
+    b->len += len;
+    b->s[b->len] = '\0';
+}
+
+static void bench_printf(bench_buffer* b, const char* format, double n) {
+    char buf[64];
+    bench_puts(b, buf, (size_t)sprintf(buf, format, n));
+}
+
+static void bench_append(bench_buffer* b, const char* s) {
+    bench_puts(b, s, strlen(s));
+}
+
+/* 整数、小数和带指数的数字*/
+static void bench_number(bench_buffer* b) {
+    switch (bench_rand() % 3) {
+        case 0: bench_printf(b, "%.0f", (double)(bench_rand() % 2000000) - 1000000.0); break;
+        case 1: bench_printf(b, "%.6f", (double)bench_rand() / 4294967296.0 * 1000.0); break;
+        default: bench_printf(b, "%.15e", ((double)bench_rand() - 2147483648.0) * 1e-150 * (bench_rand() % 1000)); break;
+    }
+}
+
+/* 含有转义、\uXXXX(包括代理对)和直接写出的UTF-8的字符串*/
+static void bench_string(bench_buffer* b, int unicode) {
+    static const char* pieces[] = {
+        "hello", " world", "\\n", "\\\"", "\\\\", "\\t", "\\u00e9", "\\u4e2d\\u6587", "\\ud83d\\ude00",
+        "\xe4\xb8\xad\xe6\x96\x87", "\xc3\xa9t\xc3\xa9", "json", "lept", "_0123456789"
+    };
+    int i, n = 1 + bench_rand() % 12;
+    bench_append(b, "\"");
+    for (i = 0; i < n; i++) {
+        bench_append(b, pieces[unicode ? bench_rand() % 14 : 11 + bench_rand() % 3]);
+    }
+    bench_append(b, "\"");
+}
+
+/* 日志/消息风格的小对象*/
+static void bench_record(bench_buffer* b, unsigned id) {
+    bench_printf(b, "{\"id\":%.0f,\"type\":\"event\",\"user\":", (double)id);
+    bench_string(b, 0);
+    bench_append(b, ",\"active\":");
+    bench_append(b, bench_rand() % 2 ? "true" : "false");
+    bench_append(b, ",\"score\":");
+    bench_number(b);
+    bench_append(b, ",\"tags\":[\"a\",\"b\"],\"parent\":null}");
+}
+
+/* 深度为depth的数组和对象交替嵌套*/
+static void bench_nested(bench_buffer* b, int depth) {
+    if (depth == 0) {
+        bench_number(b);
+        return;
+    }
+    if (depth % 2) {
+        bench_append(b, "[");
+        bench_nested(b, depth - 1);
+        bench_append(b, ",1]");
+    }
+    else {
+        bench_append(b, "{\"k\":");
+        bench_nested(b, depth - 1);
+        bench_append(b, "}");
+    }
+}
+
+enum { BENCH_NUMBERS, BENCH_STRINGS, BENCH_NESTED, BENCH_OBJECTS, BENCH_NDJSON, BENCH_CORPUS_COUNT };
+
+static const char* bench_corpus_names[] = { "numbers", "strings", "nested", "objects", "ndjson" };
+
+static void bench_generate(bench_buffer* b, int corpus, size_t size) {
+    unsigned i = 0;
+    bench_append(b, corpus == BENCH_NDJSON ? "" : "[");
+    while (b->len < size) {
+        if (i && corpus != BENCH_NDJSON) {
+            bench_append(b, ",");
+        }
+        switch (corpus) {
+            case BENCH_NUMBERS: bench_number(b); break;
+            case BENCH_STRINGS: bench_string(b, 1); break;
+            case BENCH_NESTED: bench_nested(b, 64 + (int)(bench_rand() % 64)); break;
+            case BENCH_OBJECTS: bench_record(b, i); break;
+            default: bench_record(b, i); bench_append(b, "\n"); break;
+        }
+        i++;
+    }
+    bench_append(b, corpus == BENCH_NDJSON ? "" : "]");
+}
+
+static double bench_now(void) {
+#ifdef CLOCK_MONOTONIC
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec + (double)t.tv_nsec * 1e-9;
+#else
+    return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static long bench_peak_rss_kb(void) {
+#ifdef BENCH_HAVE_RUSAGE
+    struct rusage u;
+    getrusage(RUSAGE_SELF, &u);
+#ifdef __APPLE__
+    return u.ru_maxrss / 1024;
+#else
+    return u.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+/* 值的个数 用于计算每个值的时间*/
+static size_t bench_count_values(const lept_value* v) {
+    size_t i, n = 1;
+    switch (lept_get_type(v)) {
+        case LEPT_ARRAY:
+            for (i = 0; i < lept_get_array_size(v); i++) {
+                n += bench_count_values(lept_get_array_element(v, i));
+            }
+            break;
+        case LEPT_OBJECT:
+            for (i = 0; i < lept_get_object_size(v); i++) {
+                n += bench_count_values(lept_get_object_value(v, i));
+            }
+            break;
+        default:
+            break;
+    }
+    return n;
+}
+
+/* 一次测量: 秒数和期间的分配次数*/
+typedef struct {
+    double time;
+    long allocs;
+} bench_sample;
+
+/* 一项测量的结果 samples是每次的测量*/
+typedef struct {
+    const char* corpus;
+    const char* op;
+    size_t bytes, values;
+    bench_sample* samples;
+    int n;
+} bench_result;
+
+static int bench_compare(const void* a, const void* b) {
+    double x = ((const bench_sample*)a)->time, y = ((const bench_sample*)b)->time;
+    return x < y ? -1 : x > y;
+}
+
+/* 报告的分配次数取自中位数的那一次*/
+static void bench_report(FILE* json, int first, bench_result* r) {
+    double median, p99;
+    long allocs;
+    qsort(r->samples, (size_t)r->n, sizeof(bench_sample), bench_compare);
+    median = r->samples[r->n / 2].time;
+    allocs = r->samples[r->n / 2].allocs;
+    p99 = r->samples[(r->n * 99 + 99) / 100 - 1].time;
+    printf("%-8s %-12s %9.1f MB/s %9.1f ns/value  p99 %9.1f MB/s  allocs %9ld\n", r->corpus, r->op,
+        r->bytes / median / 1e6, median * 1e9 / r->values, r->bytes / p99 / 1e6, allocs);
+    if (json) {
+        fprintf(json, "%s\n    {\"corpus\":\"%s\",\"op\":\"%s\",\"bytes\":%lu,\"values\":%lu,\"iterations\":%d,"
+            "\"median_s\":%.9f,\"p99_s\":%.9f,\"mb_per_s\":%.3f,\"ns_per_value\":%.3f,\"allocs\":%ld}",
+            first ? "" : ",", r->corpus, r->op, (unsigned long)r->bytes, (unsigned long)r->values, r->n,
+            median, p99, r->bytes / median / 1e6, median * 1e9 / r->values, allocs);
+    }
+}
+
+/* 各种解析方式*/
+enum { BENCH_PARSE, BENCH_PARSE_PARSER, BENCH_PARSE_ARENA, BENCH_PARSE_TAPE, BENCH_PARSE_NDJSON, BENCH_PARSE_NDJSON_MT };
+
+static const char* bench_parse_names[] = {
+    "parse", "parser", "arena", "tape", "ndjson", "ndjson_mt"
+};
+
+/* 统计NDJSON每一行的值数*/
+static int bench_ndjson_count(void* ctx, size_t line, int ret, lept_value* v) {
+    (void)line;
+    if (ret != LEPT_PARSE_OK) {
+        return LEPT_PARSE_STOPPED;
+    }
+    *(size_t*)ctx += bench_count_values(v);
+    return LEPT_PARSE_OK;
+}
+
+static int bench_ndjson_line(void* ctx, size_t line, int ret, lept_value* v) {
+    (void)line;
+    (void)v;
+    if (ret != LEPT_PARSE_OK) {
+        *(int*)ctx = ret;
+    }
+    return LEPT_PARSE_OK;
+}
+
+/* 解析一次 DOM方式的结果留在v中 由调用者释放*/
+static int bench_parse_once(int mode, const bench_buffer* b, lept_value* v, lept_parser* p, lept_arena* a, lept_tape* t) {
+    int ret = LEPT_PARSE_OK;
+    lept_init(v);
+    switch (mode) {
+        case BENCH_PARSE: return lept_parse_n(v, b->s, b->len);
+        case BENCH_PARSE_PARSER: return lept_parser_parse(p, v, b->s, b->len);
+        case BENCH_PARSE_ARENA: lept_arena_reset(a); return lept_parse_arena(v, a, b->s);
+        case BENCH_PARSE_TAPE: return lept_tape_parse(t, b->s, b->len);
+        case BENCH_PARSE_NDJSON:
+        case BENCH_PARSE_NDJSON_MT:
+            if (lept_parse_ndjson(b->s, b->len, mode == BENCH_PARSE_NDJSON ? 1 : 0, 0, bench_ndjson_line, &ret) != LEPT_PARSE_OK) {
+                return LEPT_PARSE_STOPPED;
+            }
+            return ret;
+        default: return LEPT_PARSE_OK;
+    }
+}
+
+/* 一次测量开始和结束*/
+#define BENCH_BEGIN(r, i) do { (r)->samples[i].allocs = BENCH_ALLOCS(); (r)->samples[i].time = bench_now(); } while(0)
+#define BENCH_END(r, i) do { (r)->samples[i].time = bench_now() - (r)->samples[i].time; (r)->samples[i].allocs = BENCH_ALLOCS() - (r)->samples[i].allocs; } while(0)
+
+static int bench_corpus(FILE* json, int* first, int corpus, const bench_buffer* b, int iterations) {
+    lept_parser* p = lept_parser_new(NULL, 0);
+    lept_tape* t = lept_tape_new();
+    lept_arena a;
+    lept_value v;
+    bench_result r;
+    size_t len;
+    char* s;
+    int i, mode, last = corpus == BENCH_NDJSON ? BENCH_PARSE_NDJSON_MT : BENCH_PARSE_TAPE, ret = 0;
+    lept_arena_init(&a, 0);
+    r.corpus = bench_corpus_names[corpus];
+    r.bytes = b->len;
+    r.n = iterations;
+    r.samples = (bench_sample*)malloc(sizeof(bench_sample) * (size_t)iterations);
+    r.values = 0;
+    if (corpus == BENCH_NDJSON) {
+        ret = lept_parse_ndjson(b->s, b->len, 1, 1, bench_ndjson_count, &r.values) != LEPT_PARSE_OK;
+    }
+    else if (lept_parse_n(&v, b->s, b->len) != LEPT_PARSE_OK) {
+        ret = 1;
+    }
+    else {
+        r.values = bench_count_values(&v);
+        lept_free(&v);
+    }
+    if (ret) {
+        fprintf(stderr, "%s: generated text does not parse\n", r.corpus);
+    }
+    for (mode = corpus == BENCH_NDJSON ? BENCH_PARSE_NDJSON : BENCH_PARSE; mode <= last && ret == 0; mode++) {
+        r.op = bench_parse_names[mode];
+        for (i = 0; i < iterations; i++) {
+            BENCH_BEGIN(&r, i);
+            if (bench_parse_once(mode, b, &v, p, &a, t) != LEPT_PARSE_OK) {
+                fprintf(stderr, "%s: %s failed\n", r.corpus, r.op);
+                ret = 1;
+                break;
+            }
+            BENCH_END(&r, i);
+            lept_free(&v);
+        }
+        if (ret == 0) {
+            bench_report(json, *first, &r);
+            *first = 0;
+        }
+    }
+    /* 生成和释放以一次性解析的DOM为对象*/
+    if (corpus != BENCH_NDJSON && ret == 0) {
+        lept_parse_n(&v, b->s, b->len);
+        r.op = "stringify";
+        for (i = 0; i < iterations; i++) {
+            BENCH_BEGIN(&r, i);
+            s = lept_stringify(&v, &len);
+            BENCH_END(&r, i);
+            bench_allocator.free(bench_allocator.user, s);
+        }
+        bench_report(json, 0, &r);
+        lept_free(&v);
+        r.op = "free";
+        for (i = 0; i < iterations; i++) {
+            lept_parse_n(&v, b->s, b->len);
+            BENCH_BEGIN(&r, i);
+            lept_free(&v);
+            BENCH_END(&r, i);
+        }
+        bench_report(json, 0, &r);
+    }
+    free(r.samples);
+    lept_arena_destroy(&a);
+    lept_tape_free(t);
+    lept_parser_free(p);
+    return ret;
+}
+
+int main(int argc, char** argv) {
+    const char* json_path = NULL;
+    FILE* json = NULL;
+    bench_buffer b;
+    double mb = 4.0;
+    int i, iterations = 10, first = 1, ret = 0;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            mb = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        }
+        else {
+            fprintf(stderr, "usage: %s [-n iterations] [-s MB per corpus] [-j result.json]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (iterations < 1 || mb <= 0) {
+        fprintf(stderr, "iterations and size must be positive\n");
+        return 1;
+    }
+    if (json_path && (json = fopen(json_path, "w")) == NULL) {
+        fprintf(stderr, "cannot open %s\n", json_path);
+        return 1;
+    }
+    lept_set_allocator(&bench_allocator);
+#ifndef NDEBUG
+    fprintf(stderr, "warning: built without NDEBUG, configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers\n");
+#endif
+    if (json) {
+        fprintf(json, "{\"iterations\":%d,\"corpus_mb\":%.3f,\"results\":[", iterations, mb);
+    }
+    for (i = 0; i < BENCH_CORPUS_COUNT && ret == 0; i++) {
+        b.s = NULL;
+        b.len = b.size = 0;
+        bench_generate(&b, i, (size_t)(mb * 1024 * 1024));
+        ret = bench_corpus(json, &first, i, &b, iterations);
+        free(b.s);
+    }
+    printf("peak RSS %ld KB\n", bench_peak_rss_kb());
+    if (json) {
+        fprintf(json, "\n  ],\"peak_rss_kb\":%ld}\n", bench_peak_rss_kb());
+        fclose(json);
+    }
+    return ret;
+}
@@ -1,29 +1,401 @@
 /* 头文件顺序：自己->C->C++->第三方库*/
 
+/* mmap()等POSIX接口 必须在包含任何头文件之前声明*/
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "leptjson.h"
 
 #include <assert.h>  /* assert() */
-#include <stdlib.h>  /* NULL, strtod() malloc() free() realloc()*/
-#include <errno.h> /* errno, ERANGE*/
+#include <stdlib.h>  /* NULL, malloc() free() realloc()*/
 #include <math.h> /* HUGE_VAL*/
 #include <string.h> /* memcpy() */
+#include <stdint.h> /* uint64_t int64_t */
+#include <stdio.h> /* FILE fopen() */
+#include <float.h> /* FLT_EVAL_METHOD */
+#if defined(_MSC_VER) && defined(_M_X64)
+    #include <intrin.h> /* _umul128() */
+#endif
+
+/* x86上提供SSE2/AVX2版本的扫描函数 运行时按CPU选择 定义LEPT_NO_SIMD则只用标量版本*/
+#if !defined(LEPT_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)) \
+    && (defined(__GNUC__) || defined(_MSC_VER))
+    #define LEPT_SIMD_X86
+    #include <immintrin.h> /* SSE2 AVX2 */
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h> /* __cpuid() _BitScanForward() */
+        #define LEPT_TARGET_AVX2
+    #else
+        #define LEPT_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#endif
+
+/* POSIX系统上用mmap读取文件*/
+#if defined(__unix__) || defined(__APPLE__)
+    #define LEPT_HAVE_MMAP
+    #include <fcntl.h> /* open() */
+    #include <sys/mman.h> /* mmap() posix_madvise() */
+    #include <sys/stat.h> /* fstat() */
+    #include <unistd.h> /* close() */
+#endif
+
+/* POSIX系统上NDJSON批量解析使用多个线程 定义LEPT_NO_THREADS则只在调用线程中解析*/
+#if !defined(LEPT_NO_THREADS) && (defined(__unix__) || defined(__APPLE__))
+    #define LEPT_HAVE_PTHREADS
+    #include <pthread.h> /* pthread_create() */
+    #include <unistd.h> /* sysconf() */
+#endif
 
 #ifndef LEPT_PARSE_STACK_INIT_SIZE
     #define LEPT_PARSE_STACK_INIT_SIZE 256
 #endif
 
-#define EXPECT(c, ch) do { assert(*c->json == (ch)); c->json ++; } while(0)
+/* 数组和对象默认最多嵌套的层数 解析和遍历都不递归 限制只是为了拒绝恶意的输入*/
+#ifndef LEPT_PARSE_MAX_DEPTH
+    #define LEPT_PARSE_MAX_DEPTH 1024
+#endif
+
+/* 解析容器时这么多层以内的记录放在C栈上 更深时换到堆上*/
+#ifndef LEPT_PARSE_FRAMES_LOCAL
+    #define LEPT_PARSE_FRAMES_LOCAL 32
+#endif
+
+/* 释放、复制、比较、散列和生成JSON时同样 这么多层以内的记录放在C栈上*/
+#ifndef LEPT_WALK_FRAMES_LOCAL
+    #define LEPT_WALK_FRAMES_LOCAL 16
+#endif
+
+#ifndef LEPT_ARENA_BLOCK_SIZE
+    #define LEPT_ARENA_BLOCK_SIZE (64 * 1024)
+#endif
+
+/* arena块大小按2倍增长 到这个上限为止*/
+#ifndef LEPT_ARENA_BLOCK_MAX
+    #define LEPT_ARENA_BLOCK_MAX (16 * 1024 * 1024)
+#endif
+
+/* lept_value.flags: 字符串/数组/对象的内存不属于该值(例如来自arena或原地解析的输入) lept_free不释放*/
+#define LEPT_FLAG_BORROWED 0x1u
+/* 只用于lept_member.val: 成员的键不属于该对象 lept_free保留这一位*/
+#define LEPT_FLAG_KEY_BORROWED 0x2u
+/* 按需解析的句柄 u.s指向还没有转换的文本 访问时才展开*/
+#define LEPT_FLAG_LAZY 0x4u
+/* 短字符串直接存放在u.s的空间中 长度在flags的16~23位*/
+#define LEPT_FLAG_INLINE 0x8u
+/* 只用于lept_member.val: 短键直接存放在key和klen的空间中 长度在flags的24~31位*/
+#define LEPT_FLAG_KEY_INLINE 0x10u
+/* 只用于lept_member.val: 键来自共享字符串表 同时带有LEPT_FLAG_KEY_BORROWED 散列值已经算好*/
+#define LEPT_FLAG_KEY_INTERNED 0x20u
+/* 数组/对象的内存属于该值 但子孙中可能有不属于它的字符串或键(原地解析、来自arena) lept_copy()因此深复制*/
+#define LEPT_FLAG_BORROWED_CHILDREN 0x40u
+/* lept_free和赋值时保留的、描述键的位*/
+#define LEPT_FLAG_KEY_MASK (LEPT_FLAG_KEY_BORROWED | LEPT_FLAG_KEY_INLINE | LEPT_FLAG_KEY_INTERNED | 0xff000000u)
+/* 能够直接存放的最长字符串 还要留一个字节给'\0'*/
+#define LEPT_INLINE_MAX (sizeof(((lept_value*)0)->u.s) - 1)
+
+/* 字符串和键的内容及长度 不管是否直接存放*/
+#define LEPT_STRING_PTR(v) ((v)->flags & LEPT_FLAG_INLINE ? (char*)&(v)->u.s : (v)->u.s.s)
+#define LEPT_STRING_LEN(v) ((v)->flags & LEPT_FLAG_INLINE ? (size_t)((v)->flags >> 16 & 0xffu) : (v)->u.s.len)
+#define LEPT_MEMBER_KEY(m) ((m)->val.flags & LEPT_FLAG_KEY_INLINE ? (char*)&(m)->key : (m)->key)
+#define LEPT_MEMBER_KLEN(m) ((m)->val.flags & LEPT_FLAG_KEY_INLINE ? (size_t)((m)->val.flags >> 24) : (m)->klen)
+
+/* NDJSON批量解析时每次分给一个线程的输入大小*/
+#ifndef LEPT_NDJSON_BATCH_SIZE
+    #define LEPT_NDJSON_BATCH_SIZE (64 * 1024)
+#endif
+
+/* 成员数不少于这个值的对象带有散列索引 查找键不需要线性扫描*/
+#ifndef LEPT_OBJECT_INDEX_MIN
+    #define LEPT_OBJECT_INDEX_MIN 16
+#endif
+
+#define EXPECT(c, ch) do { assert(c->json < c->end && *c->json == (ch)); c->json ++; } while(0)
+/* 读取p处的字符 越过输入末尾时读到'\0'*/
+#define PEEK(c, p) ((p) < (c)->end ? *(p) : '\0')
 #define ISDIGIT(ch) ((ch) >= '0' && (ch) <= '9')
 #define ISDIGIT1TO9(ch) ((ch) >= '1' && (ch) <= '9')
 /* lept_context_push返回的是栈顶位置 PUTC对栈顶的位置赋值*/
 #define PUTC(c, ch)  do { *(char*)lept_context_push(c, sizeof(char)) = (ch); } while(0)
+#define PUTS(c, s, len) memcpy(lept_context_push(c, len), s, len)
+/* 调用处理函数 没有提供该函数时跳过 处理函数返回非0时中止解析*/
+#define EMIT(c, fn, args) do { if ((c)->handler->fn && (c)->handler->fn args) return LEPT_PARSE_STOPPED; } while(0)
+
+/*
+    所有的内存都通过分配器申请 默认使用malloc()/realloc()/free()
+    解析器自己的临时内存(栈和索引)可以使用另外的分配器 记录在lept_context中
+*/
+static void* lept_default_alloc(void* user, size_t size) {
+    (void)user;
+    return malloc(size);
+}
+
+static void* lept_default_realloc(void* user, void* p, size_t size) {
+    (void)user;
+    return realloc(p, size);
+}
+
+static void lept_default_free(void* user, void* p) {
+    (void)user;
+    free(p);
+}
+
+static lept_allocator lept_allocator_global = { lept_default_alloc, lept_default_realloc, lept_default_free, NULL };
+
+void lept_set_allocator(const lept_allocator* a) {
+    static const lept_allocator lept_allocator_default = { lept_default_alloc, lept_default_realloc, lept_default_free, NULL };
+    assert(a == NULL || (a->alloc != NULL && a->realloc != NULL && a->free != NULL));
+    lept_allocator_global = a ? *a : lept_allocator_default;
+}
+
+#define LEPT_ALLOC_WITH(a, size) ((a)->alloc((a)->user, size))
+#define LEPT_REALLOC_WITH(a, p, size) ((a)->realloc((a)->user, p, size))
+#define LEPT_FREE_WITH(a, p) ((a)->free((a)->user, p))
+#define LEPT_MALLOC(size) LEPT_ALLOC_WITH(&lept_allocator_global, size)
+#define LEPT_REALLOC(p, size) LEPT_REALLOC_WITH(&lept_allocator_global, p, size)
+#define LEPT_FREE(p) LEPT_FREE_WITH(&lept_allocator_global, p)
+
+typedef struct lept_kernels lept_kernels;
 
 typedef struct {
     const char* json;
+    const char* end; /* 输入的末尾 不要求以'\0'结尾*/
     char* stack;
     size_t size, top;
+    lept_arena* arena; /* 不为NULL时 结果的内存都从arena分配*/
+    int insitu; /* 原地模式 字符串在输入缓冲区内解码并直接引用*/
+    const lept_kernels* kernels; /* 空白和字符串的扫描函数*/
+    int fixed; /* 栈是调用者提供的缓冲区 不能realloc*/
+    const lept_handler* handler; /* 解析出的事件交给handler*/
+    void* ctx; /* 传给handler的用户指针*/
+    lept_intern* intern; /* 不为NULL时 DOM中的键从这个共享字符串表取得*/
+    int intern_strings; /* intern不为NULL时才有意义 较短的字符串值也从表中取得*/
+    struct lept_stats_state* stats; /* 不为NULL时记录解析统计 只在定义LEPT_STATS时使用*/
+    const lept_allocator* allocator; /* 栈和解析时的临时内存使用的分配器*/
+    size_t max_depth; /* 数组和对象最多嵌套的层数*/
 } lept_context;
 
+/*
+    解析统计 定义LEPT_STATS时才编译进来 否则下面的宏都是空语句
+    计数只发生在stats不为NULL的上下文中 即lept_parse_ex_stats()的解析过程
+*/
+#ifdef LEPT_STATS
+typedef struct lept_stats_state {
+    lept_parse_stats* out;
+    size_t depth; /* 当前的嵌套深度*/
+    int cycles; /* 是否记录各阶段的周期数*/
+    uint64_t start; /* 当前阶段开始时的周期数 各阶段不会嵌套*/
+} lept_stats_state;
+
+/* x86上读取时间戳计数器 其他平台用clock()代替*/
+static uint64_t lept_cycles(void) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return __rdtsc();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#else
+    return (uint64_t)clock();
+#endif
+}
+
+#define LEPT_STAT_ADD(c, field, n) do { if ((c)->stats) (c)->stats->out->field += (n); } while(0)
+#define LEPT_STAT_MAX(c, field, n) do { if ((c)->stats && (c)->stats->out->field < (n)) (c)->stats->out->field = (n); } while(0)
+#define LEPT_STAT_ENTER(c) do { if ((c)->stats && ++(c)->stats->depth > (c)->stats->out->max_depth) (c)->stats->out->max_depth = (c)->stats->depth; } while(0)
+#define LEPT_STAT_LEAVE(c) do { if ((c)->stats) (c)->stats->depth--; } while(0)
+#define LEPT_PHASE_BEGIN(c) do { if ((c)->stats && (c)->stats->cycles) (c)->stats->start = lept_cycles(); } while(0)
+#define LEPT_PHASE_END(c, phase) do { if ((c)->stats && (c)->stats->cycles) (c)->stats->out->cycles[phase] += lept_cycles() - (c)->stats->start; } while(0)
+#else
+#define LEPT_STAT_ADD(c, field, n) do { } while(0)
+#define LEPT_STAT_MAX(c, field, n) do { } while(0)
+#define LEPT_STAT_ENTER(c) do { } while(0)
+#define LEPT_STAT_LEAVE(c) do { } while(0)
+#define LEPT_PHASE_BEGIN(c) do { } while(0)
+#define LEPT_PHASE_END(c, phase) do { } while(0)
+#endif
+
+/* arena块头 数据紧跟在块头之后*/
+struct lept_arena_block {
+    lept_arena_block* next;
+    size_t size, used;
+};
+
+/* 按8字节对齐 满足double和指针的要求*/
+#define LEPT_ARENA_ALIGN(n) (((n) + 7) & ~(size_t)7)
+#define LEPT_ARENA_HEADER LEPT_ARENA_ALIGN(sizeof(lept_arena_block))
+#define LEPT_ARENA_ALLOCATOR(a) ((a)->allocator ? (a)->allocator : &lept_allocator_global)
+
+void lept_arena_init(lept_arena* a, size_t block_size) {
+    assert(a != NULL);
+    a->head = NULL;
+    a->block_size = block_size ? block_size : LEPT_ARENA_BLOCK_SIZE;
+    a->allocator = NULL;
+}
+
+/*
+    从arena切出size字节 当前块不够时申请新块
+    大块单独申请并挂到当前块后面 避免浪费当前块剩余的空间
+*/
+static void* lept_arena_alloc(lept_arena* a, size_t size) {
+    lept_arena_block* b = a->head;
+    size = LEPT_ARENA_ALIGN(size);
+    if (b == NULL || b->used + size > b->size) {
+        if (b != NULL && size > (a->block_size >> 2)) {
+            b = (lept_arena_block*)LEPT_ALLOC_WITH(LEPT_ARENA_ALLOCATOR(a), LEPT_ARENA_HEADER + size);
+            b->size = b->used = size;
+            b->next = a->head->next;
+            a->head->next = b;
+            return (char*)b + LEPT_ARENA_HEADER;
+        }
+        b = (lept_arena_block*)LEPT_ALLOC_WITH(LEPT_ARENA_ALLOCATOR(a), LEPT_ARENA_HEADER + (size > a->block_size ? size : a->block_size));
+        b->size = size > a->block_size ? size : a->block_size;
+        b->used = 0;
+        b->next = a->head;
+        a->head = b;
+        /* 每申请一个新块 下一块的大小翻倍*/
+        if (a->block_size < LEPT_ARENA_BLOCK_MAX) {
+            a->block_size <<= 1;
+        }
+    }
+    b->used += size;
+    return (char*)b + LEPT_ARENA_HEADER + b->used - size;
+}
+
+void lept_arena_reset(lept_arena* a) {
+    lept_arena_block* b;
+    assert(a != NULL);
+    if (a->head == NULL) {
+        return;
+    }
+    /* 保留最新(也是最大)的块*/
+    while ((b = a->head->next) != NULL) {
+        a->head->next = b->next;
+        LEPT_FREE_WITH(LEPT_ARENA_ALLOCATOR(a), b);
+    }
+    a->head->used = 0;
+}
+
+void lept_arena_destroy(lept_arena* a) {
+    lept_arena_block* b;
+    assert(a != NULL);
+    while ((b = a->head) != NULL) {
+        a->head = b->next;
+        LEPT_FREE_WITH(LEPT_ARENA_ALLOCATOR(a), b);
+    }
+}
+
+/*
+    值自己的内存(长字符串、键、数组和成员数组)前面有一个引用计数 lept_copy()只增加计数
+    计数为1时只有一个所有者 释放时不需要原子操作 共享的内存可以在多个线程中同时读取和释放
+*/
+typedef struct {
+    long refs;
+    size_t capacity; /* 数组和成员数组能容纳的元素个数 其他内存不使用*/
+    uint64_t hash; /* 共享时缓存的lept_hash() 0表示没有缓存*/
+} lept_shared;
+
+#define LEPT_SHARED_HEADER LEPT_ARENA_ALIGN(sizeof(lept_shared))
+#define LEPT_SHARED(p) ((lept_shared*)(void*)((char*)(p) - LEPT_SHARED_HEADER))
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define LEPT_ATOMIC_LOAD(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+    #define LEPT_ATOMIC_INC(p) __atomic_add_fetch(p, 1, __ATOMIC_RELAXED)
+    #define LEPT_ATOMIC_DEC(p) __atomic_sub_fetch(p, 1, __ATOMIC_ACQ_REL)
+    #define LEPT_ATOMIC_LOAD_HASH(p) __atomic_load_n(p, __ATOMIC_RELAXED)
+    #define LEPT_ATOMIC_STORE_HASH(p, h) __atomic_store_n(p, h, __ATOMIC_RELAXED)
+    #define LEPT_ATOMIC_LOAD_PTR(p) __atomic_load_n(p, __ATOMIC_RELAXED)
+    #define LEPT_ATOMIC_STORE_PTR(p, v) __atomic_store_n(p, v, __ATOMIC_RELAXED)
+#elif defined(_MSC_VER)
+    #define LEPT_ATOMIC_LOAD(p) (*(volatile long*)(p))
+    #define LEPT_ATOMIC_INC(p) _InterlockedIncrement(p)
+    #define LEPT_ATOMIC_DEC(p) _InterlockedDecrement(p)
+    #define LEPT_ATOMIC_LOAD_HASH(p) (*(volatile uint64_t*)(p))
+    #define LEPT_ATOMIC_STORE_HASH(p, h) (*(volatile uint64_t*)(p) = (h))
+    /* 对齐的指针读写在MSVC支持的平台上本身是原子的*/
+    #define LEPT_ATOMIC_LOAD_PTR(p) (*(p))
+    #define LEPT_ATOMIC_STORE_PTR(p, v) (*(p) = (v))
+#else
+    /* 没有原子操作时共享的值只能在一个线程中使用*/
+    #define LEPT_ATOMIC_LOAD(p) (*(p))
+    #define LEPT_ATOMIC_INC(p) (++*(p))
+    #define LEPT_ATOMIC_DEC(p) (--*(p))
+    #define LEPT_ATOMIC_LOAD_HASH(p) (*(p))
+    #define LEPT_ATOMIC_STORE_HASH(p, h) (*(p) = (h))
+    #define LEPT_ATOMIC_LOAD_PTR(p) (*(p))
+    #define LEPT_ATOMIC_STORE_PTR(p, v) (*(p) = (v))
+#endif
+
+static void* lept_shared_alloc(size_t size) {
+    lept_shared* s = (lept_shared*)LEPT_MALLOC(LEPT_SHARED_HEADER + size);
+    s->refs = 1;
+    s->capacity = 0;
+    s->hash = 0;
+    return (char*)s + LEPT_SHARED_HEADER;
+}
+
+/*
+    计数为1时内存可能已经通过取得的指针被原地修改 缓存的散列值不再可信 在再次共享之前作废
+    调用者持有一个引用 内存不会在这期间被释放
+*/
+static void lept_shared_retain(void* p) {
+    lept_shared* s = LEPT_SHARED(p);
+    if (LEPT_ATOMIC_LOAD(&s->refs) == 1) {
+        LEPT_ATOMIC_STORE_HASH(&s->hash, 0);
+    }
+    LEPT_ATOMIC_INC(&s->refs);
+}
+
+/* 放弃一个引用 返回非0时调用者是最后的所有者 负责释放内容和lept_shared_free()*/
+static int lept_shared_release(void* p) {
+    lept_shared* s = LEPT_SHARED(p);
+    return LEPT_ATOMIC_LOAD(&s->refs) == 1 || LEPT_ATOMIC_DEC(&s->refs) == 0;
+}
+
+static void lept_shared_free(void* p) {
+    LEPT_FREE(LEPT_SHARED(p));
+}
+
+/*
+    为解析结果分配内存 arena模式下从arena切分 否则带有引用计数
+*/
+static void* lept_context_alloc(lept_context* c, size_t size) {
+    LEPT_STAT_ADD(c, allocs, 1);
+    LEPT_STAT_ADD(c, alloc_bytes, size);
+    return c->arena ? lept_arena_alloc(c->arena, size) : lept_shared_alloc(size);
+}
+
+/*
+    短字符串直接存放在v中 不分配内存 保留v中描述键的位
+*/
+static void lept_set_inline_string(lept_value* v, const char* s, size_t len) {
+    char* p = (char*)&v->u.s;
+    assert(len <= LEPT_INLINE_MAX);
+    if (len) {
+        memcpy(p, s, len);
+    }
+    p[len] = '\0';
+    v->type = LEPT_STRING;
+    v->flags = (v->flags & LEPT_FLAG_KEY_MASK) | LEPT_FLAG_INLINE | (unsigned)len << 16;
+}
+
+/*
+    与lept_set_string()相同 但内存由lept_context_alloc()分配
+*/
+static void lept_context_set_string(lept_context* c, lept_value* v, const char* s, size_t len) {
+    if (len <= LEPT_INLINE_MAX) {
+        v->flags = 0;
+        lept_set_inline_string(v, s, len);
+        return;
+    }
+    v->u.s.s = (char*)lept_context_alloc(c, len + 1);
+    if (len) {
+        memcpy(v->u.s.s, s, len);
+    }
+    v->u.s.s[len] = '\0';
+    v->u.s.len = len;
+    v->type = LEPT_STRING;
+    v->flags = c->arena ? LEPT_FLAG_BORROWED : 0;
+}
+
 /*
 
 */
@@ -31,20 +403,32 @@ static void* lept_context_push(lept_context* c, size_t size) {
     void* ret;
     assert(size > 0);
     /* 栈顶指针+要分配的空间超过c的原配额 则需要扩展c的配额*/
-    if (c->top + size >= c->size) {
+    if (c->top + size > c->size) {
         /* 刚开始初始化 c没有分配空间*/
-        if (c->size == 0) {
+        if (c->size < LEPT_PARSE_STACK_INIT_SIZE) {
             c->size = LEPT_PARSE_STACK_INIT_SIZE;
         }
         /* 不然的话 一直按照1.5倍的速度扩容 直到配额够放入新内容*/
-        while (c->top + size >= c->size) {
+        while (c->top + size > c->size) {
             c->size += c->size >> 1; /* 扩容到1.5倍*/
         }
-        /* c的配额确定后 分配内存*/
-        c->stack = (char*)realloc(c->stack, c->size);
+        LEPT_STAT_ADD(c, stack_grows, 1);
+        /* c的配额确定后 分配内存 调用者的缓冲区放不下时改用新申请的内存*/
+        if (c->fixed) {
+            char* stack = (char*)LEPT_ALLOC_WITH(c->allocator, c->size);
+            if (c->top) {
+                memcpy(stack, c->stack, c->top);
+            }
+            c->stack = stack;
+            c->fixed = 0;
+        }
+        else {
+            c->stack = (char*)LEPT_REALLOC_WITH(c->allocator, c->stack, c->size);
+        }
     }
     ret = c->stack + c->top;
     c->top += size;
+    LEPT_STAT_MAX(c, stack_high_water, c->top);
     return ret;
 }
 
@@ -56,14 +440,251 @@ static void* lept_context_pop(lept_context* c, size_t size) {
     return c->stack + (c->top -= size);
 }
 
+#define ISWHITESPACE(ch) ((ch) == ' ' || (ch) == '\t' || (ch) == '\n' || (ch) == '\r')
+
+/* 64字节块中各类字符的位图 第i位对应p[i] 越过容器时使用*/
+typedef struct {
+    uint64_t quote, backslash;
+    uint64_t open, close; /* {[ }] */
+} lept_block;
+
+/*
+    扫描函数：skip_whitespace返回p之后第一个非空白字符的位置
+    scan_string返回p之后第一个'"' '\\'或控制字符(包括'\0')的位置
+    两者都不会读取end及之后的内容 没有找到时返回end
+    classify对p开始的64个字节分类 调用者保证64个字节都可读
+*/
+struct lept_kernels {
+    const char* (*skip_whitespace)(const char* p, const char* end);
+    const char* (*scan_string)(const char* p, const char* end);
+    void (*classify)(const char* p, lept_block* b);
+};
+
+static const char* lept_skip_whitespace_scalar(const char* p, const char* end) {
+    while (p != end && ISWHITESPACE(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static const char* lept_scan_string_scalar(const char* p, const char* end) {
+    while (p != end && *p != '\"' && *p != '\\' && (unsigned char)*p >= 0x20) {
+        p++;
+    }
+    return p;
+}
+
+static void lept_classify_scalar(const char* p, lept_block* b) {
+    int i;
+    b->quote = b->backslash = b->open = b->close = 0;
+    for (i = 0; i < 64; i++) {
+        uint64_t bit = (uint64_t)1 << i;
+        switch (p[i]) {
+            case '\"': b->quote |= bit; break;
+            case '\\': b->backslash |= bit; break;
+            case '{': case '[': b->open |= bit; break;
+            case '}': case ']': b->close |= bit; break;
+            default: break;
+        }
+    }
+}
+
+static const lept_kernels lept_kernels_scalar = {
+    lept_skip_whitespace_scalar, lept_scan_string_scalar, lept_classify_scalar
+};
+
+#ifdef LEPT_SIMD_X86
+
+/* 最低的置位位置 mask不为0*/
+static unsigned lept_ctz(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long i;
+    _BitScanForward(&i, mask);
+    return (unsigned)i;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+
+/*
+    SIMD版本每次读取一整块 不足一块的尾部交给标量版本
+*/
+static const char* lept_skip_whitespace_sse2(const char* p, const char* end) {
+    const __m128i sp = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+    const __m128i lf = _mm_set1_epi8('\n'), cr = _mm_set1_epi8('\r');
+    for ( ; end - p >= 16; p += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)p);
+        __m128i ws = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, sp), _mm_cmpeq_epi8(x, tab)),
+                                  _mm_or_si128(_mm_cmpeq_epi8(x, lf), _mm_cmpeq_epi8(x, cr)));
+        /* 置位表示非空白字符*/
+        unsigned mask = ~(unsigned)_mm_movemask_epi8(ws) & 0xffffu;
+        if (mask) {
+            return p + lept_ctz(mask);
+        }
+    }
+    return lept_skip_whitespace_scalar(p, end);
+}
+
+static const char* lept_scan_string_sse2(const char* p, const char* end) {
+    const __m128i quote = _mm_set1_epi8('\"'), bs = _mm_set1_epi8('\\');
+    const __m128i ctrl = _mm_set1_epi8(0x1f);
+    for ( ; end - p >= 16; p += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)p);
+        /* 无符号比较 x <= 0x1f 等价于 min(x, 0x1f) == x*/
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, bs)),
+                                   _mm_cmpeq_epi8(_mm_min_epu8(x, ctrl), x));
+        unsigned mask = (unsigned)_mm_movemask_epi8(hit);
+        if (mask) {
+            return p + lept_ctz(mask);
+        }
+    }
+    return lept_scan_string_scalar(p, end);
+}
+
+static void lept_classify_sse2(const char* p, lept_block* b) {
+    const __m128i quote = _mm_set1_epi8('\"'), bs = _mm_set1_epi8('\\');
+    const __m128i lb = _mm_set1_epi8('{'), rb = _mm_set1_epi8('}'), ls = _mm_set1_epi8('[');
+    const __m128i rs = _mm_set1_epi8(']');
+    int i;
+    b->quote = b->backslash = b->open = b->close = 0;
+    for (i = 0; i < 64; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i open = _mm_or_si128(_mm_cmpeq_epi8(x, lb), _mm_cmpeq_epi8(x, ls));
+        __m128i close = _mm_or_si128(_mm_cmpeq_epi8(x, rb), _mm_cmpeq_epi8(x, rs));
+        b->quote |= (uint64_t)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, quote)) << i;
+        b->backslash |= (uint64_t)(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(x, bs)) << i;
+        b->open |= (uint64_t)(unsigned)_mm_movemask_epi8(open) << i;
+        b->close |= (uint64_t)(unsigned)_mm_movemask_epi8(close) << i;
+    }
+}
+
+static const lept_kernels lept_kernels_sse2 = {
+    lept_skip_whitespace_sse2, lept_scan_string_sse2, lept_classify_sse2
+};
+
+LEPT_TARGET_AVX2 static const char* lept_skip_whitespace_avx2(const char* p, const char* end) {
+    const __m256i sp = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+    const __m256i lf = _mm256_set1_epi8('\n'), cr = _mm256_set1_epi8('\r');
+    for ( ; end - p >= 32; p += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)p);
+        __m256i ws = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, sp), _mm256_cmpeq_epi8(x, tab)),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(x, lf), _mm256_cmpeq_epi8(x, cr)));
+        unsigned mask = ~(unsigned)_mm256_movemask_epi8(ws);
+        if (mask) {
+            return p + lept_ctz(mask);
+        }
+    }
+    return lept_skip_whitespace_sse2(p, end);
+}
+
+LEPT_TARGET_AVX2 static const char* lept_scan_string_avx2(const char* p, const char* end) {
+    const __m256i quote = _mm256_set1_epi8('\"'), bs = _mm256_set1_epi8('\\');
+    const __m256i ctrl = _mm256_set1_epi8(0x1f);
+    for ( ; end - p >= 32; p += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)p);
+        __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(x, quote), _mm256_cmpeq_epi8(x, bs)),
+                                      _mm256_cmpeq_epi8(_mm256_min_epu8(x, ctrl), x));
+        unsigned mask = (unsigned)_mm256_movemask_epi8(hit);
+        if (mask) {
+            return p + lept_ctz(mask);
+        }
+    }
+    return lept_scan_string_sse2(p, end);
+}
+
+LEPT_TARGET_AVX2 static void lept_classify_avx2(const char* p, lept_block* b) {
+    const __m256i quote = _mm256_set1_epi8('\"'), bs = _mm256_set1_epi8('\\');
+    const __m256i lb = _mm256_set1_epi8('{'), rb = _mm256_set1_epi8('}'), ls = _mm256_set1_epi8('[');
+    const __m256i rs = _mm256_set1_epi8(']');
+    int i;
+    b->quote = b->backslash = b->open = b->close = 0;
+    for (i = 0; i < 64; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i open = _mm256_or_si256(_mm256_cmpeq_epi8(x, lb), _mm256_cmpeq_epi8(x, ls));
+        __m256i close = _mm256_or_si256(_mm256_cmpeq_epi8(x, rb), _mm256_cmpeq_epi8(x, rs));
+        b->quote |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, quote)) << i;
+        b->backslash |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, bs)) << i;
+        b->open |= (uint64_t)(uint32_t)_mm256_movemask_epi8(open) << i;
+        b->close |= (uint64_t)(uint32_t)_mm256_movemask_epi8(close) << i;
+    }
+}
+
+static const lept_kernels lept_kernels_avx2 = {
+    lept_skip_whitespace_avx2, lept_scan_string_avx2, lept_classify_avx2
+};
+
+/* 检测CPU是否支持SSE2 x86-64上一定支持*/
+static int lept_cpu_has_sse2(void) {
+#if defined(__x86_64__) || defined(_M_X64)
+    return 1;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+/* 检测CPU和操作系统是否都支持AVX2*/
+static int lept_cpu_has_avx2(void) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return 0;
+    }
+    __cpuid(info, 1);
+    /* OSXSAVE和AVX 且操作系统保存了YMM寄存器*/
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+        return 0;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif /* LEPT_SIMD_X86 */
+
+/* 当前使用的扫描函数 第一次解析时选择 之后不再改变*/
+static const lept_kernels* lept_kernels_impl = NULL;
+
+static const lept_kernels* lept_select_kernels(void) {
+    const lept_kernels* k = LEPT_ATOMIC_LOAD_PTR(&lept_kernels_impl);
+    if (k == NULL) {
+        k = &lept_kernels_scalar;
+#ifdef LEPT_SIMD_X86
+        if (lept_cpu_has_avx2()) {
+            k = &lept_kernels_avx2;
+        }
+        else if (lept_cpu_has_sse2()) {
+            k = &lept_kernels_sse2;
+        }
+#endif
+        /* 多个线程同时选择时结果相同 原子地写入指针即可 不需要加锁*/
+        LEPT_ATOMIC_STORE_PTR(&lept_kernels_impl, k);
+    }
+    return k;
+}
+
 /*
     将value前的空格全部去掉
+    值之间通常只有一个空白或者没有 先逐字节判断 遇到较长的空白(缩进)才交给扫描函数
 */
 static void lept_parse_whitespace(lept_context* c) {
     const char* p = c->json;
-    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') {
-        p ++;
+    LEPT_PHASE_BEGIN(c);
+    if (ISWHITESPACE(PEEK(c, p))) {
+        p++;
+        if (ISWHITESPACE(PEEK(c, p))) {
+            p = c->kernels->skip_whitespace(p, c->end);
+        }
     }
+    LEPT_PHASE_END(c, LEPT_PHASE_WHITESPACE);
     /* 然后将不是空格的位置赋给json指针 */
     c->json = p;
 }
@@ -71,318 +692,4742 @@ static void lept_parse_whitespace(lept_context* c) {
 /*
     重构：将TRUE FALSE NULL的解析统一到一个框架下
 */
-static int lept_parse_literal(lept_context* c, lept_value* v, const char* literal, lept_type type) {
+static int lept_parse_literal(lept_context* c, const char* literal, lept_type type) {
     size_t i;
     EXPECT(c, literal[0]);
     /*现在就是需要核对c->json和给定的literal字面量是不是一致*/
     for(i = 0; literal[i + 1]; i++) {
         // 如果不一致 说明是非法值
-        if (c->json[i] != literal[i + 1]) {
+        if (PEEK(c, c->json + i) != literal[i + 1]) {
             return LEPT_PARSE_INVALID_VALUE;
         }
     }
     /*检查全部通过后 首先将c->json指针后移*/
     c->json += i;
-    v->type = type;
-    return LEPT_PARSE_OK;
-}
-
-/*
-    解析数字
-*/
-static int lept_parse_number(lept_context* c, lept_value* v) {
-    const char* p = c->json;
-    if (*p == '-') p++; // 可以是负数
-    // 接下来要么是0 要么是1-9
-    if (*p == '0') {
-        p++;
-    } else {
-        if (!ISDIGIT1TO9(*p)) {
-            return LEPT_PARSE_INVALID_VALUE;
-        }
-        // 第一个是1-9 后面的只要是数字都是合法的
-        for(p++; ISDIGIT(*p); p++);
-    }
-    // 接下来看有没有小数点
-    if (*p == '.') {
-        p++;
-        // 有的话 小数点后面的连续的数字都是合法的
-        if (!ISDIGIT(*p)) {
-            return LEPT_PARSE_INVALID_VALUE;
-        }
-        for (p++; ISDIGIT(*p); p++);
-    }
-    // 接下来看有没有科学计数法标志
-    if (*p == 'E' || *p == 'e') {
-        p++;
-        // 后面可以跟+ -号
-        if (*p == '+' || *p == '-') {
-            p++;
-        }
-        // 然后就是数字
-        if (!ISDIGIT(*p)) {
-            return LEPT_PARSE_INVALID_VALUE;
-        }
-        // 所有的数字都是合法的
-        for (p++; ISDIGIT(*p); p++);
+    if (type == LEPT_NULL) {
+        EMIT(c, on_null, (c->ctx));
     }
-    // 到这个位置的时候 p指向的就是非数字字符了
-    errno = 0;
-    v->u.n = strtod(c->json, NULL);
-    if (errno == ERANGE && (v->u.n == HUGE_VAL || v->u.n == -HUGE_VAL)) {
-        return LEPT_PARSE_NUMBER_TOO_BIG;
+    else {
+        EMIT(c, on_bool, (c->ctx, type == LEPT_TRUE));
     }
-    // 数字没有问题
-    v->type = LEPT_NUMBER;
-    c->json = p;
     return LEPT_PARSE_OK;
 }
 
 /*
-    解析4位十六进制数为码点
+    十进制转double 不依赖locale 结果与正确舍入的strtod()逐位相同
+    1. 尾数不超过2^53且指数在[-22, 22]内时 一次浮点乘除就是精确结果(Clinger)
+    2. 否则用5的幂的128位近似值做Eisel-Lemire计算
+    3. 有效数字超过19位且无法确定舍入方向时 用大数十进制做精确计算
 */
-static const char* lept_parse_hex4(const char* p, unsigned* u) {
-    // 这个函数读取四个16进制的数字
-    int i;
-    *u = 0;
-    for( i = 0; i < 4; i++) {
-        char ch = *p++;
-        *u <<= 4;
-        // 这时候*u的低四位为0 使用或运算直接将ch复制到*u的低四位
-        if (ch >= '0' && ch <= '9') *u |= ch - '0';
-        else if (ch >= 'A' && ch <= 'F') *u |= ch - ('A' - 10);
-        else if (ch >= 'a' && ch <= 'f') *u |= ch - ('a' - 10);
-        else return NULL;
+
+/* 5^q (q = -342..308) 的128位截断值 最高位对齐到第127位 */
+#define LEPT_POW5_MIN_EXP (-342)
+#define LEPT_POW5_MAX_EXP 308
+
+static const uint64_t lept_pow5_128[][2] = {
+    {0xeef453d6923bd65a, 0x113faa2906a13b3f}, /* 5^-342 */
+    {0x9558b4661b6565f8, 0x4ac7ca59a424c507}, /* 5^-341 */
+    {0xbaaee17fa23ebf76, 0x5d79bcf00d2df649}, /* 5^-340 */
+    {0xe95a99df8ace6f53, 0xf4d82c2c107973dc}, /* 5^-339 */
+    {0x91d8a02bb6c10594, 0x79071b9b8a4be869}, /* 5^-338 */
+    {0xb64ec836a47146f9, 0x9748e2826cdee284}, /* 5^-337 */
+    {0xe3e27a444d8d98b7, 0xfd1b1b2308169b25}, /* 5^-336 */
+    {0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7}, /* 5^-335 */
+    {0xb208ef855c969f4f, 0xbdbd2d335e51a935}, /* 5^-334 */
+    {0xde8b2b66b3bc4723, 0xad2c788035e61382}, /* 5^-333 */
+    {0x8b16fb203055ac76, 0x4c3bcb5021afcc31}, /* 5^-332 */
+    {0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d}, /* 5^-331 */
+    {0xd953e8624b85dd78, 0xd71d6dad34a2af0d}, /* 5^-330 */
+    {0x87d4713d6f33aa6b, 0x8672648c40e5ad68}, /* 5^-329 */
+    {0xa9c98d8ccb009506, 0x680efdaf511f18c2}, /* 5^-328 */
+    {0xd43bf0effdc0ba48, 0x0212bd1b2566def2}, /* 5^-327 */
+    {0x84a57695fe98746d, 0x014bb630f7604b57}, /* 5^-326 */
+    {0xa5ced43b7e3e9188, 0x419ea3bd35385e2d}, /* 5^-325 */
+    {0xcf42894a5dce35ea, 0x52064cac828675b9}, /* 5^-324 */
+    {0x818995ce7aa0e1b2, 0x7343efebd1940993}, /* 5^-323 */
+    {0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8}, /* 5^-322 */
+    {0xca66fa129f9b60a6, 0xd41a26e077774ef6}, /* 5^-321 */
+    {0xfd00b897478238d0, 0x8920b098955522b4}, /* 5^-320 */
+    {0x9e20735e8cb16382, 0x55b46e5f5d5535b0}, /* 5^-319 */
+    {0xc5a890362fddbc62, 0xeb2189f734aa831d}, /* 5^-318 */
+    {0xf712b443bbd52b7b, 0xa5e9ec7501d523e4}, /* 5^-317 */
+    {0x9a6bb0aa55653b2d, 0x47b233c92125366e}, /* 5^-316 */
+    {0xc1069cd4eabe89f8, 0x999ec0bb696e840a}, /* 5^-315 */
+    {0xf148440a256e2c76, 0xc00670ea43ca250d}, /* 5^-314 */
+    {0x96cd2a865764dbca, 0x380406926a5e5728}, /* 5^-313 */
+    {0xbc807527ed3e12bc, 0xc605083704f5ecf2}, /* 5^-312 */
+    {0xeba09271e88d976b, 0xf7864a44c633682e}, /* 5^-311 */
+    {0x93445b8731587ea3, 0x7ab3ee6afbe0211d}, /* 5^-310 */
+    {0xb8157268fdae9e4c, 0x5960ea05bad82964}, /* 5^-309 */
+    {0xe61acf033d1a45df, 0x6fb92487298e33bd}, /* 5^-308 */
+    {0x8fd0c16206306bab, 0xa5d3b6d479f8e056}, /* 5^-307 */
+    {0xb3c4f1ba87bc8696, 0x8f48a4899877186c}, /* 5^-306 */
+    {0xe0b62e2929aba83c, 0x331acdabfe94de87}, /* 5^-305 */
+    {0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14}, /* 5^-304 */
+    {0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9}, /* 5^-303 */
+    {0xdb71e91432b1a24a, 0xc9e82cd9f69d6150}, /* 5^-302 */
+    {0x892731ac9faf056e, 0xbe311c083a225cd2}, /* 5^-301 */
+    {0xab70fe17c79ac6ca, 0x6dbd630a48aaf406}, /* 5^-300 */
+    {0xd64d3d9db981787d, 0x092cbbccdad5b108}, /* 5^-299 */
+    {0x85f0468293f0eb4e, 0x25bbf56008c58ea5}, /* 5^-298 */
+    {0xa76c582338ed2621, 0xaf2af2b80af6f24e}, /* 5^-297 */
+    {0xd1476e2c07286faa, 0x1af5af660db4aee1}, /* 5^-296 */
+    {0x82cca4db847945ca, 0x50d98d9fc890ed4d}, /* 5^-295 */
+    {0xa37fce126597973c, 0xe50ff107bab528a0}, /* 5^-294 */
+    {0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8}, /* 5^-293 */
+    {0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a}, /* 5^-292 */
+    {0x9faacf3df73609b1, 0x77b191618c54e9ac}, /* 5^-291 */
+    {0xc795830d75038c1d, 0xd59df5b9ef6a2417}, /* 5^-290 */
+    {0xf97ae3d0d2446f25, 0x4b0573286b44ad1d}, /* 5^-289 */
+    {0x9becce62836ac577, 0x4ee367f9430aec32}, /* 5^-288 */
+    {0xc2e801fb244576d5, 0x229c41f793cda73f}, /* 5^-287 */
+    {0xf3a20279ed56d48a, 0x6b43527578c1110f}, /* 5^-286 */
+    {0x9845418c345644d6, 0x830a13896b78aaa9}, /* 5^-285 */
+    {0xbe5691ef416bd60c, 0x23cc986bc656d553}, /* 5^-284 */
+    {0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8}, /* 5^-283 */
+    {0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9}, /* 5^-282 */
+    {0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53}, /* 5^-281 */
+    {0xe858ad248f5c22c9, 0xd1b3400f8f9cff68}, /* 5^-280 */
+    {0x91376c36d99995be, 0x23100809b9c21fa1}, /* 5^-279 */
+    {0xb58547448ffffb2d, 0xabd40a0c2832a78a}, /* 5^-278 */
+    {0xe2e69915b3fff9f9, 0x16c90c8f323f516c}, /* 5^-277 */
+    {0x8dd01fad907ffc3b, 0xae3da7d97f6792e3}, /* 5^-276 */
+    {0xb1442798f49ffb4a, 0x99cd11cfdf41779c}, /* 5^-275 */
+    {0xdd95317f31c7fa1d, 0x40405643d711d583}, /* 5^-274 */
+    {0x8a7d3eef7f1cfc52, 0x482835ea666b2572}, /* 5^-273 */
+    {0xad1c8eab5ee43b66, 0xda3243650005eecf}, /* 5^-272 */
+    {0xd863b256369d4a40, 0x90bed43e40076a82}, /* 5^-271 */
+    {0x873e4f75e2224e68, 0x5a7744a6e804a291}, /* 5^-270 */
+    {0xa90de3535aaae202, 0x711515d0a205cb36}, /* 5^-269 */
+    {0xd3515c2831559a83, 0x0d5a5b44ca873e03}, /* 5^-268 */
+    {0x8412d9991ed58091, 0xe858790afe9486c2}, /* 5^-267 */
+    {0xa5178fff668ae0b6, 0x626e974dbe39a872}, /* 5^-266 */
+    {0xce5d73ff402d98e3, 0xfb0a3d212dc8128f}, /* 5^-265 */
+    {0x80fa687f881c7f8e, 0x7ce66634bc9d0b99}, /* 5^-264 */
+    {0xa139029f6a239f72, 0x1c1fffc1ebc44e80}, /* 5^-263 */
+    {0xc987434744ac874e, 0xa327ffb266b56220}, /* 5^-262 */
+    {0xfbe9141915d7a922, 0x4bf1ff9f0062baa8}, /* 5^-261 */
+    {0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9}, /* 5^-260 */
+    {0xc4ce17b399107c22, 0xcb550fb4384d21d3}, /* 5^-259 */
+    {0xf6019da07f549b2b, 0x7e2a53a146606a48}, /* 5^-258 */
+    {0x99c102844f94e0fb, 0x2eda7444cbfc426d}, /* 5^-257 */
+    {0xc0314325637a1939, 0xfa911155fefb5308}, /* 5^-256 */
+    {0xf03d93eebc589f88, 0x793555ab7eba27ca}, /* 5^-255 */
+    {0x96267c7535b763b5, 0x4bc1558b2f3458de}, /* 5^-254 */
+    {0xbbb01b9283253ca2, 0x9eb1aaedfb016f16}, /* 5^-253 */
+    {0xea9c227723ee8bcb, 0x465e15a979c1cadc}, /* 5^-252 */
+    {0x92a1958a7675175f, 0x0bfacd89ec191ec9}, /* 5^-251 */
+    {0xb749faed14125d36, 0xcef980ec671f667b}, /* 5^-250 */
+    {0xe51c79a85916f484, 0x82b7e12780e7401a}, /* 5^-249 */
+    {0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810}, /* 5^-248 */
+    {0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15}, /* 5^-247 */
+    {0xdfbdcece67006ac9, 0x67a791e093e1d49a}, /* 5^-246 */
+    {0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0}, /* 5^-245 */
+    {0xaecc49914078536d, 0x58fae9f773886e18}, /* 5^-244 */
+    {0xda7f5bf590966848, 0xaf39a475506a899e}, /* 5^-243 */
+    {0x888f99797a5e012d, 0x6d8406c952429603}, /* 5^-242 */
+    {0xaab37fd7d8f58178, 0xc8e5087ba6d33b83}, /* 5^-241 */
+    {0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64}, /* 5^-240 */
+    {0x855c3be0a17fcd26, 0x5cf2eea09a55067f}, /* 5^-239 */
+    {0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e}, /* 5^-238 */
+    {0xd0601d8efc57b08b, 0xf13b94daf124da26}, /* 5^-237 */
+    {0x823c12795db6ce57, 0x76c53d08d6b70858}, /* 5^-236 */
+    {0xa2cb1717b52481ed, 0x54768c4b0c64ca6e}, /* 5^-235 */
+    {0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09}, /* 5^-234 */
+    {0xfe5d54150b090b02, 0xd3f93b35435d7c4c}, /* 5^-233 */
+    {0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf}, /* 5^-232 */
+    {0xc6b8e9b0709f109a, 0x359ab6419ca1091b}, /* 5^-231 */
+    {0xf867241c8cc6d4c0, 0xc30163d203c94b62}, /* 5^-230 */
+    {0x9b407691d7fc44f8, 0x79e0de63425dcf1d}, /* 5^-229 */
+    {0xc21094364dfb5636, 0x985915fc12f542e4}, /* 5^-228 */
+    {0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d}, /* 5^-227 */
+    {0x979cf3ca6cec5b5a, 0xa705992ceecf9c42}, /* 5^-226 */
+    {0xbd8430bd08277231, 0x50c6ff782a838353}, /* 5^-225 */
+    {0xece53cec4a314ebd, 0xa4f8bf5635246428}, /* 5^-224 */
+    {0x940f4613ae5ed136, 0x871b7795e136be99}, /* 5^-223 */
+    {0xb913179899f68584, 0x28e2557b59846e3f}, /* 5^-222 */
+    {0xe757dd7ec07426e5, 0x331aeada2fe589cf}, /* 5^-221 */
+    {0x9096ea6f3848984f, 0x3ff0d2c85def7621}, /* 5^-220 */
+    {0xb4bca50b065abe63, 0x0fed077a756b53a9}, /* 5^-219 */
+    {0xe1ebce4dc7f16dfb, 0xd3e8495912c62894}, /* 5^-218 */
+    {0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c}, /* 5^-217 */
+    {0xb080392cc4349dec, 0xbd8d794d96aacfb3}, /* 5^-216 */
+    {0xdca04777f541c567, 0xecf0d7a0fc5583a0}, /* 5^-215 */
+    {0x89e42caaf9491b60, 0xf41686c49db57244}, /* 5^-214 */
+    {0xac5d37d5b79b6239, 0x311c2875c522ced5}, /* 5^-213 */
+    {0xd77485cb25823ac7, 0x7d633293366b828b}, /* 5^-212 */
+    {0x86a8d39ef77164bc, 0xae5dff9c02033197}, /* 5^-211 */
+    {0xa8530886b54dbdeb, 0xd9f57f830283fdfc}, /* 5^-210 */
+    {0xd267caa862a12d66, 0xd072df63c324fd7b}, /* 5^-209 */
+    {0x8380dea93da4bc60, 0x4247cb9e59f71e6d}, /* 5^-208 */
+    {0xa46116538d0deb78, 0x52d9be85f074e608}, /* 5^-207 */
+    {0xcd795be870516656, 0x67902e276c921f8b}, /* 5^-206 */
+    {0x806bd9714632dff6, 0x00ba1cd8a3db53b6}, /* 5^-205 */
+    {0xa086cfcd97bf97f3, 0x80e8a40eccd228a4}, /* 5^-204 */
+    {0xc8a883c0fdaf7df0, 0x6122cd128006b2cd}, /* 5^-203 */
+    {0xfad2a4b13d1b5d6c, 0x796b805720085f81}, /* 5^-202 */
+    {0x9cc3a6eec6311a63, 0xcbe3303674053bb0}, /* 5^-201 */
+    {0xc3f490aa77bd60fc, 0xbedbfc4411068a9c}, /* 5^-200 */
+    {0xf4f1b4d515acb93b, 0xee92fb5515482d44}, /* 5^-199 */
+    {0x991711052d8bf3c5, 0x751bdd152d4d1c4a}, /* 5^-198 */
+    {0xbf5cd54678eef0b6, 0xd262d45a78a0635d}, /* 5^-197 */
+    {0xef340a98172aace4, 0x86fb897116c87c34}, /* 5^-196 */
+    {0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0}, /* 5^-195 */
+    {0xbae0a846d2195712, 0x8974836059cca109}, /* 5^-194 */
+    {0xe998d258869facd7, 0x2bd1a438703fc94b}, /* 5^-193 */
+    {0x91ff83775423cc06, 0x7b6306a34627ddcf}, /* 5^-192 */
+    {0xb67f6455292cbf08, 0x1a3bc84c17b1d542}, /* 5^-191 */
+    {0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93}, /* 5^-190 */
+    {0x8e938662882af53e, 0x547eb47b7282ee9c}, /* 5^-189 */
+    {0xb23867fb2a35b28d, 0xe99e619a4f23aa43}, /* 5^-188 */
+    {0xdec681f9f4c31f31, 0x6405fa00e2ec94d4}, /* 5^-187 */
+    {0x8b3c113c38f9f37e, 0xde83bc408dd3dd04}, /* 5^-186 */
+    {0xae0b158b4738705e, 0x9624ab50b148d445}, /* 5^-185 */
+    {0xd98ddaee19068c76, 0x3badd624dd9b0957}, /* 5^-184 */
+    {0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6}, /* 5^-183 */
+    {0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c}, /* 5^-182 */
+    {0xd47487cc8470652b, 0x7647c3200069671f}, /* 5^-181 */
+    {0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073}, /* 5^-180 */
+    {0xa5fb0a17c777cf09, 0xf468107100525890}, /* 5^-179 */
+    {0xcf79cc9db955c2cc, 0x7182148d4066eeb4}, /* 5^-178 */
+    {0x81ac1fe293d599bf, 0xc6f14cd848405530}, /* 5^-177 */
+    {0xa21727db38cb002f, 0xb8ada00e5a506a7c}, /* 5^-176 */
+    {0xca9cf1d206fdc03b, 0xa6d90811f0e4851c}, /* 5^-175 */
+    {0xfd442e4688bd304a, 0x908f4a166d1da663}, /* 5^-174 */
+    {0x9e4a9cec15763e2e, 0x9a598e4e043287fe}, /* 5^-173 */
+    {0xc5dd44271ad3cdba, 0x40eff1e1853f29fd}, /* 5^-172 */
+    {0xf7549530e188c128, 0xd12bee59e68ef47c}, /* 5^-171 */
+    {0x9a94dd3e8cf578b9, 0x82bb74f8301958ce}, /* 5^-170 */
+    {0xc13a148e3032d6e7, 0xe36a52363c1faf01}, /* 5^-169 */
+    {0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1}, /* 5^-168 */
+    {0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9}, /* 5^-167 */
+    {0xbcb2b812db11a5de, 0x7415d448f6b6f0e7}, /* 5^-166 */
+    {0xebdf661791d60f56, 0x111b495b3464ad21}, /* 5^-165 */
+    {0x936b9fcebb25c995, 0xcab10dd900beec34}, /* 5^-164 */
+    {0xb84687c269ef3bfb, 0x3d5d514f40eea742}, /* 5^-163 */
+    {0xe65829b3046b0afa, 0x0cb4a5a3112a5112}, /* 5^-162 */
+    {0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab}, /* 5^-161 */
+    {0xb3f4e093db73a093, 0x59ed216765690f56}, /* 5^-160 */
+    {0xe0f218b8d25088b8, 0x306869c13ec3532c}, /* 5^-159 */
+    {0x8c974f7383725573, 0x1e414218c73a13fb}, /* 5^-158 */
+    {0xafbd2350644eeacf, 0xe5d1929ef90898fa}, /* 5^-157 */
+    {0xdbac6c247d62a583, 0xdf45f746b74abf39}, /* 5^-156 */
+    {0x894bc396ce5da772, 0x6b8bba8c328eb783}, /* 5^-155 */
+    {0xab9eb47c81f5114f, 0x066ea92f3f326564}, /* 5^-154 */
+    {0xd686619ba27255a2, 0xc80a537b0efefebd}, /* 5^-153 */
+    {0x8613fd0145877585, 0xbd06742ce95f5f36}, /* 5^-152 */
+    {0xa798fc4196e952e7, 0x2c48113823b73704}, /* 5^-151 */
+    {0xd17f3b51fca3a7a0, 0xf75a15862ca504c5}, /* 5^-150 */
+    {0x82ef85133de648c4, 0x9a984d73dbe722fb}, /* 5^-149 */
+    {0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba}, /* 5^-148 */
+    {0xcc963fee10b7d1b3, 0x318df905079926a8}, /* 5^-147 */
+    {0xffbbcfe994e5c61f, 0xfdf17746497f7052}, /* 5^-146 */
+    {0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633}, /* 5^-145 */
+    {0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0}, /* 5^-144 */
+    {0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0}, /* 5^-143 */
+    {0x9c1661a651213e2d, 0x06bea10ca65c084e}, /* 5^-142 */
+    {0xc31bfa0fe5698db8, 0x486e494fcff30a62}, /* 5^-141 */
+    {0xf3e2f893dec3f126, 0x5a89dba3c3efccfa}, /* 5^-140 */
+    {0x986ddb5c6b3a76b7, 0xf89629465a75e01c}, /* 5^-139 */
+    {0xbe89523386091465, 0xf6bbb397f1135823}, /* 5^-138 */
+    {0xee2ba6c0678b597f, 0x746aa07ded582e2c}, /* 5^-137 */
+    {0x94db483840b717ef, 0xa8c2a44eb4571cdc}, /* 5^-136 */
+    {0xba121a4650e4ddeb, 0x92f34d62616ce413}, /* 5^-135 */
+    {0xe896a0d7e51e1566, 0x77b020baf9c81d17}, /* 5^-134 */
+    {0x915e2486ef32cd60, 0x0ace1474dc1d122e}, /* 5^-133 */
+    {0xb5b5ada8aaff80b8, 0x0d819992132456ba}, /* 5^-132 */
+    {0xe3231912d5bf60e6, 0x10e1fff697ed6c69}, /* 5^-131 */
+    {0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1}, /* 5^-130 */
+    {0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2}, /* 5^-129 */
+    {0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde}, /* 5^-128 */
+    {0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b}, /* 5^-127 */
+    {0xad4ab7112eb3929d, 0x86c16c98d2c953c6}, /* 5^-126 */
+    {0xd89d64d57a607744, 0xe871c7bf077ba8b7}, /* 5^-125 */
+    {0x87625f056c7c4a8b, 0x11471cd764ad4972}, /* 5^-124 */
+    {0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf}, /* 5^-123 */
+    {0xd389b47879823479, 0x4aff1d108d4ec2c3}, /* 5^-122 */
+    {0x843610cb4bf160cb, 0xcedf722a585139ba}, /* 5^-121 */
+    {0xa54394fe1eedb8fe, 0xc2974eb4ee658828}, /* 5^-120 */
+    {0xce947a3da6a9273e, 0x733d226229feea32}, /* 5^-119 */
+    {0x811ccc668829b887, 0x0806357d5a3f525f}, /* 5^-118 */
+    {0xa163ff802a3426a8, 0xca07c2dcb0cf26f7}, /* 5^-117 */
+    {0xc9bcff6034c13052, 0xfc89b393dd02f0b5}, /* 5^-116 */
+    {0xfc2c3f3841f17c67, 0xbbac2078d443ace2}, /* 5^-115 */
+    {0x9d9ba7832936edc0, 0xd54b944b84aa4c0d}, /* 5^-114 */
+    {0xc5029163f384a931, 0x0a9e795e65d4df11}, /* 5^-113 */
+    {0xf64335bcf065d37d, 0x4d4617b5ff4a16d5}, /* 5^-112 */
+    {0x99ea0196163fa42e, 0x504bced1bf8e4e45}, /* 5^-111 */
+    {0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6}, /* 5^-110 */
+    {0xf07da27a82c37088, 0x5d767327bb4e5a4c}, /* 5^-109 */
+    {0x964e858c91ba2655, 0x3a6a07f8d510f86f}, /* 5^-108 */
+    {0xbbe226efb628afea, 0x890489f70a55368b}, /* 5^-107 */
+    {0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e}, /* 5^-106 */
+    {0x92c8ae6b464fc96f, 0x3b0b8bc90012929d}, /* 5^-105 */
+    {0xb77ada0617e3bbcb, 0x09ce6ebb40173744}, /* 5^-104 */
+    {0xe55990879ddcaabd, 0xcc420a6a101d0515}, /* 5^-103 */
+    {0x8f57fa54c2a9eab6, 0x9fa946824a12232d}, /* 5^-102 */
+    {0xb32df8e9f3546564, 0x47939822dc96abf9}, /* 5^-101 */
+    {0xdff9772470297ebd, 0x59787e2b93bc56f7}, /* 5^-100 */
+    {0x8bfbea76c619ef36, 0x57eb4edb3c55b65a}, /* 5^-99 */
+    {0xaefae51477a06b03, 0xede622920b6b23f1}, /* 5^-98 */
+    {0xdab99e59958885c4, 0xe95fab368e45eced}, /* 5^-97 */
+    {0x88b402f7fd75539b, 0x11dbcb0218ebb414}, /* 5^-96 */
+    {0xaae103b5fcd2a881, 0xd652bdc29f26a119}, /* 5^-95 */
+    {0xd59944a37c0752a2, 0x4be76d3346f0495f}, /* 5^-94 */
+    {0x857fcae62d8493a5, 0x6f70a4400c562ddb}, /* 5^-93 */
+    {0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952}, /* 5^-92 */
+    {0xd097ad07a71f26b2, 0x7e2000a41346a7a7}, /* 5^-91 */
+    {0x825ecc24c873782f, 0x8ed400668c0c28c8}, /* 5^-90 */
+    {0xa2f67f2dfa90563b, 0x728900802f0f32fa}, /* 5^-89 */
+    {0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9}, /* 5^-88 */
+    {0xfea126b7d78186bc, 0xe2f610c84987bfa8}, /* 5^-87 */
+    {0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9}, /* 5^-86 */
+    {0xc6ede63fa05d3143, 0x91503d1c79720dbb}, /* 5^-85 */
+    {0xf8a95fcf88747d94, 0x75a44c6397ce912a}, /* 5^-84 */
+    {0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba}, /* 5^-83 */
+    {0xc24452da229b021b, 0xfbe85badce996168}, /* 5^-82 */
+    {0xf2d56790ab41c2a2, 0xfae27299423fb9c3}, /* 5^-81 */
+    {0x97c560ba6b0919a5, 0xdccd879fc967d41a}, /* 5^-80 */
+    {0xbdb6b8e905cb600f, 0x5400e987bbc1c920}, /* 5^-79 */
+    {0xed246723473e3813, 0x290123e9aab23b68}, /* 5^-78 */
+    {0x9436c0760c86e30b, 0xf9a0b6720aaf6521}, /* 5^-77 */
+    {0xb94470938fa89bce, 0xf808e40e8d5b3e69}, /* 5^-76 */
+    {0xe7958cb87392c2c2, 0xb60b1d1230b20e04}, /* 5^-75 */
+    {0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2}, /* 5^-74 */
+    {0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3}, /* 5^-73 */
+    {0xe2280b6c20dd5232, 0x25c6da63c38de1b0}, /* 5^-72 */
+    {0x8d590723948a535f, 0x579c487e5a38ad0e}, /* 5^-71 */
+    {0xb0af48ec79ace837, 0x2d835a9df0c6d851}, /* 5^-70 */
+    {0xdcdb1b2798182244, 0xf8e431456cf88e65}, /* 5^-69 */
+    {0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff}, /* 5^-68 */
+    {0xac8b2d36eed2dac5, 0xe272467e3d222f3f}, /* 5^-67 */
+    {0xd7adf884aa879177, 0x5b0ed81dcc6abb0f}, /* 5^-66 */
+    {0x86ccbb52ea94baea, 0x98e947129fc2b4e9}, /* 5^-65 */
+    {0xa87fea27a539e9a5, 0x3f2398d747b36224}, /* 5^-64 */
+    {0xd29fe4b18e88640e, 0x8eec7f0d19a03aad}, /* 5^-63 */
+    {0x83a3eeeef9153e89, 0x1953cf68300424ac}, /* 5^-62 */
+    {0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7}, /* 5^-61 */
+    {0xcdb02555653131b6, 0x3792f412cb06794d}, /* 5^-60 */
+    {0x808e17555f3ebf11, 0xe2bbd88bbee40bd0}, /* 5^-59 */
+    {0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4}, /* 5^-58 */
+    {0xc8de047564d20a8b, 0xf245825a5a445275}, /* 5^-57 */
+    {0xfb158592be068d2e, 0xeed6e2f0f0d56712}, /* 5^-56 */
+    {0x9ced737bb6c4183d, 0x55464dd69685606b}, /* 5^-55 */
+    {0xc428d05aa4751e4c, 0xaa97e14c3c26b886}, /* 5^-54 */
+    {0xf53304714d9265df, 0xd53dd99f4b3066a8}, /* 5^-53 */
+    {0x993fe2c6d07b7fab, 0xe546a8038efe4029}, /* 5^-52 */
+    {0xbf8fdb78849a5f96, 0xde98520472bdd033}, /* 5^-51 */
+    {0xef73d256a5c0f77c, 0x963e66858f6d4440}, /* 5^-50 */
+    {0x95a8637627989aad, 0xdde7001379a44aa8}, /* 5^-49 */
+    {0xbb127c53b17ec159, 0x5560c018580d5d52}, /* 5^-48 */
+    {0xe9d71b689dde71af, 0xaab8f01e6e10b4a6}, /* 5^-47 */
+    {0x9226712162ab070d, 0xcab3961304ca70e8}, /* 5^-46 */
+    {0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22}, /* 5^-45 */
+    {0xe45c10c42a2b3b05, 0x8cb89a7db77c506a}, /* 5^-44 */
+    {0x8eb98a7a9a5b04e3, 0x77f3608e92adb242}, /* 5^-43 */
+    {0xb267ed1940f1c61c, 0x55f038b237591ed3}, /* 5^-42 */
+    {0xdf01e85f912e37a3, 0x6b6c46dec52f6688}, /* 5^-41 */
+    {0x8b61313bbabce2c6, 0x2323ac4b3b3da015}, /* 5^-40 */
+    {0xae397d8aa96c1b77, 0xabec975e0a0d081a}, /* 5^-39 */
+    {0xd9c7dced53c72255, 0x96e7bd358c904a21}, /* 5^-38 */
+    {0x881cea14545c7575, 0x7e50d64177da2e54}, /* 5^-37 */
+    {0xaa242499697392d2, 0xdde50bd1d5d0b9e9}, /* 5^-36 */
+    {0xd4ad2dbfc3d07787, 0x955e4ec64b44e864}, /* 5^-35 */
+    {0x84ec3c97da624ab4, 0xbd5af13bef0b113e}, /* 5^-34 */
+    {0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e}, /* 5^-33 */
+    {0xcfb11ead453994ba, 0x67de18eda5814af2}, /* 5^-32 */
+    {0x81ceb32c4b43fcf4, 0x80eacf948770ced7}, /* 5^-31 */
+    {0xa2425ff75e14fc31, 0xa1258379a94d028d}, /* 5^-30 */
+    {0xcad2f7f5359a3b3e, 0x096ee45813a04330}, /* 5^-29 */
+    {0xfd87b5f28300ca0d, 0x8bca9d6e188853fc}, /* 5^-28 */
+    {0x9e74d1b791e07e48, 0x775ea264cf55347e}, /* 5^-27 */
+    {0xc612062576589dda, 0x95364afe032a819e}, /* 5^-26 */
+    {0xf79687aed3eec551, 0x3a83ddbd83f52205}, /* 5^-25 */
+    {0x9abe14cd44753b52, 0xc4926a9672793543}, /* 5^-24 */
+    {0xc16d9a0095928a27, 0x75b7053c0f178294}, /* 5^-23 */
+    {0xf1c90080baf72cb1, 0x5324c68b12dd6339}, /* 5^-22 */
+    {0x971da05074da7bee, 0xd3f6fc16ebca5e04}, /* 5^-21 */
+    {0xbce5086492111aea, 0x88f4bb1ca6bcf585}, /* 5^-20 */
+    {0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6}, /* 5^-19 */
+    {0x9392ee8e921d5d07, 0x3aff322e62439fd0}, /* 5^-18 */
+    {0xb877aa3236a4b449, 0x09befeb9fad487c3}, /* 5^-17 */
+    {0xe69594bec44de15b, 0x4c2ebe687989a9b4}, /* 5^-16 */
+    {0x901d7cf73ab0acd9, 0x0f9d37014bf60a11}, /* 5^-15 */
+    {0xb424dc35095cd80f, 0x538484c19ef38c95}, /* 5^-14 */
+    {0xe12e13424bb40e13, 0x2865a5f206b06fba}, /* 5^-13 */
+    {0x8cbccc096f5088cb, 0xf93f87b7442e45d4}, /* 5^-12 */
+    {0xafebff0bcb24aafe, 0xf78f69a51539d749}, /* 5^-11 */
+    {0xdbe6fecebdedd5be, 0xb573440e5a884d1c}, /* 5^-10 */
+    {0x89705f4136b4a597, 0x31680a88f8953031}, /* 5^-9 */
+    {0xabcc77118461cefc, 0xfdc20d2b36ba7c3e}, /* 5^-8 */
+    {0xd6bf94d5e57a42bc, 0x3d32907604691b4d}, /* 5^-7 */
+    {0x8637bd05af6c69b5, 0xa63f9a49c2c1b110}, /* 5^-6 */
+    {0xa7c5ac471b478423, 0x0fcf80dc33721d54}, /* 5^-5 */
+    {0xd1b71758e219652b, 0xd3c36113404ea4a9}, /* 5^-4 */
+    {0x83126e978d4fdf3b, 0x645a1cac083126ea}, /* 5^-3 */
+    {0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4}, /* 5^-2 */
+    {0xcccccccccccccccc, 0xcccccccccccccccd}, /* 5^-1 */
+    {0x8000000000000000, 0x0000000000000000}, /* 5^0 */
+    {0xa000000000000000, 0x0000000000000000}, /* 5^1 */
+    {0xc800000000000000, 0x0000000000000000}, /* 5^2 */
+    {0xfa00000000000000, 0x0000000000000000}, /* 5^3 */
+    {0x9c40000000000000, 0x0000000000000000}, /* 5^4 */
+    {0xc350000000000000, 0x0000000000000000}, /* 5^5 */
+    {0xf424000000000000, 0x0000000000000000}, /* 5^6 */
+    {0x9896800000000000, 0x0000000000000000}, /* 5^7 */
+    {0xbebc200000000000, 0x0000000000000000}, /* 5^8 */
+    {0xee6b280000000000, 0x0000000000000000}, /* 5^9 */
+    {0x9502f90000000000, 0x0000000000000000}, /* 5^10 */
+    {0xba43b74000000000, 0x0000000000000000}, /* 5^11 */
+    {0xe8d4a51000000000, 0x0000000000000000}, /* 5^12 */
+    {0x9184e72a00000000, 0x0000000000000000}, /* 5^13 */
+    {0xb5e620f480000000, 0x0000000000000000}, /* 5^14 */
+    {0xe35fa931a0000000, 0x0000000000000000}, /* 5^15 */
+    {0x8e1bc9bf04000000, 0x0000000000000000}, /* 5^16 */
+    {0xb1a2bc2ec5000000, 0x0000000000000000}, /* 5^17 */
+    {0xde0b6b3a76400000, 0x0000000000000000}, /* 5^18 */
+    {0x8ac7230489e80000, 0x0000000000000000}, /* 5^19 */
+    {0xad78ebc5ac620000, 0x0000000000000000}, /* 5^20 */
+    {0xd8d726b7177a8000, 0x0000000000000000}, /* 5^21 */
+    {0x878678326eac9000, 0x0000000000000000}, /* 5^22 */
+    {0xa968163f0a57b400, 0x0000000000000000}, /* 5^23 */
+    {0xd3c21bcecceda100, 0x0000000000000000}, /* 5^24 */
+    {0x84595161401484a0, 0x0000000000000000}, /* 5^25 */
+    {0xa56fa5b99019a5c8, 0x0000000000000000}, /* 5^26 */
+    {0xcecb8f27f4200f3a, 0x0000000000000000}, /* 5^27 */
+    {0x813f3978f8940984, 0x4000000000000000}, /* 5^28 */
+    {0xa18f07d736b90be5, 0x5000000000000000}, /* 5^29 */
+    {0xc9f2c9cd04674ede, 0xa400000000000000}, /* 5^30 */
+    {0xfc6f7c4045812296, 0x4d00000000000000}, /* 5^31 */
+    {0x9dc5ada82b70b59d, 0xf020000000000000}, /* 5^32 */
+    {0xc5371912364ce305, 0x6c28000000000000}, /* 5^33 */
+    {0xf684df56c3e01bc6, 0xc732000000000000}, /* 5^34 */
+    {0x9a130b963a6c115c, 0x3c7f400000000000}, /* 5^35 */
+    {0xc097ce7bc90715b3, 0x4b9f100000000000}, /* 5^36 */
+    {0xf0bdc21abb48db20, 0x1e86d40000000000}, /* 5^37 */
+    {0x96769950b50d88f4, 0x1314448000000000}, /* 5^38 */
+    {0xbc143fa4e250eb31, 0x17d955a000000000}, /* 5^39 */
+    {0xeb194f8e1ae525fd, 0x5dcfab0800000000}, /* 5^40 */
+    {0x92efd1b8d0cf37be, 0x5aa1cae500000000}, /* 5^41 */
+    {0xb7abc627050305ad, 0xf14a3d9e40000000}, /* 5^42 */
+    {0xe596b7b0c643c719, 0x6d9ccd05d0000000}, /* 5^43 */
+    {0x8f7e32ce7bea5c6f, 0xe4820023a2000000}, /* 5^44 */
+    {0xb35dbf821ae4f38b, 0xdda2802c8a800000}, /* 5^45 */
+    {0xe0352f62a19e306e, 0xd50b2037ad200000}, /* 5^46 */
+    {0x8c213d9da502de45, 0x4526f422cc340000}, /* 5^47 */
+    {0xaf298d050e4395d6, 0x9670b12b7f410000}, /* 5^48 */
+    {0xdaf3f04651d47b4c, 0x3c0cdd765f114000}, /* 5^49 */
+    {0x88d8762bf324cd0f, 0xa5880a69fb6ac800}, /* 5^50 */
+    {0xab0e93b6efee0053, 0x8eea0d047a457a00}, /* 5^51 */
+    {0xd5d238a4abe98068, 0x72a4904598d6d880}, /* 5^52 */
+    {0x85a36366eb71f041, 0x47a6da2b7f864750}, /* 5^53 */
+    {0xa70c3c40a64e6c51, 0x999090b65f67d924}, /* 5^54 */
+    {0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d}, /* 5^55 */
+    {0x82818f1281ed449f, 0xbff8f10e7a8921a4}, /* 5^56 */
+    {0xa321f2d7226895c7, 0xaff72d52192b6a0d}, /* 5^57 */
+    {0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490}, /* 5^58 */
+    {0xfee50b7025c36a08, 0x02f236d04753d5b4}, /* 5^59 */
+    {0x9f4f2726179a2245, 0x01d762422c946590}, /* 5^60 */
+    {0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5}, /* 5^61 */
+    {0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2}, /* 5^62 */
+    {0x9b934c3b330c8577, 0x63cc55f49f88eb2f}, /* 5^63 */
+    {0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb}, /* 5^64 */
+    {0xf316271c7fc3908a, 0x8bef464e3945ef7a}, /* 5^65 */
+    {0x97edd871cfda3a56, 0x97758bf0e3cbb5ac}, /* 5^66 */
+    {0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317}, /* 5^67 */
+    {0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd}, /* 5^68 */
+    {0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a}, /* 5^69 */
+    {0xb975d6b6ee39e436, 0xb3e2fd538e122b44}, /* 5^70 */
+    {0xe7d34c64a9c85d44, 0x60dbbca87196b616}, /* 5^71 */
+    {0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd}, /* 5^72 */
+    {0xb51d13aea4a488dd, 0x6babab6398bdbe41}, /* 5^73 */
+    {0xe264589a4dcdab14, 0xc696963c7eed2dd1}, /* 5^74 */
+    {0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2}, /* 5^75 */
+    {0xb0de65388cc8ada8, 0x3b25a55f43294bcb}, /* 5^76 */
+    {0xdd15fe86affad912, 0x49ef0eb713f39ebe}, /* 5^77 */
+    {0x8a2dbf142dfcc7ab, 0x6e3569326c784337}, /* 5^78 */
+    {0xacb92ed9397bf996, 0x49c2c37f07965404}, /* 5^79 */
+    {0xd7e77a8f87daf7fb, 0xdc33745ec97be906}, /* 5^80 */
+    {0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3}, /* 5^81 */
+    {0xa8acd7c0222311bc, 0xc40832ea0d68ce0c}, /* 5^82 */
+    {0xd2d80db02aabd62b, 0xf50a3fa490c30190}, /* 5^83 */
+    {0x83c7088e1aab65db, 0x792667c6da79e0fa}, /* 5^84 */
+    {0xa4b8cab1a1563f52, 0x577001b891185938}, /* 5^85 */
+    {0xcde6fd5e09abcf26, 0xed4c0226b55e6f86}, /* 5^86 */
+    {0x80b05e5ac60b6178, 0x544f8158315b05b4}, /* 5^87 */
+    {0xa0dc75f1778e39d6, 0x696361ae3db1c721}, /* 5^88 */
+    {0xc913936dd571c84c, 0x03bc3a19cd1e38e9}, /* 5^89 */
+    {0xfb5878494ace3a5f, 0x04ab48a04065c723}, /* 5^90 */
+    {0x9d174b2dcec0e47b, 0x62eb0d64283f9c76}, /* 5^91 */
+    {0xc45d1df942711d9a, 0x3ba5d0bd324f8394}, /* 5^92 */
+    {0xf5746577930d6500, 0xca8f44ec7ee36479}, /* 5^93 */
+    {0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb}, /* 5^94 */
+    {0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e}, /* 5^95 */
+    {0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e}, /* 5^96 */
+    {0x95d04aee3b80ece5, 0xbba1f1d158724a12}, /* 5^97 */
+    {0xbb445da9ca61281f, 0x2a8a6e45ae8edc97}, /* 5^98 */
+    {0xea1575143cf97226, 0xf52d09d71a3293bd}, /* 5^99 */
+    {0x924d692ca61be758, 0x593c2626705f9c56}, /* 5^100 */
+    {0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c}, /* 5^101 */
+    {0xe498f455c38b997a, 0x0b6dfb9c0f956447}, /* 5^102 */
+    {0x8edf98b59a373fec, 0x4724bd4189bd5eac}, /* 5^103 */
+    {0xb2977ee300c50fe7, 0x58edec91ec2cb657}, /* 5^104 */
+    {0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed}, /* 5^105 */
+    {0x8b865b215899f46c, 0xbd79e0d20082ee74}, /* 5^106 */
+    {0xae67f1e9aec07187, 0xecd8590680a3aa11}, /* 5^107 */
+    {0xda01ee641a708de9, 0xe80e6f4820cc9495}, /* 5^108 */
+    {0x884134fe908658b2, 0x3109058d147fdcdd}, /* 5^109 */
+    {0xaa51823e34a7eede, 0xbd4b46f0599fd415}, /* 5^110 */
+    {0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a}, /* 5^111 */
+    {0x850fadc09923329e, 0x03e2cf6bc604ddb0}, /* 5^112 */
+    {0xa6539930bf6bff45, 0x84db8346b786151c}, /* 5^113 */
+    {0xcfe87f7cef46ff16, 0xe612641865679a63}, /* 5^114 */
+    {0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e}, /* 5^115 */
+    {0xa26da3999aef7749, 0xe3be5e330f38f09d}, /* 5^116 */
+    {0xcb090c8001ab551c, 0x5cadf5bfd3072cc5}, /* 5^117 */
+    {0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6}, /* 5^118 */
+    {0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa}, /* 5^119 */
+    {0xc646d63501a1511d, 0xb281e1fd541501b8}, /* 5^120 */
+    {0xf7d88bc24209a565, 0x1f225a7ca91a4226}, /* 5^121 */
+    {0x9ae757596946075f, 0x3375788de9b06958}, /* 5^122 */
+    {0xc1a12d2fc3978937, 0x0052d6b1641c83ae}, /* 5^123 */
+    {0xf209787bb47d6b84, 0xc0678c5dbd23a49a}, /* 5^124 */
+    {0x9745eb4d50ce6332, 0xf840b7ba963646e0}, /* 5^125 */
+    {0xbd176620a501fbff, 0xb650e5a93bc3d898}, /* 5^126 */
+    {0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe}, /* 5^127 */
+    {0x93ba47c980e98cdf, 0xc66f336c36b10137}, /* 5^128 */
+    {0xb8a8d9bbe123f017, 0xb80b0047445d4184}, /* 5^129 */
+    {0xe6d3102ad96cec1d, 0xa60dc059157491e5}, /* 5^130 */
+    {0x9043ea1ac7e41392, 0x87c89837ad68db2f}, /* 5^131 */
+    {0xb454e4a179dd1877, 0x29babe4598c311fb}, /* 5^132 */
+    {0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a}, /* 5^133 */
+    {0x8ce2529e2734bb1d, 0x1899e4a65f58660c}, /* 5^134 */
+    {0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f}, /* 5^135 */
+    {0xdc21a1171d42645d, 0x76707543f4fa1f73}, /* 5^136 */
+    {0x899504ae72497eba, 0x6a06494a791c53a8}, /* 5^137 */
+    {0xabfa45da0edbde69, 0x0487db9d17636892}, /* 5^138 */
+    {0xd6f8d7509292d603, 0x45a9d2845d3c42b6}, /* 5^139 */
+    {0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2}, /* 5^140 */
+    {0xa7f26836f282b732, 0x8e6cac7768d7141e}, /* 5^141 */
+    {0xd1ef0244af2364ff, 0x3207d795430cd926}, /* 5^142 */
+    {0x8335616aed761f1f, 0x7f44e6bd49e807b8}, /* 5^143 */
+    {0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6}, /* 5^144 */
+    {0xcd036837130890a1, 0x36dba887c37a8c0f}, /* 5^145 */
+    {0x802221226be55a64, 0xc2494954da2c9789}, /* 5^146 */
+    {0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c}, /* 5^147 */
+    {0xc83553c5c8965d3d, 0x6f92829494e5acc7}, /* 5^148 */
+    {0xfa42a8b73abbf48c, 0xcb772339ba1f17f9}, /* 5^149 */
+    {0x9c69a97284b578d7, 0xff2a760414536efb}, /* 5^150 */
+    {0xc38413cf25e2d70d, 0xfef5138519684aba}, /* 5^151 */
+    {0xf46518c2ef5b8cd1, 0x7eb258665fc25d69}, /* 5^152 */
+    {0x98bf2f79d5993802, 0xef2f773ffbd97a61}, /* 5^153 */
+    {0xbeeefb584aff8603, 0xaafb550ffacfd8fa}, /* 5^154 */
+    {0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38}, /* 5^155 */
+    {0x952ab45cfa97a0b2, 0xdd945a747bf26183}, /* 5^156 */
+    {0xba756174393d88df, 0x94f971119aeef9e4}, /* 5^157 */
+    {0xe912b9d1478ceb17, 0x7a37cd5601aab85d}, /* 5^158 */
+    {0x91abb422ccb812ee, 0xac62e055c10ab33a}, /* 5^159 */
+    {0xb616a12b7fe617aa, 0x577b986b314d6009}, /* 5^160 */
+    {0xe39c49765fdf9d94, 0xed5a7e85fda0b80b}, /* 5^161 */
+    {0x8e41ade9fbebc27d, 0x14588f13be847307}, /* 5^162 */
+    {0xb1d219647ae6b31c, 0x596eb2d8ae258fc8}, /* 5^163 */
+    {0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb}, /* 5^164 */
+    {0x8aec23d680043bee, 0x25de7bb9480d5854}, /* 5^165 */
+    {0xada72ccc20054ae9, 0xaf561aa79a10ae6a}, /* 5^166 */
+    {0xd910f7ff28069da4, 0x1b2ba1518094da04}, /* 5^167 */
+    {0x87aa9aff79042286, 0x90fb44d2f05d0842}, /* 5^168 */
+    {0xa99541bf57452b28, 0x353a1607ac744a53}, /* 5^169 */
+    {0xd3fa922f2d1675f2, 0x42889b8997915ce8}, /* 5^170 */
+    {0x847c9b5d7c2e09b7, 0x69956135febada11}, /* 5^171 */
+    {0xa59bc234db398c25, 0x43fab9837e699095}, /* 5^172 */
+    {0xcf02b2c21207ef2e, 0x94f967e45e03f4bb}, /* 5^173 */
+    {0x8161afb94b44f57d, 0x1d1be0eebac278f5}, /* 5^174 */
+    {0xa1ba1ba79e1632dc, 0x6462d92a69731732}, /* 5^175 */
+    {0xca28a291859bbf93, 0x7d7b8f7503cfdcfe}, /* 5^176 */
+    {0xfcb2cb35e702af78, 0x5cda735244c3d43e}, /* 5^177 */
+    {0x9defbf01b061adab, 0x3a0888136afa64a7}, /* 5^178 */
+    {0xc56baec21c7a1916, 0x088aaa1845b8fdd0}, /* 5^179 */
+    {0xf6c69a72a3989f5b, 0x8aad549e57273d45}, /* 5^180 */
+    {0x9a3c2087a63f6399, 0x36ac54e2f678864b}, /* 5^181 */
+    {0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd}, /* 5^182 */
+    {0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5}, /* 5^183 */
+    {0x969eb7c47859e743, 0x9f644ae5a4b1b325}, /* 5^184 */
+    {0xbc4665b596706114, 0x873d5d9f0dde1fee}, /* 5^185 */
+    {0xeb57ff22fc0c7959, 0xa90cb506d155a7ea}, /* 5^186 */
+    {0x9316ff75dd87cbd8, 0x09a7f12442d588f2}, /* 5^187 */
+    {0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f}, /* 5^188 */
+    {0xe5d3ef282a242e81, 0x8f1668c8a86da5fa}, /* 5^189 */
+    {0x8fa475791a569d10, 0xf96e017d694487bc}, /* 5^190 */
+    {0xb38d92d760ec4455, 0x37c981dcc395a9ac}, /* 5^191 */
+    {0xe070f78d3927556a, 0x85bbe253f47b1417}, /* 5^192 */
+    {0x8c469ab843b89562, 0x93956d7478ccec8e}, /* 5^193 */
+    {0xaf58416654a6babb, 0x387ac8d1970027b2}, /* 5^194 */
+    {0xdb2e51bfe9d0696a, 0x06997b05fcc0319e}, /* 5^195 */
+    {0x88fcf317f22241e2, 0x441fece3bdf81f03}, /* 5^196 */
+    {0xab3c2fddeeaad25a, 0xd527e81cad7626c3}, /* 5^197 */
+    {0xd60b3bd56a5586f1, 0x8a71e223d8d3b074}, /* 5^198 */
+    {0x85c7056562757456, 0xf6872d5667844e49}, /* 5^199 */
+    {0xa738c6bebb12d16c, 0xb428f8ac016561db}, /* 5^200 */
+    {0xd106f86e69d785c7, 0xe13336d701beba52}, /* 5^201 */
+    {0x82a45b450226b39c, 0xecc0024661173473}, /* 5^202 */
+    {0xa34d721642b06084, 0x27f002d7f95d0190}, /* 5^203 */
+    {0xcc20ce9bd35c78a5, 0x31ec038df7b441f4}, /* 5^204 */
+    {0xff290242c83396ce, 0x7e67047175a15271}, /* 5^205 */
+    {0x9f79a169bd203e41, 0x0f0062c6e984d386}, /* 5^206 */
+    {0xc75809c42c684dd1, 0x52c07b78a3e60868}, /* 5^207 */
+    {0xf92e0c3537826145, 0xa7709a56ccdf8a82}, /* 5^208 */
+    {0x9bbcc7a142b17ccb, 0x88a66076400bb691}, /* 5^209 */
+    {0xc2abf989935ddbfe, 0x6acff893d00ea435}, /* 5^210 */
+    {0xf356f7ebf83552fe, 0x0583f6b8c4124d43}, /* 5^211 */
+    {0x98165af37b2153de, 0xc3727a337a8b704a}, /* 5^212 */
+    {0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c}, /* 5^213 */
+    {0xeda2ee1c7064130c, 0x1162def06f79df73}, /* 5^214 */
+    {0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8}, /* 5^215 */
+    {0xb9a74a0637ce2ee1, 0x6d953e2bd7173692}, /* 5^216 */
+    {0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437}, /* 5^217 */
+    {0x910ab1d4db9914a0, 0x1d9c9892400a22a2}, /* 5^218 */
+    {0xb54d5e4a127f59c8, 0x2503beb6d00cab4b}, /* 5^219 */
+    {0xe2a0b5dc971f303a, 0x2e44ae64840fd61d}, /* 5^220 */
+    {0x8da471a9de737e24, 0x5ceaecfed289e5d2}, /* 5^221 */
+    {0xb10d8e1456105dad, 0x7425a83e872c5f47}, /* 5^222 */
+    {0xdd50f1996b947518, 0xd12f124e28f77719}, /* 5^223 */
+    {0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f}, /* 5^224 */
+    {0xace73cbfdc0bfb7b, 0x636cc64d1001550b}, /* 5^225 */
+    {0xd8210befd30efa5a, 0x3c47f7e05401aa4e}, /* 5^226 */
+    {0x8714a775e3e95c78, 0x65acfaec34810a71}, /* 5^227 */
+    {0xa8d9d1535ce3b396, 0x7f1839a741a14d0d}, /* 5^228 */
+    {0xd31045a8341ca07c, 0x1ede48111209a050}, /* 5^229 */
+    {0x83ea2b892091e44d, 0x934aed0aab460432}, /* 5^230 */
+    {0xa4e4b66b68b65d60, 0xf81da84d5617853f}, /* 5^231 */
+    {0xce1de40642e3f4b9, 0x36251260ab9d668e}, /* 5^232 */
+    {0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019}, /* 5^233 */
+    {0xa1075a24e4421730, 0xb24cf65b8612f81f}, /* 5^234 */
+    {0xc94930ae1d529cfc, 0xdee033f26797b627}, /* 5^235 */
+    {0xfb9b7cd9a4a7443c, 0x169840ef017da3b1}, /* 5^236 */
+    {0x9d412e0806e88aa5, 0x8e1f289560ee864e}, /* 5^237 */
+    {0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2}, /* 5^238 */
+    {0xf5b5d7ec8acb58a2, 0xae10af696774b1db}, /* 5^239 */
+    {0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29}, /* 5^240 */
+    {0xbff610b0cc6edd3f, 0x17fd090a58d32af3}, /* 5^241 */
+    {0xeff394dcff8a948e, 0xddfc4b4cef07f5b0}, /* 5^242 */
+    {0x95f83d0a1fb69cd9, 0x4abdaf101564f98e}, /* 5^243 */
+    {0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1}, /* 5^244 */
+    {0xea53df5fd18d5513, 0x84c86189216dc5ed}, /* 5^245 */
+    {0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4}, /* 5^246 */
+    {0xb7118682dbb66a77, 0x3fbc8c33221dc2a1}, /* 5^247 */
+    {0xe4d5e82392a40515, 0x0fabaf3feaa5334a}, /* 5^248 */
+    {0x8f05b1163ba6832d, 0x29cb4d87f2a7400e}, /* 5^249 */
+    {0xb2c71d5bca9023f8, 0x743e20e9ef511012}, /* 5^250 */
+    {0xdf78e4b2bd342cf6, 0x914da9246b255416}, /* 5^251 */
+    {0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e}, /* 5^252 */
+    {0xae9672aba3d0c320, 0xa184ac2473b529b1}, /* 5^253 */
+    {0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e}, /* 5^254 */
+    {0x8865899617fb1871, 0x7e2fa67c7a658892}, /* 5^255 */
+    {0xaa7eebfb9df9de8d, 0xddbb901b98feeab7}, /* 5^256 */
+    {0xd51ea6fa85785631, 0x552a74227f3ea565}, /* 5^257 */
+    {0x8533285c936b35de, 0xd53a88958f87275f}, /* 5^258 */
+    {0xa67ff273b8460356, 0x8a892abaf368f137}, /* 5^259 */
+    {0xd01fef10a657842c, 0x2d2b7569b0432d85}, /* 5^260 */
+    {0x8213f56a67f6b29b, 0x9c3b29620e29fc73}, /* 5^261 */
+    {0xa298f2c501f45f42, 0x8349f3ba91b47b8f}, /* 5^262 */
+    {0xcb3f2f7642717713, 0x241c70a936219a73}, /* 5^263 */
+    {0xfe0efb53d30dd4d7, 0xed238cd383aa0110}, /* 5^264 */
+    {0x9ec95d1463e8a506, 0xf4363804324a40aa}, /* 5^265 */
+    {0xc67bb4597ce2ce48, 0xb143c6053edcd0d5}, /* 5^266 */
+    {0xf81aa16fdc1b81da, 0xdd94b7868e94050a}, /* 5^267 */
+    {0x9b10a4e5e9913128, 0xca7cf2b4191c8326}, /* 5^268 */
+    {0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0}, /* 5^269 */
+    {0xf24a01a73cf2dccf, 0xbc633b39673c8cec}, /* 5^270 */
+    {0x976e41088617ca01, 0xd5be0503e085d813}, /* 5^271 */
+    {0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18}, /* 5^272 */
+    {0xec9c459d51852ba2, 0xddf8e7d60ed1219e}, /* 5^273 */
+    {0x93e1ab8252f33b45, 0xcabb90e5c942b503}, /* 5^274 */
+    {0xb8da1662e7b00a17, 0x3d6a751f3b936243}, /* 5^275 */
+    {0xe7109bfba19c0c9d, 0x0cc512670a783ad4}, /* 5^276 */
+    {0x906a617d450187e2, 0x27fb2b80668b24c5}, /* 5^277 */
+    {0xb484f9dc9641e9da, 0xb1f9f660802dedf6}, /* 5^278 */
+    {0xe1a63853bbd26451, 0x5e7873f8a0396973}, /* 5^279 */
+    {0x8d07e33455637eb2, 0xdb0b487b6423e1e8}, /* 5^280 */
+    {0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62}, /* 5^281 */
+    {0xdc5c5301c56b75f7, 0x7641a140cc7810fb}, /* 5^282 */
+    {0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d}, /* 5^283 */
+    {0xac2820d9623bf429, 0x546345fa9fbdcd44}, /* 5^284 */
+    {0xd732290fbacaf133, 0xa97c177947ad4095}, /* 5^285 */
+    {0x867f59a9d4bed6c0, 0x49ed8eabcccc485d}, /* 5^286 */
+    {0xa81f301449ee8c70, 0x5c68f256bfff5a74}, /* 5^287 */
+    {0xd226fc195c6a2f8c, 0x73832eec6fff3111}, /* 5^288 */
+    {0x83585d8fd9c25db7, 0xc831fd53c5ff7eab}, /* 5^289 */
+    {0xa42e74f3d032f525, 0xba3e7ca8b77f5e55}, /* 5^290 */
+    {0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb}, /* 5^291 */
+    {0x80444b5e7aa7cf85, 0x7980d163cf5b81b3}, /* 5^292 */
+    {0xa0555e361951c366, 0xd7e105bcc332621f}, /* 5^293 */
+    {0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7}, /* 5^294 */
+    {0xfa856334878fc150, 0xb14f98f6f0feb951}, /* 5^295 */
+    {0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3}, /* 5^296 */
+    {0xc3b8358109e84f07, 0x0a862f80ec4700c8}, /* 5^297 */
+    {0xf4a642e14c6262c8, 0xcd27bb612758c0fa}, /* 5^298 */
+    {0x98e7e9cccfbd7dbd, 0x8038d51cb897789c}, /* 5^299 */
+    {0xbf21e44003acdd2c, 0xe0470a63e6bd56c3}, /* 5^300 */
+    {0xeeea5d5004981478, 0x1858ccfce06cac74}, /* 5^301 */
+    {0x95527a5202df0ccb, 0x0f37801e0c43ebc8}, /* 5^302 */
+    {0xbaa718e68396cffd, 0xd30560258f54e6ba}, /* 5^303 */
+    {0xe950df20247c83fd, 0x47c6b82ef32a2069}, /* 5^304 */
+    {0x91d28b7416cdd27e, 0x4cdc331d57fa5441}, /* 5^305 */
+    {0xb6472e511c81471d, 0xe0133fe4adf8e952}, /* 5^306 */
+    {0xe3d8f9e563a198e5, 0x58180fddd97723a6}, /* 5^307 */
+    {0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648}, /* 5^308 */
+};
+
+/* 10^0 ~ 10^22 都可以用double精确表示*/
+static const double lept_exact_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#if defined(__SIZEOF_INT128__)
+__extension__ typedef unsigned __int128 lept_uint128;
+#endif
+
+/* 64位乘64位 返回低64位 高64位写入hi*/
+static uint64_t lept_mul128(uint64_t a, uint64_t b, uint64_t* hi) {
+#if defined(__SIZEOF_INT128__)
+    lept_uint128 r = (lept_uint128)a * b;
+    *hi = (uint64_t)(r >> 64);
+    return (uint64_t)r;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, hi);
+#else
+    uint64_t al = a & 0xffffffffu, ah = a >> 32, bl = b & 0xffffffffu, bh = b >> 32;
+    uint64_t ll = al * bl, lh = al * bh, hl = ah * bl, hh = ah * bh;
+    uint64_t mid = (ll >> 32) + (lh & 0xffffffffu) + (hl & 0xffffffffu);
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return (mid << 32) | (ll & 0xffffffffu);
+#endif
+}
+
+static int lept_clz64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_clzll(x);
+#else
+    int n = 0;
+    while (!(x & ((uint64_t)1 << 63))) {
+        x <<= 1;
+        n++;
     }
-    return p;
+    return n;
+#endif
 }
 
 /*
-    将解析的码点编码成UTF-8 只有高代理项没有低代理项 或者低代理项不合理的均返回LEPT_PARSE_INVALID_UNICODE_SURROGATE错误
-    \u后面不是四位十六进制数字返回LEPT_PARSE_INVALID_UNICODE_HEX错误
-    根据UTF-8码表
+    Eisel-Lemire: 计算 w * 10^q 最近的double的位模式(不含符号位) w不为0
+    q已经保证在[LEPT_POW5_MIN_EXP, LEPT_POW5_MAX_EXP]内
 */
-static void lept_encode_utf8(lept_context* c, unsigned u) {
-    if (u <= 0x7f) {
-        // 码点范围是U+0000~U+007F
-        PUTC(c, u & 0xff);
+static uint64_t lept_eisel_lemire(uint64_t w, int q) {
+    const uint64_t* pow5 = lept_pow5_128[q - LEPT_POW5_MIN_EXP];
+    uint64_t lo, hi, hi2, mantissa;
+    int lz, upperbit, shift, power2;
+    lz = lept_clz64(w);
+    w <<= lz;
+    lo = lept_mul128(w, pow5[0], &hi);
+    /* 只有高位的低55位全为1时 第二个字才可能影响结果*/
+    if ((hi & 0x1ff) == 0x1ff) {
+        (void)lept_mul128(w, pow5[1], &hi2);
+        lo += hi2;
+        if (hi2 > lo) {
+            hi++;
+        }
     }
-    else if (u <= 0x7ff) {
-        // 码点范围是U+0080~U+07FF 共11位
-        PUTC(c, 0xc0 | ((u >> 6) & 0xff));// 取高5位
-        PUTC(c, 0x80 | (u      & 0x3f));// 取低6位
+    upperbit = (int)(hi >> 63);
+    shift = upperbit + 64 - 52 - 3;
+    mantissa = hi >> shift;
+    /* floor(log2(10^q)) + 63 再加上偏置1023*/
+    power2 = (((152170 + 65536) * q) >> 16) + 63 + upperbit - lz + 1023;
+    if (power2 <= 0) {
+        /* 非规格化数*/
+        if (-power2 + 1 >= 64) {
+            return 0;
+        }
+        mantissa >>= -power2 + 1;
+        mantissa += mantissa & 1;
+        mantissa >>= 1;
+        /* 舍入后可能恰好进位成最小的规格化数*/
+        power2 = mantissa < ((uint64_t)1 << 52) ? 0 : 1;
+        return (mantissa & ~((uint64_t)1 << 52)) | ((uint64_t)power2 << 52);
     }
-    else if (u <= 0xffff) {
-        // 码点范围是U+0800~U+FFFF 共16位
-        PUTC(c, 0xe0 | ((u >> 12) & 0xff));// 取高4位
-        PUTC(c, 0x80 | ((u >> 6)  & 0x3f));// 取中6位
-        PUTC(c, 0x80 | (u         & 0x3f));// 取后6位
+    /* 恰好在两个double中间时向偶数舍入 只有5^q能放进64位时才会发生*/
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == hi) {
+        mantissa &= ~(uint64_t)1;
     }
-    else {
-        assert(u <= 0x10ffff);
-        // 码点范围是U+10000~U+10FFFF 共21位
-        PUTC(c, 0xf0 | ((u >> 18) & 0xff));// 取高三位
-        PUTC(c, 0x80 | ((u >> 12) & 0x3f));// 取随后6位
-        PUTC(c, 0x80 | ((u >> 6)  & 0x3f));// 取随后6位
-        PUTC(c, 0x80 | (u         & 0x3f));// 取最后6位
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= ((uint64_t)2 << 52)) {
+        mantissa = (uint64_t)1 << 52;
+        power2++;
     }
+    mantissa &= ~((uint64_t)1 << 52);
+    if (power2 >= 0x7ff) {
+        return (uint64_t)0x7ff << 52;
+    }
+    return mantissa | ((uint64_t)power2 << 52);
 }
 
-/*
-    这个宏用来统一下一个函数中关于字符串的返回
-*/
-#define STRING_ERROR(ret) do { c->top = head; return ret; } while(0)
+/* 十进制大数 只在前两步无法得出结果时使用*/
+#define LEPT_DECIMAL_DIGITS 800
+#define LEPT_DECIMAL_MAX_SHIFT 60
 
-/*
-    解析字符串
-*/
-static int lept_parse_string(lept_context* c, lept_value* v) {
-    size_t head = c->top, len;
-    // u, u2是存储解析的unicode码
-    unsigned u, u2;
-    const char* p;
+typedef struct {
+    unsigned char d[LEPT_DECIMAL_DIGITS]; /* 十进制数字 0~9 高位在前*/
+    int nd; /* 数字个数*/
+    int dp; /* 小数点位置 值为0.d[0]d[1]... * 10^dp*/
+    int trunc; /* 是否丢弃了非0的数字*/
+} lept_decimal;
+
+static void lept_decimal_trim(lept_decimal* a) {
+    while (a->nd > 0 && a->d[a->nd - 1] == 0) {
+        a->nd--;
+    }
+    if (a->nd == 0) {
+        a->dp = 0;
+    }
+}
+
+/* 从合法的JSON数字文本[p, end)读取 忽略符号*/
+static void lept_decimal_read(lept_decimal* a, const char* p, const char* end) {
+    int sawdot = 0, eneg = 0, e = 0;
+    a->nd = a->dp = a->trunc = 0;
+    if (*p == '-') {
+        p++;
+    }
+    for ( ; p != end; p++) {
+        if (*p == '.') {
+            sawdot = 1;
+            a->dp = a->nd;
+        }
+        else if (ISDIGIT(*p)) {
+            if (*p == '0' && a->nd == 0) {
+                /* 忽略前导0*/
+                a->dp--;
+            }
+            else if (a->nd < LEPT_DECIMAL_DIGITS) {
+                a->d[a->nd++] = (unsigned char)(*p - '0');
+            }
+            else if (*p != '0') {
+                a->trunc = 1;
+            }
+        }
+        else {
+            break;
+        }
+    }
+    if (!sawdot) {
+        a->dp = a->nd;
+    }
+    if (p != end) {
+        assert(*p == 'e' || *p == 'E');
+        p++;
+        if (*p == '+' || *p == '-') {
+            eneg = *p++ == '-';
+        }
+        for ( ; p != end; p++) {
+            if (e < 10000) {
+                e = e * 10 + (*p - '0');
+            }
+        }
+    }
+    a->dp += eneg ? -e : e;
+    lept_decimal_trim(a);
+}
+
+/* 除以2^k*/
+static void lept_decimal_right_shift(lept_decimal* a, int k) {
+    int r = 0, w = 0;
+    uint64_t n = 0, mask = ((uint64_t)1 << k) - 1;
+    /* 取足够多的高位数字 使得第一次除法的商不为0*/
+    for ( ; (n >> k) == 0; r++) {
+        if (r >= a->nd) {
+            if (n == 0) {
+                a->nd = 0;
+                return;
+            }
+            while ((n >> k) == 0) {
+                n *= 10;
+                r++;
+            }
+            break;
+        }
+        n = n * 10 + a->d[r];
+    }
+    a->dp -= r - 1;
+    for ( ; r < a->nd; r++) {
+        a->d[w++] = (unsigned char)(n >> k);
+        n = (n & mask) * 10 + a->d[r];
+    }
+    while (n > 0) {
+        unsigned char dig = (unsigned char)(n >> k);
+        n &= mask;
+        if (w < LEPT_DECIMAL_DIGITS) {
+            a->d[w++] = dig;
+        }
+        else if (dig > 0) {
+            a->trunc = 1;
+        }
+        n *= 10;
+    }
+    a->nd = w;
+    lept_decimal_trim(a);
+}
+
+/* 乘以2^k*/
+static void lept_decimal_left_shift(lept_decimal* a, int k) {
+    int r, w, delta = 0;
+    uint64_t n = 0;
+    /* 先算出最高位的进位 得到新增的位数*/
+    for (r = a->nd - 1; r >= 0; r--) {
+        n = (n + ((uint64_t)a->d[r] << k)) / 10;
+    }
+    for ( ; n > 0; n /= 10) {
+        delta++;
+    }
+    w = a->nd + delta;
+    for (r = a->nd - 1; r >= 0; r--) {
+        uint64_t quo;
+        n += (uint64_t)a->d[r] << k;
+        quo = n / 10;
+        if (--w < LEPT_DECIMAL_DIGITS) {
+            a->d[w] = (unsigned char)(n - 10 * quo);
+        }
+        else if (n - 10 * quo != 0) {
+            a->trunc = 1;
+        }
+        n = quo;
+    }
+    while (n > 0) {
+        uint64_t quo = n / 10;
+        if (--w < LEPT_DECIMAL_DIGITS) {
+            a->d[w] = (unsigned char)(n - 10 * quo);
+        }
+        else if (n - 10 * quo != 0) {
+            a->trunc = 1;
+        }
+        n = quo;
+    }
+    a->nd += delta;
+    if (a->nd > LEPT_DECIMAL_DIGITS) {
+        a->nd = LEPT_DECIMAL_DIGITS;
+    }
+    a->dp += delta;
+    lept_decimal_trim(a);
+}
+
+static void lept_decimal_shift(lept_decimal* a, int k) {
+    if (a->nd == 0) {
+        return;
+    }
+    for ( ; k > LEPT_DECIMAL_MAX_SHIFT; k -= LEPT_DECIMAL_MAX_SHIFT) {
+        lept_decimal_left_shift(a, LEPT_DECIMAL_MAX_SHIFT);
+    }
+    for ( ; k < -LEPT_DECIMAL_MAX_SHIFT; k += LEPT_DECIMAL_MAX_SHIFT) {
+        lept_decimal_right_shift(a, LEPT_DECIMAL_MAX_SHIFT);
+    }
+    if (k > 0) {
+        lept_decimal_left_shift(a, k);
+    }
+    else if (k < 0) {
+        lept_decimal_right_shift(a, -k);
+    }
+}
+
+/* 取整数部分 按四舍六入五成双舍入*/
+static uint64_t lept_decimal_rounded_integer(const lept_decimal* a) {
+    uint64_t n = 0;
+    int i, up;
+    if (a->dp > 20) {
+        return ~(uint64_t)0;
+    }
+    for (i = 0; i < a->dp && i < a->nd; i++) {
+        n = n * 10 + a->d[i];
+    }
+    for ( ; i < a->dp; i++) {
+        n *= 10;
+    }
+    if (a->dp < 0 || a->dp >= a->nd) {
+        up = 0;
+    }
+    else if (a->d[a->dp] == 5 && a->dp + 1 == a->nd) {
+        /* 恰好一半: 截断过说明实际更大 否则向偶数舍入*/
+        up = a->trunc || (a->dp > 0 && (a->d[a->dp - 1] & 1));
+    }
+    else {
+        up = a->d[a->dp] >= 5;
+    }
+    return n + up;
+}
+
+/* 返回不含符号位的double位模式*/
+static uint64_t lept_decimal_to_bits(lept_decimal* a) {
+    static const int powtab[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+    uint64_t mant;
+    int exp = 0, n;
+    if (a->nd == 0 || a->dp < -330) {
+        return 0;
+    }
+    if (a->dp > 310) {
+        return (uint64_t)0x7ff << 52;
+    }
+    /* 乘除2的幂 直到值落在[0.5, 1)*/
+    while (a->dp > 0) {
+        n = a->dp >= 9 ? 27 : powtab[a->dp];
+        lept_decimal_shift(a, -n);
+        exp += n;
+    }
+    while (a->dp < 0 || (a->dp == 0 && a->d[0] < 5)) {
+        n = -a->dp >= 9 ? 27 : powtab[-a->dp];
+        lept_decimal_shift(a, n);
+        exp -= n;
+    }
+    /* [0.5, 1) 转为 [1, 2)*/
+    exp--;
+    /* 最小的指数是-1022 更小的部分变成非规格化数*/
+    if (exp < -1022) {
+        n = -1022 - exp;
+        lept_decimal_shift(a, -n);
+        exp += n;
+    }
+    if (exp + 1023 >= 0x7ff) {
+        return (uint64_t)0x7ff << 52;
+    }
+    lept_decimal_shift(a, 53);
+    mant = lept_decimal_rounded_integer(a);
+    if (mant == ((uint64_t)2 << 52)) {
+        mant >>= 1;
+        if (++exp + 1023 >= 0x7ff) {
+            return (uint64_t)0x7ff << 52;
+        }
+    }
+    if (!(mant & ((uint64_t)1 << 52))) {
+        /* 非规格化数 指数域为0*/
+        return mant;
+    }
+    return (mant & (((uint64_t)1 << 52) - 1)) | ((uint64_t)(exp + 1023) << 52);
+}
+
+/*
+    w * 10^exp10 转换为double
+    w是前19位有效数字 truncated表示之后还有非0的数字 此时需要原文[json, end)做精确计算
+*/
+static double lept_decimal_to_double(int neg, uint64_t w, int64_t exp10, int truncated, const char* json, const char* end) {
+    uint64_t bits;
+    double d;
+#if FLT_EVAL_METHOD == 0
+    if (!truncated && w <= ((uint64_t)1 << 53) && exp10 >= -22 && exp10 <= 22) {
+        d = (double)w;
+        d = exp10 < 0 ? d / lept_exact_pow10[-exp10] : d * lept_exact_pow10[exp10];
+        return neg ? -d : d;
+    }
+#endif
+    if (w == 0 || exp10 < LEPT_POW5_MIN_EXP) {
+        bits = 0;
+    }
+    else if (exp10 > LEPT_POW5_MAX_EXP) {
+        bits = (uint64_t)0x7ff << 52;
+    }
+    else {
+        bits = lept_eisel_lemire(w, (int)exp10);
+        /* 被截断的数字介于w和w+1之间 两端结果一致时就是答案*/
+        if (truncated && bits != lept_eisel_lemire(w + 1, (int)exp10)) {
+            lept_decimal a;
+            lept_decimal_read(&a, json, end);
+            bits = lept_decimal_to_bits(&a);
+        }
+    }
+    if (neg) {
+        bits |= (uint64_t)1 << 63;
+    }
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+/*
+    扫描数字 成功时结果写入n c->json移到数字之后
+    验证语法的同时收集前19位有效数字和十进制指数 交给lept_decimal_to_double()
+*/
+static int lept_scan_number(lept_context* c, double* n) {
+    const char* p = c->json;
+    uint64_t w = 0; /* 有效数字*/
+    int digits = 0; /* w中有效数字的个数 最多19个*/
+    int64_t exp10 = 0; /* 值为w * 10^exp10*/
+    int neg = 0, truncated = 0;
+    if (PEEK(c, p) == '-') { // 可以是负数
+        neg = 1;
+        p++;
+    }
+    // 接下来要么是0 要么是1-9
+    if (PEEK(c, p) == '0') {
+        p++;
+    } else {
+        if (!ISDIGIT1TO9(PEEK(c, p))) {
+            return LEPT_PARSE_INVALID_VALUE;
+        }
+        // 第一个是1-9 后面的只要是数字都是合法的
+        for ( ; ISDIGIT(PEEK(c, p)); p++) {
+            if (digits < 19) {
+                w = w * 10 + (PEEK(c, p) - '0');
+                digits++;
+            }
+            else {
+                exp10++;
+                truncated |= PEEK(c, p) != '0';
+            }
+        }
+    }
+    // 接下来看有没有小数点
+    if (PEEK(c, p) == '.') {
+        p++;
+        // 有的话 小数点后面的连续的数字都是合法的
+        if (!ISDIGIT(PEEK(c, p))) {
+            return LEPT_PARSE_INVALID_VALUE;
+        }
+        for ( ; ISDIGIT(PEEK(c, p)); p++) {
+            if (digits < 19) {
+                /* 整数部分为0时 小数点后的前导0不算有效数字*/
+                if (digits > 0 || PEEK(c, p) != '0') {
+                    w = w * 10 + (PEEK(c, p) - '0');
+                    digits++;
+                }
+                exp10--;
+            }
+            else {
+                truncated |= PEEK(c, p) != '0';
+            }
+        }
+    }
+    // 接下来看有没有科学计数法标志
+    if (PEEK(c, p) == 'E' || PEEK(c, p) == 'e') {
+        int64_t e = 0;
+        int eneg = 0;
+        p++;
+        // 后面可以跟+ -号
+        if (PEEK(c, p) == '+' || PEEK(c, p) == '-') {
+            eneg = *p++ == '-';
+        }
+        // 然后就是数字
+        if (!ISDIGIT(PEEK(c, p))) {
+            return LEPT_PARSE_INVALID_VALUE;
+        }
+        // 所有的数字都是合法的 指数太大时结果只能是0或者无穷 不必再累加
+        for ( ; ISDIGIT(PEEK(c, p)); p++) {
+            if (e < 100000) {
+                e = e * 10 + (PEEK(c, p) - '0');
+            }
+        }
+        exp10 += eneg ? -e : e;
+    }
+    // 到这个位置的时候 p指向的就是非数字字符了
+    *n = lept_decimal_to_double(neg, w, exp10, truncated, c->json, p);
+    if (*n == HUGE_VAL || *n == -HUGE_VAL) {
+        return LEPT_PARSE_NUMBER_TOO_BIG;
+    }
+    // 数字没有问题
+    c->json = p;
+    return LEPT_PARSE_OK;
+}
+
+/* 解析数字 出错时也计入数字阶段的时间*/
+static int lept_parse_number(lept_context* c) {
+    double n;
+    int ret;
+    LEPT_PHASE_BEGIN(c);
+    ret = lept_scan_number(c, &n);
+    LEPT_PHASE_END(c, LEPT_PHASE_NUMBER);
+    if (ret == LEPT_PARSE_OK) {
+        EMIT(c, on_number, (c->ctx, n));
+    }
+    return ret;
+}
+
+/*
+    解析4位十六进制数为码点
+*/
+static const char* lept_parse_hex4(const lept_context* c, const char* p, unsigned* u) {
+    // 这个函数读取四个16进制的数字
+    int i;
+    *u = 0;
+    for( i = 0; i < 4; i++) {
+        char ch = PEEK(c, p);
+        p++;
+        *u <<= 4;
+        // 这时候*u的低四位为0 使用或运算直接将ch复制到*u的低四位
+        if (ch >= '0' && ch <= '9') *u |= ch - '0';
+        else if (ch >= 'A' && ch <= 'F') *u |= ch - ('A' - 10);
+        else if (ch >= 'a' && ch <= 'f') *u |= ch - ('a' - 10);
+        else return NULL;
+    }
+    return p;
+}
+
+/*
+    将解析的码点编码成UTF-8 只有高代理项没有低代理项 或者低代理项不合理的均返回LEPT_PARSE_INVALID_UNICODE_SURROGATE错误
+    \u后面不是四位十六进制数字返回LEPT_PARSE_INVALID_UNICODE_HEX错误
+    根据UTF-8码表
+*/
+static size_t lept_encode_utf8(char* buf, unsigned u) {
+    if (u <= 0x7f) {
+        // 码点范围是U+0000~U+007F
+        buf[0] = (char)(u & 0xff);
+        return 1;
+    }
+    else if (u <= 0x7ff) {
+        // 码点范围是U+0080~U+07FF 共11位
+        buf[0] = (char)(0xc0 | ((u >> 6) & 0xff));// 取高5位
+        buf[1] = (char)(0x80 | (u      & 0x3f));// 取低6位
+        return 2;
+    }
+    else if (u <= 0xffff) {
+        // 码点范围是U+0800~U+FFFF 共16位
+        buf[0] = (char)(0xe0 | ((u >> 12) & 0xff));// 取高4位
+        buf[1] = (char)(0x80 | ((u >> 6)  & 0x3f));// 取中6位
+        buf[2] = (char)(0x80 | (u         & 0x3f));// 取后6位
+        return 3;
+    }
+    else {
+        assert(u <= 0x10ffff);
+        // 码点范围是U+10000~U+10FFFF 共21位
+        buf[0] = (char)(0xf0 | ((u >> 18) & 0xff));// 取高三位
+        buf[1] = (char)(0x80 | ((u >> 12) & 0x3f));// 取随后6位
+        buf[2] = (char)(0x80 | ((u >> 6)  & 0x3f));// 取随后6位
+        buf[3] = (char)(0x80 | (u         & 0x3f));// 取最后6位
+        return 4;
+    }
+}
+
+/*
+    这个宏用来统一下一个函数中关于字符串的返回
+*/
+#define STRING_ERROR(ret) do { c->top = head; return ret; } while(0)
+
+/*
+    输出解析出的字符 原地模式写回输入缓冲区 否则压栈
+    原地模式下输出永远不会超过已经读过的输入 所以不会覆盖还没读的内容
+*/
+#define STRING_OUT(c, w, s, n) \
+    do {\
+        if (w) {\
+            memmove(w, s, n);\
+            w += (n);\
+        }\
+        else {\
+            memcpy(lept_context_push(c, n), s, n);\
+        }\
+    } while(0)
+
+/*
+    解析字符串 结果通过str和len返回 都以'\0'结尾
+    普通模式下结果位于栈上(已经弹出 在下一次压栈前有效)
+    原地模式下结果位于输入缓冲区内
+*/
+static int lept_scan_string(lept_context* c, const char** str, size_t* len) {
+    size_t head = c->top, n;
+    // u, u2是存储解析的unicode码
+    unsigned u, u2;
+    const char* p;
+    char* w = NULL; /* 原地模式下的写入位置*/
+    char buf[4];
     EXPECT(c, '\"');
     p = c->json;
+    if (c->insitu) {
+        w = (char*)p;
+    }
     for( ; ; ) {
-        char ch = *p++;
+        /* 一次找到下一个需要特殊处理的字符 中间的普通字符整段输出*/
+        const char* q = c->kernels->scan_string(p, c->end);
+        char ch;
+        if (q != p) {
+            /* 没有遇到过转义时 原地模式不需要移动*/
+            if (w == p) {
+                w = (char*)q;
+            }
+            else {
+                STRING_OUT(c, w, p, (size_t)(q - p));
+            }
+            p = q;
+        }
+        if (p == c->end) {
+            STRING_ERROR(LEPT_PARSE_MISS_QUOTATION_MARK);
+        }
+        ch = *p++;
         switch(ch) {
             case '\"':  /* 遇到第二个双引号*/
-                len = c->top - head; /* 检查字符串长度*/
-                lept_set_string(v, (const char*)lept_context_pop(c, len), len);
+                if (w) {
+                    *str = c->json;
+                    *len = w - c->json;
+                    *w = '\0';
+                }
+                else {
+                    PUTC(c, '\0');
+                    *len = c->top - head - 1; /* 检查字符串长度*/
+                    *str = (const char*)lept_context_pop(c, *len + 1);
+                }
                 c->json = p;
+                LEPT_STAT_ADD(c, string_bytes, *len);
                 return LEPT_PARSE_OK;
             case '\\':
-                switch(*p++) {
-                    case '\"': PUTC(c, '\"'); break;
-                    case '\\': PUTC(c, '\\'); break;
-                    case '/':  PUTC(c, '/' ); break;
-                    case 'b':  PUTC(c, '\b'); break;
-                    case 'f':  PUTC(c, '\f'); break;
-                    case 'n':  PUTC(c, '\n'); break;
-                    case 'r':  PUTC(c, '\r'); break;
-                    case 't':  PUTC(c, '\t'); break;
+                LEPT_STAT_ADD(c, escapes, 1);
+                n = 1;
+                ch = PEEK(c, p);
+                p++;
+                switch(ch) {
+                    case '\"': buf[0] = '\"'; break;
+                    case '\\': buf[0] = '\\'; break;
+                    case '/':  buf[0] = '/' ; break;
+                    case 'b':  buf[0] = '\b'; break;
+                    case 'f':  buf[0] = '\f'; break;
+                    case 'n':  buf[0] = '\n'; break;
+                    case 'r':  buf[0] = '\r'; break;
+                    case 't':  buf[0] = '\t'; break;
                     case 'u': 
-                        if (!(p=lept_parse_hex4(p, &u))) {
+                        LEPT_STAT_ADD(c, unicode_escapes, 1);
+                        if (!(p=lept_parse_hex4(c, p, &u))) {
                             STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_HEX);
                         }
                         // 第一个码点在0xd800~0xdbff之间表示高代理项
                         // 说明后面会跟随一个0xdc00~0xdfff的低代理项
                         if (u >= 0xd800 && u <= 0xdbff) {
-                            if (*p++ != '\\') {
-                                STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_SURROGATE);
-                            }
-                            if (*p++ != 'u') {
+                            if (PEEK(c, p) != '\\' || PEEK(c, p + 1) != 'u') {
                                 STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_SURROGATE);
                             }
-                            if (!(p = lept_parse_hex4(p, &u2))) {
+                            if (!(p = lept_parse_hex4(c, p + 2, &u2))) {
                                 STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_HEX);
                             }
                             if (u2 < 0xdc00 || u2 > 0xdfff) {
                                 STRING_ERROR(LEPT_PARSE_INVALID_UNICODE_SURROGATE);
                             }
                             u = 0x10000 + (((u - 0xd800) << 10) | (u2 - 0xdc00));
+                            LEPT_STAT_ADD(c, escapes, 1);
+                            LEPT_STAT_ADD(c, unicode_escapes, 1);
+                            LEPT_STAT_ADD(c, surrogates, 1);
                         }
-                        lept_encode_utf8(c, u);
+                        n = lept_encode_utf8(buf, u);
                         break;
                     default:
                         STRING_ERROR(LEPT_PARSE_INVALID_STRING_ESCAPE);
                 }
+                STRING_OUT(c, w, buf, n);
+                break;
+            default:
+                /* scan_string只会停在控制字符上 包括输入中间的'\0'*/
+                assert((unsigned char)ch < 0x20);
+                STRING_ERROR(LEPT_PARSE_INVALID_STRING_CHAR);
+        }
+    }
+}
+
+/* 出错时也计入字符串阶段的时间*/
+static int lept_parse_string_raw(lept_context* c, const char** str, size_t* len) {
+    int ret;
+    LEPT_PHASE_BEGIN(c);
+    ret = lept_scan_string(c, str, len);
+    LEPT_PHASE_END(c, LEPT_PHASE_STRING);
+    return ret;
+}
+
+/*
+    解析字符串值
+*/
+static int lept_parse_string(lept_context* c) {
+    int ret;
+    const char* s;
+    size_t len;
+    if ((ret = lept_parse_string_raw(c, &s, &len)) == LEPT_PARSE_OK) {
+        EMIT(c, on_string, (c->ctx, s, len));
+    }
+    return ret;
+}
+
+/*
+    解析标量 数组和对象由lept_parse_value()处理
+*/
+static int lept_parse_scalar(lept_context* c) {
+    switch (PEEK(c, c->json)) {
+        case 't':  return lept_parse_literal(c, "true", LEPT_TRUE);
+        case 'f':  return lept_parse_literal(c, "false", LEPT_FALSE);
+        case 'n':  return lept_parse_literal(c, "null", LEPT_NULL);
+        default:   return lept_parse_number(c);
+        case '"':  return lept_parse_string(c);
+        case '\0': return c->json == c->end ? LEPT_PARSE_EXPECT_VALUE : LEPT_PARSE_INVALID_VALUE;
+    }
+}
+
+/*
+    还没有结束的数组和对象 每层一个记录: 已经解析的元素个数左移一位 最低位为1时是对象
+    开始时用local 更深时换到堆上 由lept_parse_value()释放
+*/
+#define LEPT_FRAME_OBJECT 1u
+
+typedef struct {
+    size_t* p;
+    size_t depth, capacity;
+    size_t local[LEPT_PARSE_FRAMES_LOCAL];
+} lept_frames;
+
+static int lept_frames_push(lept_context* c, lept_frames* f, size_t frame) {
+    if (f->depth == c->max_depth) {
+        return LEPT_PARSE_DEPTH_EXCEEDED;
+    }
+    if (f->depth == f->capacity) {
+        size_t* p = (size_t*)LEPT_ALLOC_WITH(c->allocator, f->capacity * 2 * sizeof(size_t));
+        memcpy(p, f->p, f->depth * sizeof(size_t));
+        if (f->p != f->local) {
+            LEPT_FREE_WITH(c->allocator, f->p);
+        }
+        f->p = p;
+        f->capacity *= 2;
+    }
+    f->p[f->depth++] = frame;
+    return LEPT_PARSE_OK;
+}
+
+/*
+    解析对象成员的键和冒号 之后c->json位于值上
+*/
+static int lept_parse_member_key(lept_context* c) {
+    const char* key;
+    size_t klen;
+    int ret;
+    if (PEEK(c, c->json) != '"') {
+        return LEPT_PARSE_MISS_KEY;
+    }
+    if ((ret = lept_parse_string_raw(c, &key, &klen)) != LEPT_PARSE_OK) {
+        return ret;
+    }
+    EMIT(c, on_key, (c->ctx, key, klen));
+    lept_parse_whitespace(c);
+    if (PEEK(c, c->json) != ':') {
+        return LEPT_PARSE_MISS_COLON;
+    }
+    c->json++;
+    lept_parse_whitespace(c);
+    return LEPT_PARSE_OK;
+}
+
+/*
+    解析一个值 数组和对象不递归 打开的容器记录在f中
+    每次循环先解析一个值(或者打开一个容器) 然后关闭所有随之结束的容器
+*/
+static int lept_parse_nested(lept_context* c, lept_frames* f) {
+    size_t frame;
+    int ret;
+    for ( ; ; ) {
+        if (PEEK(c, c->json) == '[' || PEEK(c, c->json) == '{') {
+            int object = *c->json++ == '{';
+            if ((ret = lept_frames_push(c, f, object ? LEPT_FRAME_OBJECT : 0)) != LEPT_PARSE_OK) {
+                return ret;
+            }
+            LEPT_STAT_ENTER(c);
+            if (object) {
+                EMIT(c, on_start_object, (c->ctx));
+            }
+            else {
+                EMIT(c, on_start_array, (c->ctx));
+            }
+            lept_parse_whitespace(c);
+            if (PEEK(c, c->json) != (object ? '}' : ']')) {
+                if (object && (ret = lept_parse_member_key(c)) != LEPT_PARSE_OK) {
+                    return ret;
+                }
+                continue;
+            }
+            /* 空的容器 先减去下面计入的一个元素 然后直接关闭*/
+            f->p[f->depth - 1] -= 2;
+        }
+        else if ((ret = lept_parse_scalar(c)) != LEPT_PARSE_OK) {
+            return ret;
+        }
+        /* 一个值完成 计入所在的容器 容器结束时它本身又是一个完成的值*/
+        for ( ; ; ) {
+            if (f->depth == 0) {
+                return LEPT_PARSE_OK;
+            }
+            frame = f->p[f->depth - 1] += 2;
+            lept_parse_whitespace(c);
+            if (PEEK(c, c->json) == ',') {
+                c->json++;
+                lept_parse_whitespace(c);
+                if ((frame & LEPT_FRAME_OBJECT) && (ret = lept_parse_member_key(c)) != LEPT_PARSE_OK) {
+                    return ret;
+                }
+                break;
+            }
+            if (PEEK(c, c->json) != (frame & LEPT_FRAME_OBJECT ? '}' : ']')) {
+                return frame & LEPT_FRAME_OBJECT ? LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET : LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            }
+            c->json++;
+            f->depth--;
+            LEPT_STAT_LEAVE(c);
+            if (frame & LEPT_FRAME_OBJECT) {
+                EMIT(c, on_end_object, (c->ctx, frame >> 1));
+            }
+            else {
+                EMIT(c, on_end_array, (c->ctx, frame >> 1));
+            }
+        }
+    }
+}
+
+/*
+    解析一个值 C栈的用量与嵌套深度无关
+*/
+static int lept_parse_value(lept_context* c) {
+    lept_frames f;
+    int ret;
+    if (PEEK(c, c->json) != '[' && PEEK(c, c->json) != '{') {
+        return lept_parse_scalar(c);
+    }
+    f.p = f.local;
+    f.depth = 0;
+    f.capacity = LEPT_PARSE_FRAMES_LOCAL;
+    ret = lept_parse_nested(c, &f);
+    if (f.p != f.local) {
+        LEPT_FREE_WITH(c->allocator, f.p);
+    }
+    return ret;
+}
+
+/*
+    解析整个文本 事件交给c->handler 根值之后只允许有空白
+    栈由调用者初始化和释放 可以在多次解析之间复用
+*/
+static int lept_parse_document(lept_context* c, const char* json, size_t len) {
+    int ret;
+    c->json = json;
+    c->end = json + len;
+    c->top = 0;
+    c->kernels = lept_select_kernels();
+    c->fixed = 0;
+    lept_parse_whitespace(c);
+    if ((ret = lept_parse_value(c)) == LEPT_PARSE_OK) {
+        lept_parse_whitespace(c);
+        if (c->json != c->end) {
+            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+        }
+    }
+    return ret;
+}
+
+/* 按64字节一块分类之后 越过容器时用到的位运算*/
+static unsigned lept_popcount64(uint64_t x) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_popcountll(x);
+#else
+    unsigned n = 0;
+    for ( ; x; x &= x - 1) {
+        n++;
+    }
+    return n;
+#endif
+}
+
+static unsigned lept_ctz64(uint64_t x) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+/* 第i位是x的第0~i位的异或 从引号得到字符串内部的掩码*/
+static uint64_t lept_prefix_xor(uint64_t x) {
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+/*
+    被转义的字符 连续的'\\'中奇数位置上的'\\'转义下一个字符
+    *prev_escaped是上一块最后一个字符转义了这一块第一个字符
+*/
+static uint64_t lept_find_escaped(uint64_t backslash, uint64_t* prev_escaped) {
+    const uint64_t even_bits = 0x5555555555555555ull;
+    uint64_t follows_escape, odd_starts, sequences_on_even, invert;
+    backslash &= ~*prev_escaped;
+    follows_escape = backslash << 1 | *prev_escaped;
+    odd_starts = backslash & ~even_bits & ~follows_escape;
+    sequences_on_even = odd_starts + backslash;
+    *prev_escaped = sequences_on_even < backslash; /* 加法的进位*/
+    invert = sequences_on_even << 1;
+    return (even_bits ^ invert) & follows_escape;
+}
+
+/*
+    键的散列值 每次处理8个字节
+*/
+static uint64_t lept_hash_bytes(const char* s, size_t len) {
+    uint64_t h = 0x9e3779b97f4a7c15u ^ (uint64_t)len, k;
+    for ( ; len >= 8; s += 8, len -= 8) {
+        memcpy(&k, s, 8);
+        h = (h ^ k) * 0xff51afd7ed558ccdu;
+        h ^= h >> 32;
+    }
+    k = 0;
+    if (len) {
+        memcpy(&k, s, len);
+    }
+    h = (h ^ k) * 0xc4ceb9fe1a85ec53u;
+    h ^= h >> 29;
+    return h;
+}
+
+/* 共享字符串表的初始槽位数 2的幂*/
+#ifndef LEPT_INTERN_INIT_SLOTS
+    #define LEPT_INTERN_INIT_SLOTS 64
+#endif
+
+/* 使用LEPT_PARSE_INTERN_STRINGS时 放入共享字符串表的字符串值的最大长度 更短的字符串直接存放在值中*/
+#ifndef LEPT_INTERN_STRING_MAX
+    #define LEPT_INTERN_STRING_MAX 64
+#endif
+
+/* 共享字符串表中每个字符串之前的头 字符串紧跟在头之后 以'\0'结尾*/
+typedef struct {
+    uint64_t hash;
+    size_t len;
+} lept_intern_entry;
+
+struct lept_intern {
+    lept_intern_entry** slots; /* 开放寻址 NULL表示空槽*/
+    size_t count, mask;
+    lept_arena arena; /* 字符串只增不减 直到lept_intern_free()才归还*/
+};
+
+#define LEPT_INTERN_ENTRY(s) ((const lept_intern_entry*)(s) - 1)
+
+/* 成员键的散列值 共享表中的键不需要重新计算*/
+#define LEPT_MEMBER_HASH(m) ((m)->val.flags & LEPT_FLAG_KEY_INTERNED ? LEPT_INTERN_ENTRY((m)->key)->hash : lept_hash_bytes(LEPT_MEMBER_KEY(m), LEPT_MEMBER_KLEN(m)))
+
+lept_intern* lept_intern_new(void) {
+    lept_intern* t = (lept_intern*)LEPT_MALLOC(sizeof(lept_intern));
+    t->count = 0;
+    t->mask = LEPT_INTERN_INIT_SLOTS - 1;
+    t->slots = (lept_intern_entry**)LEPT_MALLOC(LEPT_INTERN_INIT_SLOTS * sizeof(lept_intern_entry*));
+    memset(t->slots, 0, LEPT_INTERN_INIT_SLOTS * sizeof(lept_intern_entry*));
+    lept_arena_init(&t->arena, 0);
+    return t;
+}
+
+void lept_intern_free(lept_intern* t) {
+    if (t) {
+        LEPT_FREE(t->slots);
+        lept_arena_destroy(&t->arena);
+        LEPT_FREE(t);
+    }
+}
+
+/* 槽位数翻倍 保持装载率不超过一半*/
+static void lept_intern_grow(lept_intern* t) {
+    size_t i, j, mask = t->mask * 2 + 1;
+    lept_intern_entry** slots = (lept_intern_entry**)LEPT_MALLOC((mask + 1) * sizeof(lept_intern_entry*));
+    memset(slots, 0, (mask + 1) * sizeof(lept_intern_entry*));
+    for (i = 0; i <= t->mask; i++) {
+        if (t->slots[i]) {
+            for (j = (size_t)t->slots[i]->hash & mask; slots[j] != NULL; j = (j + 1) & mask)
+                ;
+            slots[j] = t->slots[i];
+        }
+    }
+    LEPT_FREE(t->slots);
+    t->slots = slots;
+    t->mask = mask;
+}
+
+/*
+    查找字符串 不存在时复制一份加入表中 同样的内容总是得到同一个指针
+*/
+const char* lept_intern_string(lept_intern* t, const char* s, size_t len) {
+    uint64_t h;
+    size_t i;
+    lept_intern_entry* e;
+    assert(t != NULL && (s != NULL || len == 0));
+    h = lept_hash_bytes(s, len);
+    for (i = (size_t)h & t->mask; (e = t->slots[i]) != NULL; i = (i + 1) & t->mask) {
+        if (e->hash == h && e->len == len && memcmp(e + 1, s, len) == 0) {
+            return (const char*)(e + 1);
+        }
+    }
+    e = (lept_intern_entry*)lept_arena_alloc(&t->arena, sizeof(lept_intern_entry) + len + 1);
+    e->hash = h;
+    e->len = len;
+    if (len) {
+        memcpy(e + 1, s, len);
+    }
+    ((char*)(e + 1))[len] = '\0';
+    t->slots[i] = e;
+    if (++t->count * 2 > t->mask) {
+        lept_intern_grow(t);
+    }
+    return (const char*)(e + 1);
+}
+
+/*
+    索引的槽位数 为成员数2倍以上的2的幂 成员较少的对象没有索引
+    索引紧跟在成员数组之后 与成员数组一起申请和释放
+    每个槽位存放成员下标+1 0表示空槽
+*/
+static size_t lept_object_index_slots(size_t size) {
+    size_t n = 1;
+    if (size < LEPT_OBJECT_INDEX_MIN || size >= 0x7fffffffu) {
+        return 0;
+    }
+    while (n < size * 2) {
+        n <<= 1;
+    }
+    return n;
+}
+
+/* 索引紧跟在capacity个成员之后 解析出的对象capacity等于size*/
+#define LEPT_OBJECT_INDEX(m, capacity) ((uint32_t*)((m) + (capacity)))
+
+/* 把第i个成员加入索引 已经有相同的键时保留前面的*/
+static void lept_object_index_add(lept_member* m, size_t capacity, size_t i) {
+    size_t mask = lept_object_index_slots(capacity) - 1;
+    uint32_t* index = LEPT_OBJECT_INDEX(m, capacity);
+    size_t j = (size_t)LEPT_MEMBER_HASH(&m[i]) & mask;
+    for ( ; index[j] != 0; j = (j + 1) & mask) {
+        const lept_member* o = &m[index[j] - 1];
+        if (LEPT_MEMBER_KLEN(o) == LEPT_MEMBER_KLEN(&m[i]) && memcmp(LEPT_MEMBER_KEY(o), LEPT_MEMBER_KEY(&m[i]), LEPT_MEMBER_KLEN(o)) == 0) {
+            return;
+        }
+    }
+    index[j] = (uint32_t)(i + 1);
+}
+
+/* 建立索引 重复的键只索引第一个 与线性查找的结果一致*/
+static void lept_object_build_index(lept_member* m, size_t size, size_t capacity) {
+    size_t i;
+    memset(LEPT_OBJECT_INDEX(m, capacity), 0, lept_object_index_slots(capacity) * sizeof(uint32_t));
+    for (i = 0; i < size; i++) {
+        lept_object_index_add(m, capacity, i);
+    }
+}
+
+/*
+    DOM建立器: 作为处理函数接收事件 ctx就是lept_context
+    结点按顺序压在栈上 数组和对象结束时弹出子结点组成新结点
+    事件中的字符串位于栈顶之外 必须先复制再压栈
+*/
+static int lept_build_push(lept_context* c, const lept_value* e) {
+    LEPT_STAT_ADD(c, nodes[e->type], 1);
+    memcpy(lept_context_push(c, sizeof(lept_value)), e, sizeof(lept_value));
+    return 0;
+}
+
+static int lept_build_null(void* ctx) {
+    lept_value e;
+    lept_init(&e);
+    return lept_build_push((lept_context*)ctx, &e);
+}
+
+static int lept_build_bool(void* ctx, int b) {
+    lept_value e;
+    lept_init(&e);
+    e.type = b ? LEPT_TRUE : LEPT_FALSE;
+    return lept_build_push((lept_context*)ctx, &e);
+}
+
+static int lept_build_number(void* ctx, double n) {
+    lept_value e;
+    lept_init(&e);
+    e.u.n = n;
+    e.type = LEPT_NUMBER;
+    return lept_build_push((lept_context*)ctx, &e);
+}
+
+/* 原地模式下直接引用输入缓冲区*/
+static int lept_build_string(void* ctx, const char* s, size_t len) {
+    lept_context* c = (lept_context*)ctx;
+    lept_value e;
+    if (c->intern && c->intern_strings && len > LEPT_INLINE_MAX && len <= LEPT_INTERN_STRING_MAX) {
+        e.u.s.s = (char*)lept_intern_string(c->intern, s, len);
+        e.u.s.len = len;
+        e.type = LEPT_STRING;
+        e.flags = LEPT_FLAG_BORROWED;
+    }
+    else if (c->insitu) {
+        e.u.s.s = (char*)s;
+        e.u.s.len = len;
+        e.type = LEPT_STRING;
+        e.flags = LEPT_FLAG_BORROWED;
+    }
+    else {
+        lept_context_set_string(c, &e, s, len);
+    }
+    return lept_build_push(c, &e);
+}
+
+/* 键压栈时和字符串值一样 有共享字符串表时总是从表中取得 在对象结束时转为键*/
+static int lept_build_key(void* ctx, const char* key, size_t klen) {
+    lept_context* c = (lept_context*)ctx;
+    lept_value e;
+    /* 键在对象结束时从字符串结点中扣除*/
+    LEPT_STAT_ADD(c, keys, 1);
+    if (c->intern == NULL) {
+        return lept_build_string(ctx, key, klen);
+    }
+    e.u.s.s = (char*)lept_intern_string(c->intern, key, klen);
+    e.u.s.len = klen;
+    e.type = LEPT_STRING;
+    e.flags = LEPT_FLAG_BORROWED | LEPT_FLAG_KEY_INTERNED;
+    return lept_build_push(c, &e);
+}
+
+static int lept_build_end_array(void* ctx, size_t size) {
+    lept_context* c = (lept_context*)ctx;
+    lept_value e;
+    e.type = LEPT_ARRAY;
+    e.flags = c->arena ? LEPT_FLAG_BORROWED : c->insitu ? LEPT_FLAG_BORROWED_CHILDREN : 0;
+    e.u.a.size = size;
+    e.u.a.e = NULL;
+    if (size) {
+        e.u.a.e = (lept_value*)lept_context_alloc(c, size * sizeof(lept_value));
+        memcpy(e.u.a.e, lept_context_pop(c, size * sizeof(lept_value)), size * sizeof(lept_value));
+        if (!c->arena) {
+            LEPT_SHARED(e.u.a.e)->capacity = size;
+        }
+    }
+    return lept_build_push(c, &e);
+}
+
+/* 栈上是键 值 键 值...交替排列的2*size个结点*/
+static int lept_build_end_object(void* ctx, size_t size) {
+    lept_context* c = (lept_context*)ctx;
+    lept_value e;
+    const lept_value* kv;
+    size_t i;
+    e.type = LEPT_OBJECT;
+    e.flags = c->arena ? LEPT_FLAG_BORROWED : c->insitu ? LEPT_FLAG_BORROWED_CHILDREN : 0;
+    e.u.o.size = size;
+    LEPT_STAT_ADD(c, nodes[LEPT_STRING], 0 - size);
+    e.u.o.m = NULL;
+    if (size) {
+        /* 成员数组之后是索引(如果有)*/
+        e.u.o.m = (lept_member*)lept_context_alloc(c, size * sizeof(lept_member) + lept_object_index_slots(size) * sizeof(uint32_t));
+        if (!c->arena) {
+            LEPT_SHARED(e.u.o.m)->capacity = size;
+        }
+        kv = (const lept_value*)lept_context_pop(c, 2 * size * sizeof(lept_value));
+        for (i = 0; i < size; i++, kv += 2) {
+            lept_member* m = &e.u.o.m[i];
+            m->val = kv[1];
+            if (kv[0].flags & LEPT_FLAG_INLINE) {
+                /* 短键的内容连同'\0'搬到key和klen的位置上*/
+                memcpy(&m->key, &kv[0].u.s, LEPT_STRING_LEN(&kv[0]) + 1);
+                m->val.flags |= LEPT_FLAG_KEY_INLINE | (unsigned)LEPT_STRING_LEN(&kv[0]) << 24;
+            }
+            else {
+                m->key = kv[0].u.s.s;
+                m->klen = kv[0].u.s.len;
+                if (kv[0].flags & LEPT_FLAG_BORROWED) {
+                    m->val.flags |= LEPT_FLAG_KEY_BORROWED | (kv[0].flags & LEPT_FLAG_KEY_INTERNED);
+                }
+            }
+        }
+        if (lept_object_index_slots(size)) {
+            lept_object_build_index(e.u.o.m, size, size);
+        }
+    }
+    return lept_build_push(c, &e);
+}
+
+static const lept_handler lept_build_handler = {
+    lept_build_null, lept_build_bool, lept_build_number, lept_build_string,
+    NULL, lept_build_end_array, NULL, lept_build_key, lept_build_end_object
+};
+
+/*
+    解析并建立DOM 出错时释放栈上已经建立的结点 栈留给下一次解析
+*/
+static int lept_parse_dom(lept_context* c, lept_value* v, const char* json, size_t len) {
+    int ret;
+    assert(v != NULL && (json != NULL || len == 0));
+    c->handler = &lept_build_handler;
+    c->ctx = c;
+    lept_init(v);
+    ret = lept_parse_document(c, json, len);
+    if (ret == LEPT_PARSE_OK) {
+        assert(c->top == sizeof(lept_value));
+        memcpy(v, lept_context_pop(c, sizeof(lept_value)), sizeof(lept_value));
+    }
+    while (c->top > 0) {
+        lept_free((lept_value*)lept_context_pop(c, sizeof(lept_value)));
+    }
+    return ret;
+}
+
+/*
+    一次性解析 栈只用于这一次
+*/
+static int lept_parse_root(lept_context* c, lept_value* v, const char* json, size_t len) {
+    int ret;
+    c->stack = NULL;
+    c->size = 0;
+    ret = lept_parse_dom(c, v, json, len);
+    LEPT_FREE_WITH(c->allocator, c->stack);
+    return ret;
+}
+
+/*
+    事件驱动的解析 不建立DOM
+*/
+int lept_parse_sax(const char* json, size_t len, const lept_handler* h, void* ctx) {
+    lept_context c;
+    int ret;
+    assert(h != NULL && (json != NULL || len == 0));
+    c.arena = NULL;
+    c.insitu = 0;
+    c.intern = NULL;
+    c.stats = NULL;
+    c.allocator = &lept_allocator_global;
+    c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    c.handler = h;
+    c.ctx = ctx;
+    c.stack = NULL;
+    c.size = 0;
+    ret = lept_parse_document(&c, json, len);
+    LEPT_FREE_WITH(c.allocator, c.stack);
+    return ret;
+}
+
+/*
+    按需解析：先用不建立任何结点的事件解析验证整个文本 然后根值只是一个指向文本的句柄
+    句柄的u.s.s和u.s.len记录值在文本中的位置和长度 第一次访问时展开一层:
+    字符串和数字被转换 数组和对象的子结点又是句柄 没有访问的子树只用括号匹配越过
+*/
+static const lept_handler lept_validate_handler = {
+    NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+/*
+    越过值的函数只匹配引号和括号 不检查其他语法 没有结束时返回NULL
+    按需解析时文本已经验证过 不会返回NULL
+*/
+
+/* p是字符串的起始引号 返回结束引号之后的位置*/
+static const char* lept_skip_string(const lept_context* c, const char* p) {
+    for (p++; ; p++) {
+        p = c->kernels->scan_string(p, c->end);
+        if (p == c->end) {
+            return NULL;
+        }
+        if (*p == '\"') {
+            return p + 1;
+        }
+        if (*p == '\\' && ++p == c->end) {
+            return NULL;
+        }
+    }
+}
+
+/* 数字和字面量在空白、','或结束括号处结束*/
+static const char* lept_skip_scalar(const lept_context* c, const char* p) {
+    do {
+        p++;
+    } while (p < c->end && !ISWHITESPACE(*p) && *p != ',' && *p != ']' && *p != '}');
+    return p;
+}
+
+/*
+    p是数组或对象的起始括号 返回匹配的结束括号之后的位置
+    每次对64字节分类 块中的结束括号不足以回到外层时整块越过 不必逐个处理
+*/
+static const char* lept_skip_container(const lept_context* c, const char* p) {
+    uint64_t prev_escaped = 0, prev_in_string = 0;
+    size_t depth = 0;
+    char tail[64];
+    lept_block b;
+    for ( ; p < c->end; p += 64) {
+        uint64_t quote, in_string, open, close, bits;
+        if (c->end - p >= 64) {
+            c->kernels->classify(p, &b);
+        }
+        else {
+            memset(tail, ' ', sizeof(tail));
+            memcpy(tail, p, (size_t)(c->end - p));
+            c->kernels->classify(tail, &b);
+        }
+        quote = b.quote & ~lept_find_escaped(b.backslash, &prev_escaped);
+        in_string = lept_prefix_xor(quote) ^ prev_in_string;
+        prev_in_string = (uint64_t)0 - (in_string >> 63);
+        open = b.open & ~in_string;
+        close = b.close & ~in_string;
+        if (depth > lept_popcount64(close)) {
+            depth += lept_popcount64(open);
+            depth -= lept_popcount64(close);
+            continue;
+        }
+        for (bits = open | close; bits; bits &= bits - 1) {
+            if (open & bits & (0 - bits)) {
+                depth++;
+            }
+            else if (--depth == 0) {
+                return p + lept_ctz64(bits) + 1;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* c->json处的值压栈 字面量直接建立 其他的压入句柄并越过*/
+static void lept_lazy_push(lept_context* c) {
+    const char* p = c->json;
+    lept_value e;
+    switch (*p) {
+        case 'n':
+        case 't':
+        case 'f':
+            lept_parse_value(c);
+            return;
+        case '\"':
+            e.type = LEPT_STRING;
+            c->json = lept_skip_string(c, p);
+            break;
+        case '[':
+            e.type = LEPT_ARRAY;
+            c->json = lept_skip_container(c, p);
+            break;
+        case '{':
+            e.type = LEPT_OBJECT;
+            c->json = lept_skip_container(c, p);
+            break;
+        default:
+            e.type = LEPT_NUMBER;
+            c->json = lept_skip_scalar(c, p);
+            break;
+    }
+    e.flags = LEPT_FLAG_LAZY;
+    e.u.s.s = (char*)p;
+    e.u.s.len = (size_t)(c->json - p);
+    lept_build_push(c, &e);
+}
+
+/*
+    展开一个句柄 v在逻辑上不变 所以可以从只读的访问函数中调用
+    栈先用局部缓冲区 不够时才申请内存
+*/
+static void lept_lazy_expand(lept_value* v) {
+    lept_context c;
+    lept_value buf[LEPT_PARSE_STACK_INIT_SIZE / sizeof(lept_value) + 1];
+    unsigned keep = v->flags & LEPT_FLAG_KEY_MASK;
+    size_t size = 0;
+    c.json = v->u.s.s;
+    c.end = c.json + v->u.s.len;
+    c.stack = (char*)buf;
+    c.size = sizeof(buf);
+    c.top = 0;
+    c.fixed = 1;
+    c.arena = NULL;
+    c.insitu = 0;
+    c.intern = NULL;
+    c.stats = NULL;
+    c.allocator = &lept_allocator_global;
+    c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    c.kernels = lept_select_kernels();
+    c.handler = &lept_build_handler;
+    c.ctx = &c;
+    switch (v->type) {
+        case LEPT_ARRAY:
+            c.json++;
+            lept_parse_whitespace(&c);
+            while (*c.json != ']') {
+                lept_lazy_push(&c);
+                size++;
+                lept_parse_whitespace(&c);
+                if (*c.json == ',') {
+                    c.json++;
+                    lept_parse_whitespace(&c);
+                }
+            }
+            lept_build_end_array(&c, size);
+            break;
+        case LEPT_OBJECT:
+            c.json++;
+            lept_parse_whitespace(&c);
+            while (*c.json != '}') {
+                /* 键总是转换 值压入句柄*/
+                lept_parse_string(&c);
+                lept_parse_whitespace(&c);
+                c.json++;
+                lept_parse_whitespace(&c);
+                lept_lazy_push(&c);
+                size++;
+                lept_parse_whitespace(&c);
+                if (*c.json == ',') {
+                    c.json++;
+                    lept_parse_whitespace(&c);
+                }
+            }
+            lept_build_end_object(&c, size);
+            break;
+        default:
+            lept_parse_value(&c);
+            break;
+    }
+    memcpy(v, lept_context_pop(&c, sizeof(lept_value)), sizeof(lept_value));
+    v->flags |= keep;
+    if (!c.fixed) {
+        LEPT_FREE_WITH(c.allocator, c.stack);
+    }
+}
+
+/* 访问句柄之前先展开*/
+#define LEPT_EXPAND(v) do { if ((v)->flags & LEPT_FLAG_LAZY) lept_lazy_expand((lept_value*)(v)); } while(0)
+
+/*
+    按需解析 文本验证通过后根值成为句柄
+*/
+static int lept_parse_lazy(lept_context* c, lept_value* v, const char* json, size_t len) {
+    int ret;
+    assert(v != NULL && (json != NULL || len == 0));
+    lept_init(v);
+    c->handler = &lept_validate_handler;
+    c->ctx = NULL;
+    if ((ret = lept_parse_document(c, json, len)) != LEPT_PARSE_OK) {
+        return ret;
+    }
+    c->json = json;
+    c->top = 0;
+    c->arena = NULL;
+    c->intern = NULL;
+    c->handler = &lept_build_handler;
+    c->ctx = c;
+    lept_parse_whitespace(c);
+    lept_lazy_push(c);
+    memcpy(v, lept_context_pop(c, sizeof(lept_value)), sizeof(lept_value));
+    return LEPT_PARSE_OK;
+}
+
+/*
+    投影解析：只为一组JSON Pointer匹配到的值建立结点
+    每个值带着当前仍然可能匹配的路径集合 集合为空的子树直接越过
+    有路径在某个值处结束时建立整个值 更深的路径在建立好的值中查找
+*/
+typedef struct {
+    const char* s; /* 已经去掉~0 ~1转义*/
+    size_t len;
+    size_t index; /* 作为数组下标的值 不是合法的下标时为(size_t)-1*/
+    int wildcard; /* "*" 匹配数组的所有元素*/
+} lept_pointer_token;
+
+typedef struct {
+    lept_pointer_token* tokens;
+    size_t n;
+} lept_pointer;
+
+struct lept_projection {
+    lept_pointer* paths;
+    size_t count;
+    char* buffer; /* 所有键的内容*/
+};
+
+/* 一个匹配结果 按文本中的顺序压栈*/
+typedef struct {
+    size_t id;
+    lept_value v;
+} lept_match;
+
+typedef struct {
+    lept_context* c; /* 建立的结点压在c的栈上*/
+    const lept_projection* p;
+    lept_context ids; /* 每一层的路径集合 size_t数组*/
+    lept_context matches;
+} lept_project;
+
+#define LEPT_PROJECT_ID(s, off, i) (((const size_t*)((s)->ids.stack + (off)))[i])
+
+/* "0"或者不以0开头的十进制数*/
+static size_t lept_pointer_index(const char* s, size_t len) {
+    size_t i, index = 0;
+    if (len == 0 || (s[0] == '0' && len > 1)) {
+        return (size_t)-1;
+    }
+    for (i = 0; i < len; i++) {
+        if (!ISDIGIT(s[i]) || index > ((size_t)-1 - 9) / 10) {
+            return (size_t)-1;
+        }
+        index = index * 10 + (size_t)(s[i] - '0');
+    }
+    return index;
+}
+
+/*
+    编译JSON Pointer 每条路径是""或者以'/'开头的若干个键 '~'之后只能是'0'或'1'
+*/
+lept_projection* lept_projection_compile(const char* const* paths, size_t count) {
+    lept_projection* p;
+    size_t i, ntokens = 0, size = 0;
+    char* w;
+    assert(paths != NULL || count == 0);
+    for (i = 0; i < count; i++) {
+        const char* s;
+        if (paths[i][0] != '\0' && paths[i][0] != '/') {
+            return NULL;
+        }
+        for (s = paths[i]; *s; s++) {
+            ntokens += *s == '/';
+            if (*s == '~' && s[1] != '0' && s[1] != '1') {
+                return NULL;
+            }
+        }
+        size += (size_t)(s - paths[i]);
+    }
+    p = (lept_projection*)LEPT_MALLOC(sizeof(lept_projection));
+    p->count = count;
+    p->paths = (lept_pointer*)LEPT_MALLOC(count * sizeof(lept_pointer) + ntokens * sizeof(lept_pointer_token) + 1);
+    p->buffer = w = (char*)LEPT_MALLOC(size + 1);
+    ntokens = 0;
+    for (i = 0; i < count; i++) {
+        const char* s = paths[i];
+        lept_pointer* path = &p->paths[i];
+        path->tokens = (lept_pointer_token*)(p->paths + count) + ntokens;
+        path->n = 0;
+        while (*s == '/') {
+            lept_pointer_token* token = &path->tokens[path->n++];
+            token->s = w;
+            for (s++; *s && *s != '/'; s++) {
+                if (*s == '~') {
+                    *w++ = *++s == '0' ? '~' : '/';
+                }
+                else {
+                    *w++ = *s;
+                }
+            }
+            token->len = (size_t)(w - token->s);
+            token->index = lept_pointer_index(token->s, token->len);
+            token->wildcard = token->len == 1 && token->s[0] == '*';
+        }
+        ntokens += path->n;
+    }
+    return p;
+}
+
+void lept_projection_free(lept_projection* p) {
+    if (p == NULL) {
+        return;
+    }
+    LEPT_FREE(p->paths);
+    LEPT_FREE(p->buffer);
+    LEPT_FREE(p);
+}
+
+/*
+    遍历值的记录 每个还没有结束的数组或对象一个: v是容器 i是下一个子结点的下标
+    w是同时遍历的另一个值(复制的目标或比较的另一方) n和h由使用者解释
+    开始时用local 更深时换到堆上 C栈的用量与嵌套深度无关
+*/
+typedef struct {
+    lept_value* v;
+    lept_value* w;
+    size_t i, n;
+    uint64_t h;
+} lept_walk_frame;
+
+typedef struct {
+    lept_walk_frame* p;
+    size_t depth, capacity;
+    lept_walk_frame local[LEPT_WALK_FRAMES_LOCAL];
+} lept_walk;
+
+#define LEPT_WALK_TOP(k) (&(k)->p[(k)->depth - 1])
+
+static void lept_walk_init(lept_walk* k) {
+    k->p = k->local;
+    k->depth = 0;
+    k->capacity = LEPT_WALK_FRAMES_LOCAL;
+}
+
+/* 返回的记录在下一次压栈之前有效*/
+static lept_walk_frame* lept_walk_push(lept_walk* k, const lept_value* v, const lept_value* w) {
+    lept_walk_frame* f;
+    if (k->depth == k->capacity) {
+        f = (lept_walk_frame*)LEPT_MALLOC(k->capacity * 2 * sizeof(lept_walk_frame));
+        memcpy(f, k->p, k->depth * sizeof(lept_walk_frame));
+        if (k->p != k->local) {
+            LEPT_FREE(k->p);
+        }
+        k->p = f;
+        k->capacity *= 2;
+    }
+    f = &k->p[k->depth++];
+    f->v = (lept_value*)v;
+    f->w = (lept_value*)w;
+    f->i = f->n = 0;
+    f->h = 0;
+    return f;
+}
+
+static void lept_walk_free(lept_walk* k) {
+    if (k->p != k->local) {
+        LEPT_FREE(k->p);
+    }
+}
+
+/*
+    复制一个结点 数组和对象只分配内存并复制键(建立索引需要键) 子结点由lept_value_copy()复制
+    key是dst作为成员时的键的标志 需要复制子结点时返回1
+*/
+static int lept_value_copy_node(lept_value* dst, const lept_value* src, unsigned key) {
+    size_t i;
+    LEPT_EXPAND(src);
+    switch (src->type) {
+        case LEPT_STRING:
+            dst->type = LEPT_NULL;
+            dst->flags = key;
+            lept_set_string(dst, LEPT_STRING_PTR(src), LEPT_STRING_LEN(src));
+            return 0;
+        case LEPT_ARRAY:
+            dst->type = LEPT_ARRAY;
+            dst->flags = key;
+            dst->u.a.size = src->u.a.size;
+            dst->u.a.e = NULL;
+            if (src->u.a.size == 0) {
+                return 0;
+            }
+            dst->u.a.e = (lept_value*)lept_shared_alloc(src->u.a.size * sizeof(lept_value));
+            LEPT_SHARED(dst->u.a.e)->capacity = src->u.a.size;
+            return 1;
+        case LEPT_OBJECT:
+            dst->type = LEPT_OBJECT;
+            dst->flags = key;
+            dst->u.o.size = src->u.o.size;
+            dst->u.o.m = NULL;
+            if (src->u.o.size == 0) {
+                return 0;
+            }
+            dst->u.o.m = (lept_member*)lept_shared_alloc(src->u.o.size * sizeof(lept_member) + lept_object_index_slots(src->u.o.size) * sizeof(uint32_t));
+            LEPT_SHARED(dst->u.o.m)->capacity = src->u.o.size;
+            for (i = 0; i < src->u.o.size; i++) {
+                lept_member* m = &dst->u.o.m[i];
+                const lept_member* sm = &src->u.o.m[i];
+                if (sm->val.flags & LEPT_FLAG_KEY_INLINE) {
+                    memcpy(&m->key, &sm->key, LEPT_MEMBER_KLEN(sm) + 1);
+                    m->val.flags = sm->val.flags & (LEPT_FLAG_KEY_INLINE | 0xff000000u);
+                }
+                else {
+                    m->klen = sm->klen;
+                    memcpy(m->key = (char*)lept_shared_alloc(m->klen + 1), sm->key, m->klen + 1);
+                    m->val.flags = 0;
+                }
+            }
+            if (lept_object_index_slots(src->u.o.size)) {
+                lept_object_build_index(dst->u.o.m, src->u.o.size, src->u.o.size);
+            }
+            return 1;
+        default:
+            *dst = *src;
+            dst->flags = key;
+            return 0;
+    }
+}
+
+/* 深复制 结果的内存都属于dst*/
+static void lept_value_copy(lept_value* dst, const lept_value* src) {
+    lept_walk k;
+    lept_walk_frame* f;
+    unsigned key = 0;
+    lept_walk_init(&k);
+    for (;;) {
+        if (lept_value_copy_node(dst, src, key)) {
+            lept_walk_push(&k, src, dst);
+        }
+        /* 下一对要复制的子结点 已经复制完的容器出栈*/
+        for (;;) {
+            if (k.depth == 0) {
+                lept_walk_free(&k);
+                return;
+            }
+            f = LEPT_WALK_TOP(&k);
+            if (f->v->type == LEPT_ARRAY && f->i < f->v->u.a.size) {
+                src = &f->v->u.a.e[f->i];
+                dst = &f->w->u.a.e[f->i++];
+                key = 0;
+                break;
+            }
+            if (f->v->type == LEPT_OBJECT && f->i < f->v->u.o.size) {
+                src = &f->v->u.o.m[f->i].val;
+                dst = &f->w->u.o.m[f->i++].val;
+                key = dst->flags;
+                break;
+            }
+            k.depth--;
+        }
+    }
+}
+
+static void lept_project_add(lept_project* s, size_t id, const lept_value* v) {
+    lept_match* m = (lept_match*)lept_context_push(&s->matches, sizeof(lept_match));
+    m->id = id;
+    lept_value_copy(&m->v, v);
+}
+
+/* 在已经建立的值中查找第id条路径从depth开始的部分*/
+static void lept_project_find(lept_project* s, size_t id, const lept_value* v, size_t depth) {
+    const lept_pointer* path = &s->p->paths[id];
+    const lept_pointer_token* token;
+    size_t i;
+    if (depth == path->n) {
+        lept_project_add(s, id, v);
+        return;
+    }
+    token = &path->tokens[depth];
+    if (v->type == LEPT_ARRAY) {
+        for (i = 0; i < v->u.a.size; i++) {
+            if (token->wildcard || token->index == i) {
+                lept_project_find(s, id, &v->u.a.e[i], depth + 1);
+            }
+        }
+    }
+    else if (v->type == LEPT_OBJECT) {
+        for (i = 0; i < v->u.o.size; i++) {
+            if (LEPT_MEMBER_KLEN(&v->u.o.m[i]) == token->len && memcmp(LEPT_MEMBER_KEY(&v->u.o.m[i]), token->s, token->len) == 0) {
+                lept_project_find(s, id, &v->u.o.m[i].val, depth + 1);
+            }
+        }
+    }
+}
+
+/* 越过一个值 不建立结点*/
+static int lept_project_skip(lept_context* c) {
+    const char* p = c->json;
+    switch (PEEK(c, p)) {
+        case '\"':
+            if ((p = lept_skip_string(c, p)) == NULL) {
+                return LEPT_PARSE_MISS_QUOTATION_MARK;
+            }
+            break;
+        case '[':
+            if ((p = lept_skip_container(c, p)) == NULL) {
+                return LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+            }
+            break;
+        case '{':
+            if ((p = lept_skip_container(c, p)) == NULL) {
+                return LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+            }
+            break;
+        case 't': case 'f': case 'n': case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            p = lept_skip_scalar(c, p);
+            break;
+        case '\0':
+            return p == c->end ? LEPT_PARSE_EXPECT_VALUE : LEPT_PARSE_INVALID_VALUE;
+        default:
+            return LEPT_PARSE_INVALID_VALUE;
+    }
+    c->json = p;
+    return LEPT_PARSE_OK;
+}
+
+static int lept_project_value(lept_project* s, size_t off, size_t n, size_t depth);
+
+static int lept_project_array(lept_project* s, size_t off, size_t n, size_t depth) {
+    lept_context* c = s->c;
+    size_t index, i;
+    int ret;
+    EXPECT(c, '[');
+    lept_parse_whitespace(c);
+    if (PEEK(c, c->json) == ']') {
+        c->json++;
+        return LEPT_PARSE_OK;
+    }
+    for (index = 0; ; index++) {
+        size_t child = s->ids.top, m = 0;
+        for (i = 0; i < n; i++) {
+            size_t id = LEPT_PROJECT_ID(s, off, i);
+            const lept_pointer_token* token = &s->p->paths[id].tokens[depth];
+            if (token->wildcard || token->index == index) {
+                *(size_t*)lept_context_push(&s->ids, sizeof(size_t)) = id;
+                m++;
+            }
+        }
+        ret = lept_project_value(s, child, m, depth + 1);
+        s->ids.top = child;
+        if (ret != LEPT_PARSE_OK) {
+            return ret;
+        }
+        lept_parse_whitespace(c);
+        if (PEEK(c, c->json) == ',') {
+            c->json++;
+            lept_parse_whitespace(c);
+        }
+        else if (PEEK(c, c->json) == ']') {
+            c->json++;
+            return LEPT_PARSE_OK;
+        }
+        else {
+            return LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+        }
+    }
+}
+
+static int lept_project_object(lept_project* s, size_t off, size_t n, size_t depth) {
+    lept_context* c = s->c;
+    const char* key;
+    size_t klen, i;
+    int ret;
+    EXPECT(c, '{');
+    lept_parse_whitespace(c);
+    if (PEEK(c, c->json) == '}') {
+        c->json++;
+        return LEPT_PARSE_OK;
+    }
+    for ( ; ; ) {
+        size_t child = s->ids.top, m = 0;
+        if (PEEK(c, c->json) != '\"') {
+            return LEPT_PARSE_MISS_KEY;
+        }
+        /* 键位于栈顶之外 在下一次压栈之前比较完*/
+        if ((ret = lept_parse_string_raw(c, &key, &klen)) != LEPT_PARSE_OK) {
+            return ret;
+        }
+        for (i = 0; i < n; i++) {
+            size_t id = LEPT_PROJECT_ID(s, off, i);
+            const lept_pointer_token* token = &s->p->paths[id].tokens[depth];
+            if (token->len == klen && memcmp(token->s, key, klen) == 0) {
+                *(size_t*)lept_context_push(&s->ids, sizeof(size_t)) = id;
+                m++;
+            }
+        }
+        lept_parse_whitespace(c);
+        if (PEEK(c, c->json) != ':') {
+            s->ids.top = child;
+            return LEPT_PARSE_MISS_COLON;
+        }
+        c->json++;
+        lept_parse_whitespace(c);
+        ret = lept_project_value(s, child, m, depth + 1);
+        s->ids.top = child;
+        if (ret != LEPT_PARSE_OK) {
+            return ret;
+        }
+        lept_parse_whitespace(c);
+        if (PEEK(c, c->json) == ',') {
+            c->json++;
+            lept_parse_whitespace(c);
+        }
+        else if (PEEK(c, c->json) == '}') {
+            c->json++;
+            return LEPT_PARSE_OK;
+        }
+        else {
+            return LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET;
+        }
+    }
+}
+
+/* ids.stack + off处是仍然可能匹配这个值的n条路径 它们的前depth个键已经匹配*/
+static int lept_project_value(lept_project* s, size_t off, size_t n, size_t depth) {
+    lept_context* c = s->c;
+    lept_value e;
+    size_t i;
+    int ret;
+    if (n == 0) {
+        return lept_project_skip(c);
+    }
+    for (i = 0; i < n && s->p->paths[LEPT_PROJECT_ID(s, off, i)].n != depth; i++) {
+    }
+    if (i == n) {
+        /* 所有路径都要继续深入 标量不可能匹配*/
+        switch (PEEK(c, c->json)) {
+            case '[': return lept_project_array(s, off, n, depth);
+            case '{': return lept_project_object(s, off, n, depth);
+            default:  return lept_project_skip(c);
+        }
+    }
+    /* 有路径在这里结束 建立整个值*/
+    if ((ret = lept_parse_value(c)) != LEPT_PARSE_OK) {
+        return ret;
+    }
+    memcpy(&e, lept_context_pop(c, sizeof(lept_value)), sizeof(lept_value));
+    if (n == 1) {
+        lept_match* m = (lept_match*)lept_context_push(&s->matches, sizeof(lept_match));
+        m->id = LEPT_PROJECT_ID(s, off, 0);
+        m->v = e;
+        return LEPT_PARSE_OK;
+    }
+    for (i = 0; i < n; i++) {
+        lept_project_find(s, LEPT_PROJECT_ID(s, off, i), &e, depth);
+    }
+    lept_free(&e);
+    return LEPT_PARSE_OK;
+}
+
+/*
+    投影解析 结果是每条路径一个数组 匹配到的值按文本中的顺序排列
+*/
+int lept_parse_projection(lept_value* v, const char* json, size_t len, const lept_projection* p) {
+    lept_context c;
+    lept_project s;
+    lept_match* m;
+    size_t i, j, k, nmatches;
+    int ret;
+    assert(v != NULL && p != NULL && (json != NULL || len == 0));
+    lept_init(v);
+    c.json = json;
+    c.end = json + len;
+    c.stack = NULL;
+    c.size = c.top = 0;
+    c.fixed = 0;
+    c.arena = NULL;
+    c.insitu = 0;
+    c.intern = NULL;
+    c.stats = NULL;
+    c.allocator = &lept_allocator_global;
+    c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    c.kernels = lept_select_kernels();
+    c.handler = &lept_build_handler;
+    c.ctx = &c;
+    s.c = &c;
+    s.p = p;
+    s.ids.stack = s.matches.stack = NULL;
+    s.ids.size = s.ids.top = s.matches.size = s.matches.top = 0;
+    s.ids.stats = s.matches.stats = NULL;
+    s.ids.allocator = s.matches.allocator = &lept_allocator_global;
+    s.ids.max_depth = s.matches.max_depth = LEPT_PARSE_MAX_DEPTH;
+    s.ids.fixed = s.matches.fixed = 0;
+    for (i = 0; i < p->count; i++) {
+        *(size_t*)lept_context_push(&s.ids, sizeof(size_t)) = i;
+    }
+    lept_parse_whitespace(&c);
+    if ((ret = lept_project_value(&s, 0, p->count, 0)) == LEPT_PARSE_OK) {
+        lept_parse_whitespace(&c);
+        if (c.json != c.end) {
+            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
+        }
+    }
+    m = (lept_match*)s.matches.stack;
+    nmatches = s.matches.top / sizeof(lept_match);
+    if (ret == LEPT_PARSE_OK) {
+        /* 按路径的顺序分组 组内保持文本中的顺序*/
+        v->type = LEPT_ARRAY;
+        v->u.a.size = p->count;
+        v->u.a.e = NULL;
+        if (p->count) {
+            v->u.a.e = (lept_value*)lept_shared_alloc(p->count * sizeof(lept_value));
+            LEPT_SHARED(v->u.a.e)->capacity = p->count;
+        }
+        for (i = 0; i < p->count; i++) {
+            lept_value* a = &v->u.a.e[i];
+            a->type = LEPT_ARRAY;
+            a->flags = 0;
+            a->u.a.size = 0;
+            for (j = 0; j < nmatches; j++) {
+                a->u.a.size += m[j].id == i;
+            }
+            a->u.a.e = NULL;
+            if (a->u.a.size) {
+                a->u.a.e = (lept_value*)lept_shared_alloc(a->u.a.size * sizeof(lept_value));
+                LEPT_SHARED(a->u.a.e)->capacity = a->u.a.size;
+            }
+            for (j = k = 0; j < nmatches; j++) {
+                if (m[j].id == i) {
+                    a->u.a.e[k++] = m[j].v;
+                }
+            }
+        }
+    }
+    else {
+        for (j = 0; j < nmatches; j++) {
+            lept_free(&m[j].v);
+        }
+        while (c.top > 0) {
+            lept_free((lept_value*)lept_context_pop(&c, sizeof(lept_value)));
+        }
+    }
+    LEPT_FREE_WITH(c.allocator, c.stack);
+    LEPT_FREE_WITH(s.ids.allocator, s.ids.stack);
+    LEPT_FREE_WITH(s.matches.allocator, s.matches.stack);
+    return ret;
+}
+
+/*
+    解析JSON文本
+*/
+int lept_parse(lept_value* v, const char* json) {
+    lept_context c;
+    assert(json != NULL);
+    c.arena = NULL;
+    c.insitu = 0;
+    c.intern = NULL;
+    c.stats = NULL;
+    c.allocator = &lept_allocator_global;
+    c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    return lept_parse_root(&c, v, json, strlen(json));
+}
+
+/*
+    解析长度为len的JSON文本 不要求以'\0'结尾
+*/
+int lept_parse_n(lept_value* v, const char* json, size_t len) {
+    lept_context c;
+    c.arena = NULL;
+    c.insitu = 0;
+    c.intern = NULL;
+    c.stats = NULL;
+    c.allocator = &lept_allocator_global;
+    c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    return lept_parse_root(&c, v, json, len);
+}
+
+/*
+    解析文件 POSIX系统上只读映射整个文件 不复制
+*/
+int lept_parse_file(lept_value* v, const char* path) {
+#ifdef LEPT_HAVE_MMAP
+    int fd, ret;
+    struct stat st;
+    void* p;
+    assert(v != NULL && path != NULL);
+    lept_init(v);
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return LEPT_PARSE_FILE_ERROR;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return LEPT_PARSE_FILE_ERROR;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return lept_parse_n(v, NULL, 0);
+    }
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return LEPT_PARSE_FILE_ERROR;
+    }
+    /* 解析是顺序读取 让内核加大预读*/
+    posix_madvise(p, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+    ret = lept_parse_n(v, (const char*)p, (size_t)st.st_size);
+    munmap(p, (size_t)st.st_size);
+    return ret;
+#else
+    FILE* fp;
+    char* buf;
+    long size;
+    int ret;
+    assert(v != NULL && path != NULL);
+    lept_init(v);
+    if ((fp = fopen(path, "rb")) == NULL) {
+        return LEPT_PARSE_FILE_ERROR;
+    }
+    if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < 0 || fseek(fp, 0, SEEK_SET) != 0) {
+        fclose(fp);
+        return LEPT_PARSE_FILE_ERROR;
+    }
+    buf = (char*)LEPT_MALLOC(size ? (size_t)size : 1);
+    if (fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+        LEPT_FREE(buf);
+        fclose(fp);
+        return LEPT_PARSE_FILE_ERROR;
+    }
+    fclose(fp);
+    ret = lept_parse_n(v, buf, (size_t)size);
+    LEPT_FREE(buf);
+    return ret;
+#endif
+}
+
+/*
+    按选项解析
+    c的栈由调用者提供 解析之后留给下一次使用
+*/
+static int lept_parse_with(lept_context* c, lept_value* v, const char* json, size_t len, const lept_parse_options* opts) {
+    c->arena = opts != NULL ? opts->arena : NULL;
+    c->insitu = 0;
+    c->intern = opts != NULL ? opts->intern : NULL;
+    c->intern_strings = opts != NULL && (opts->flags & LEPT_PARSE_INTERN_STRINGS);
+    c->max_depth = opts != NULL && opts->max_depth != 0 ? opts->max_depth : LEPT_PARSE_MAX_DEPTH;
+    if (opts != NULL && (opts->flags & LEPT_PARSE_LAZY)) {
+        return lept_parse_lazy(c, v, json, len);
+    }
+    return lept_parse_dom(c, v, json, len);
+}
+
+void lept_parse_options_init(lept_parse_options* opts) {
+    assert(opts != NULL);
+    memset(opts, 0, sizeof(*opts));
+}
+
+/*
+    按选项一次性解析 栈只用于这一次
+*/
+int lept_parse_ex(lept_value* v, const char* json, size_t len, const lept_parse_options* opts) {
+    lept_context c;
+    int ret;
+    c.stack = NULL;
+    c.size = 0;
+    c.stats = NULL;
+    c.allocator = opts != NULL && opts->allocator != NULL ? opts->allocator : &lept_allocator_global;
+    ret = lept_parse_with(&c, v, json, len, opts);
+    LEPT_FREE_WITH(c.allocator, c.stack);
+    return ret;
+}
+
+/*
+    与lept_parse_ex()相同 同时记录统计 没有定义LEPT_STATS时统计全部为0
+*/
+int lept_parse_ex_stats(lept_value* v, const char* json, size_t len, const lept_parse_options* opts, lept_parse_stats* stats) {
+    lept_context c;
+    int ret;
+#ifdef LEPT_STATS
+    lept_stats_state st;
+    uint64_t start = 0, phases = 0;
+    int i;
+#endif
+    assert(stats != NULL);
+    memset(stats, 0, sizeof(lept_parse_stats));
+    c.stack = NULL;
+    c.size = 0;
+    c.stats = NULL;
+    c.allocator = opts != NULL && opts->allocator != NULL ? opts->allocator : &lept_allocator_global;
+#ifdef LEPT_STATS
+    st.out = stats;
+    st.depth = 0;
+    st.cycles = opts != NULL && (opts->flags & LEPT_PARSE_STATS_CYCLES);
+    c.stats = &st;
+    if (st.cycles) {
+        start = lept_cycles();
+    }
+#endif
+    ret = lept_parse_with(&c, v, json, len, opts);
+#ifdef LEPT_STATS
+    stats->bytes = ret == LEPT_PARSE_OK ? len : (size_t)(c.json - json);
+    if (st.cycles) {
+        /* 其余的时间都算作容器 包括括号、字面量和建立结点*/
+        for (i = 0; i < LEPT_PHASE_CONTAINER; i++) {
+            phases += stats->cycles[i];
+        }
+        start = lept_cycles() - start;
+        stats->cycles[LEPT_PHASE_CONTAINER] = start > phases ? start - phases : 0;
+    }
+#endif
+    LEPT_FREE_WITH(c.allocator, c.stack);
+    return ret;
+}
+
+/*
+    可以复用的解析器 栈在多次解析之间保留 不再每次申请和释放
+*/
+struct lept_parser {
+    lept_context c;
+    lept_parse_options opts;
+};
+
+lept_parser* lept_parser_new(const lept_parse_options* opts, size_t stack_size) {
+    const lept_allocator* a = opts != NULL && opts->allocator != NULL ? opts->allocator : &lept_allocator_global;
+    lept_parser* p = (lept_parser*)LEPT_ALLOC_WITH(a, sizeof(lept_parser));
+    if (stack_size == 0) {
+        stack_size = LEPT_PARSE_STACK_INIT_SIZE;
+    }
+    p->c.stack = (char*)LEPT_ALLOC_WITH(a, stack_size);
+    p->c.size = stack_size;
+    p->c.top = 0;
+    p->c.fixed = 0;
+    p->c.stats = NULL;
+    p->c.allocator = a;
+    p->c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    if (opts != NULL) {
+        p->opts = *opts;
+    }
+    else {
+        memset(&p->opts, 0, sizeof(p->opts));
+    }
+    return p;
+}
+
+int lept_parser_parse(lept_parser* p, lept_value* v, const char* json, size_t len) {
+    assert(p != NULL);
+    return lept_parse_with(&p->c, v, json, len, &p->opts);
+}
+
+void lept_parser_free(lept_parser* p) {
+    if (p) {
+        const lept_allocator* a = p->c.allocator;
+        LEPT_FREE_WITH(a, p->c.stack);
+        LEPT_FREE_WITH(a, p);
+    }
+}
+
+/*
+    使用arena解析JSON文本 出错时已经切分的内存留在arena中 随arena一起释放
+*/
+int lept_parse_arena(lept_value* v, lept_arena* a, const char* json) {
+    lept_context c;
+    assert(a != NULL && json != NULL);
+    c.arena = a;
+    c.insitu = 0;
+    c.intern = NULL;
+    c.stats = NULL;
+    c.allocator = &lept_allocator_global;
+    c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    return lept_parse_root(&c, v, json, strlen(json));
+}
+
+/*
+    原地解析 字符串在json中解码 结果直接引用json 不再为字符串分配内存
+*/
+int lept_parse_insitu(lept_value* v, char* json, size_t len) {
+    lept_context c;
+    c.arena = NULL;
+    c.insitu = 1;
+    c.intern = NULL;
+    c.stats = NULL;
+    c.allocator = &lept_allocator_global;
+    c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    return lept_parse_root(&c, v, json, len);
+}
+
+/*
+    NDJSON批量解析：输入按行边界切成若干批 工作线程每次取一批 用各自的栈逐行解析
+    有序模式下每批的结果先存在槽位中 由调用线程按顺序交给回调
+    无序模式下工作线程解析完一行就直接调用回调
+*/
+typedef struct {
+    size_t line;
+    int ret;
+    lept_value v;
+} lept_ndjson_result;
+
+/* 有序模式下一批的结果*/
+typedef struct {
+    lept_ndjson_result* r;
+    size_t count, capacity;
+    int done;
+} lept_ndjson_slot;
+
+typedef struct {
+    const char* begin;
+    const char* end;
+    size_t line, seq;
+} lept_ndjson_batch;
+
+typedef struct {
+    const char* cursor; /* 还没有分出去的输入*/
+    const char* end;
+    size_t line; /* cursor处的行号*/
+    size_t taken; /* 已经分出去的批数*/
+    size_t delivered; /* 有序模式下已经交付的批数*/
+    size_t window; /* 有序模式下同时处理的批数上限 无序模式为0*/
+    lept_ndjson_slot* slots;
+    lept_ndjson_callback cb;
+    void* ctx;
+    int stop; /* 回调要求停止*/
+#ifdef LEPT_HAVE_PTHREADS
+    int threaded;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+#endif
+} lept_ndjson;
+
+static void lept_ndjson_lock(lept_ndjson* s) {
+#ifdef LEPT_HAVE_PTHREADS
+    if (s->threaded) {
+        pthread_mutex_lock(&s->lock);
+    }
+#else
+    (void)s;
+#endif
+}
+
+static void lept_ndjson_unlock(lept_ndjson* s) {
+#ifdef LEPT_HAVE_PTHREADS
+    if (s->threaded) {
+        pthread_mutex_unlock(&s->lock);
+    }
+#else
+    (void)s;
+#endif
+}
+
+/* 只在多线程时调用*/
+static void lept_ndjson_wait(lept_ndjson* s) {
+#ifdef LEPT_HAVE_PTHREADS
+    pthread_cond_wait(&s->cond, &s->lock);
+#else
+    (void)s;
+    assert(0);
+#endif
+}
+
+static void lept_ndjson_signal(lept_ndjson* s) {
+#ifdef LEPT_HAVE_PTHREADS
+    if (s->threaded) {
+        pthread_cond_broadcast(&s->cond);
+    }
+#else
+    (void)s;
+#endif
+}
+
+static void lept_ndjson_stop(lept_ndjson* s) {
+    lept_ndjson_lock(s);
+    s->stop = 1;
+    lept_ndjson_signal(s);
+    lept_ndjson_unlock(s);
+}
+
+static size_t lept_count_lines(const char* p, const char* end) {
+    size_t n = 0;
+    while ((p = (const char*)memchr(p, '\n', (size_t)(end - p))) != NULL) {
+        n++;
+        p++;
+    }
+    return n;
+}
+
+/* 取下一批 大约LEPT_NDJSON_BATCH_SIZE字节 在换行处结束 没有更多输入或已经停止时返回0*/
+static int lept_ndjson_take(lept_ndjson* s, lept_ndjson_batch* b) {
+    const char* p;
+    lept_ndjson_lock(s);
+    /* 有序模式下等待槽位空出*/
+    while (!s->stop && s->cursor != s->end && s->window && s->taken >= s->delivered + s->window) {
+        lept_ndjson_wait(s);
+    }
+    if (s->stop || s->cursor == s->end) {
+        lept_ndjson_unlock(s);
+        return 0;
+    }
+    b->begin = s->cursor;
+    if ((size_t)(s->end - s->cursor) > LEPT_NDJSON_BATCH_SIZE) {
+        p = (const char*)memchr(s->cursor + LEPT_NDJSON_BATCH_SIZE, '\n', (size_t)(s->end - s->cursor) - LEPT_NDJSON_BATCH_SIZE);
+        p = p ? p + 1 : s->end;
+    }
+    else {
+        p = s->end;
+    }
+    b->end = p;
+    b->line = s->line;
+    b->seq = s->taken++;
+    s->line += lept_count_lines(b->begin, b->end);
+    s->cursor = p;
+    lept_ndjson_unlock(s);
+    return 1;
+}
+
+static void lept_ndjson_parse_batch(lept_ndjson* s, lept_context* c, const lept_ndjson_batch* b) {
+    lept_ndjson_slot* slot = s->window ? &s->slots[b->seq % s->window] : NULL;
+    const char* p = b->begin;
+    const char* e;
+    size_t line = b->line;
+    for ( ; p != b->end; p = e + 1, line++) {
+        lept_value v;
+        int ret;
+        if ((e = (const char*)memchr(p, '\n', (size_t)(b->end - p))) == NULL) {
+            e = b->end - 1; /* 最后一行没有换行符 循环之后p == b->end*/
+            ret = c->kernels->skip_whitespace(p, b->end) == b->end ? -1 : lept_parse_dom(c, &v, p, (size_t)(b->end - p));
+        }
+        else {
+            /* 空行跳过*/
+            ret = c->kernels->skip_whitespace(p, e) == e ? -1 : lept_parse_dom(c, &v, p, (size_t)(e - p));
+        }
+        if (ret < 0) {
+            continue;
+        }
+        if (slot) {
+            if (slot->count == slot->capacity) {
+                slot->capacity = slot->capacity ? slot->capacity + (slot->capacity >> 1) : 64;
+                slot->r = (lept_ndjson_result*)LEPT_REALLOC(slot->r, slot->capacity * sizeof(lept_ndjson_result));
+            }
+            slot->r[slot->count].line = line;
+            slot->r[slot->count].ret = ret;
+            slot->r[slot->count++].v = v;
+        }
+        else {
+            int stop = s->cb(s->ctx, line, ret, &v);
+            lept_free(&v);
+            if (stop) {
+                lept_ndjson_stop(s);
+                return;
+            }
+        }
+    }
+    if (slot) {
+        lept_ndjson_lock(s);
+        slot->done = 1;
+        lept_ndjson_signal(s);
+        lept_ndjson_unlock(s);
+    }
+}
+
+/* 一个工作线程 栈在所有记录之间复用*/
+static void lept_ndjson_run(lept_ndjson* s) {
+    lept_context c;
+    lept_ndjson_batch b;
+    c.stack = NULL;
+    c.size = 0;
+    c.arena = NULL;
+    c.insitu = 0;
+    c.intern = NULL;
+    c.stats = NULL;
+    c.allocator = &lept_allocator_global;
+    c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    c.kernels = lept_select_kernels();
+    while (lept_ndjson_take(s, &b)) {
+        lept_ndjson_parse_batch(s, &c, &b);
+    }
+    LEPT_FREE_WITH(c.allocator, c.stack);
+}
+
+#ifdef LEPT_HAVE_PTHREADS
+static void* lept_ndjson_thread(void* arg) {
+    lept_ndjson_run((lept_ndjson*)arg);
+    return NULL;
+}
+
+/* 有序模式下在调用线程中按批的顺序调用回调*/
+static void lept_ndjson_deliver(lept_ndjson* s) {
+    size_t i;
+    for ( ; ; ) {
+        lept_ndjson_slot* slot;
+        lept_ndjson_lock(s);
+        while (!s->stop && (s->delivered < s->taken ? !s->slots[s->delivered % s->window].done : s->cursor != s->end)) {
+            lept_ndjson_wait(s);
+        }
+        if (s->stop || s->delivered == s->taken) {
+            lept_ndjson_unlock(s);
+            return;
+        }
+        slot = &s->slots[s->delivered % s->window];
+        lept_ndjson_unlock(s);
+        for (i = 0; i < slot->count; i++) {
+            if (!s->stop && s->cb(s->ctx, slot->r[i].line, slot->r[i].ret, &slot->r[i].v)) {
+                lept_ndjson_stop(s);
+            }
+            lept_free(&slot->r[i].v);
+        }
+        lept_ndjson_lock(s);
+        slot->count = 0;
+        slot->done = 0;
+        s->delivered++;
+        lept_ndjson_signal(s);
+        lept_ndjson_unlock(s);
+    }
+}
+
+static void lept_ndjson_threads(lept_ndjson* s, int nthreads, int ordered) {
+    pthread_t* threads = (pthread_t*)LEPT_MALLOC((size_t)nthreads * sizeof(pthread_t));
+    size_t i;
+    int n = 0, k;
+    s->threaded = 1;
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->cond, NULL);
+    if (ordered) {
+        s->window = 2 * (size_t)nthreads;
+        s->slots = (lept_ndjson_slot*)LEPT_MALLOC(s->window * sizeof(lept_ndjson_slot));
+        for (i = 0; i < s->window; i++) {
+            s->slots[i].r = NULL;
+            s->slots[i].count = s->slots[i].capacity = 0;
+            s->slots[i].done = 0;
+        }
+    }
+    /* 无序模式下调用线程也参与解析*/
+    for (k = ordered ? 0 : 1; k < nthreads; k++) {
+        if (pthread_create(&threads[n], NULL, lept_ndjson_thread, s) == 0) {
+            n++;
+        }
+    }
+    if (ordered && n > 0) {
+        lept_ndjson_deliver(s);
+    }
+    else {
+        /* 有序模式下一个线程也没有创建成功时 在调用线程中解析 结果自然有序*/
+        if (ordered) {
+            s->window = 0;
+        }
+        lept_ndjson_run(s);
+    }
+    for (k = 0; k < n; k++) {
+        pthread_join(threads[k], NULL);
+    }
+    /* 停止后还没有交付的结果*/
+    if (s->slots) {
+        for (i = 0; i < 2 * (size_t)nthreads; i++) {
+            size_t j;
+            for (j = 0; j < s->slots[i].count; j++) {
+                lept_free(&s->slots[i].r[j].v);
+            }
+            LEPT_FREE(s->slots[i].r);
+        }
+        LEPT_FREE(s->slots);
+    }
+    pthread_cond_destroy(&s->cond);
+    pthread_mutex_destroy(&s->lock);
+    LEPT_FREE(threads);
+}
+#endif
+
+/*
+    解析NDJSON 每一行交给回调
+*/
+int lept_parse_ndjson(const char* json, size_t len, int nthreads, int ordered, lept_ndjson_callback cb, void* ctx) {
+    lept_ndjson s;
+    assert((json != NULL || len == 0) && cb != NULL);
+    s.cursor = json;
+    s.end = json + len;
+    s.line = 1;
+    s.taken = s.delivered = 0;
+    s.window = 0;
+    s.slots = NULL;
+    s.cb = cb;
+    s.ctx = ctx;
+    s.stop = 0;
+#ifdef LEPT_HAVE_PTHREADS
+    s.threaded = 0;
+    if (nthreads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads = n > 0 ? (int)n : 1;
+    }
+    if (nthreads > 1) {
+        lept_ndjson_threads(&s, nthreads, ordered);
+        return s.stop ? LEPT_PARSE_STOPPED : LEPT_PARSE_OK;
+    }
+#else
+    (void)nthreads;
+    (void)ordered;
+#endif
+    lept_ndjson_run(&s);
+    return s.stop ? LEPT_PARSE_STOPPED : LEPT_PARSE_OK;
+}
+
+/*
+    推送式解析：输入可以分成任意大小的块依次送入
+    块之间保存结构状态和嵌套栈 没有完整的字符串和数字先缓存在tok中
+    记号完整后交给lept_parse_string_raw()和lept_parse_number()处理 所以结果和错误码与一次性解析相同
+*/
+enum {
+    LEPT_PUSH_VALUE,       /* 期待一个值*/
+    LEPT_PUSH_FIRST_VALUE, /* '['之后 期待一个值或']'*/
+    LEPT_PUSH_FIRST_KEY,   /* '{'之后 期待一个键或'}'*/
+    LEPT_PUSH_KEY,         /* 对象中','之后 期待一个键*/
+    LEPT_PUSH_COLON,       /* 键之后 期待':'*/
+    LEPT_PUSH_NEXT,        /* 值之后 期待','或结束括号*/
+    LEPT_PUSH_END,         /* 根值已经结束 只允许空白*/
+    LEPT_PUSH_LITERAL,     /* true false null*/
+    LEPT_PUSH_NUMBER,
+    LEPT_PUSH_STRING
+};
+
+/* 数字的语法状态 与lept_parse_number()一致*/
+enum {
+    LEPT_NUM_START,      /* 可以有负号*/
+    LEPT_NUM_MINUS,      /* 负号之后 需要整数部分*/
+    LEPT_NUM_ZERO,       /* 整数部分是0*/
+    LEPT_NUM_INT,
+    LEPT_NUM_POINT,      /* 小数点之后 需要数字*/
+    LEPT_NUM_FRAC,
+    LEPT_NUM_EXP,        /* e之后 可以有正负号*/
+    LEPT_NUM_EXP_SIGN,   /* 正负号之后 需要数字*/
+    LEPT_NUM_EXP_DIGITS
+};
+
+/* 嵌套栈中的一层*/
+typedef struct {
+    size_t size; /* 已经完成的元素或成员个数*/
+    int object;
+} lept_push_frame;
+
+struct lept_push_parser {
+    lept_context c; /* 事件交给c.handler 建立DOM时结点压在c的栈上*/
+    lept_context tok; /* 未完成的字符串或数字*/
+    lept_context frames; /* 嵌套栈*/
+    lept_value* v; /* 建立DOM时结果写入v 否则为NULL*/
+    int state;
+    int sub; /* 字面量已匹配的字符数/数字的语法状态/字符串中上一个字节是'\\'*/
+    const char* literal;
+    int key; /* 当前字符串是键*/
+    int ret; /* 出错后保持不变*/
+};
+
+#define LEPT_PUSH_TOP(p) ((lept_push_frame*)((p)->frames.stack + (p)->frames.top) - 1)
+
+/* 数字中ch之后的状态 ch不能继续这个数字时返回-1*/
+static int lept_number_next(int state, char ch) {
+    switch (state) {
+        case LEPT_NUM_START:
+            if (ch == '-') {
+                return LEPT_NUM_MINUS;
+            }
+            return ch == '0' ? LEPT_NUM_ZERO : ISDIGIT1TO9(ch) ? LEPT_NUM_INT : -1;
+        case LEPT_NUM_MINUS:
+            return ch == '0' ? LEPT_NUM_ZERO : ISDIGIT1TO9(ch) ? LEPT_NUM_INT : -1;
+        case LEPT_NUM_INT:
+            if (ISDIGIT(ch)) {
+                return LEPT_NUM_INT;
+            }
+            return ch == '.' ? LEPT_NUM_POINT : (ch == 'e' || ch == 'E') ? LEPT_NUM_EXP : -1;
+        case LEPT_NUM_ZERO:
+            return ch == '.' ? LEPT_NUM_POINT : (ch == 'e' || ch == 'E') ? LEPT_NUM_EXP : -1;
+        case LEPT_NUM_POINT:
+            return ISDIGIT(ch) ? LEPT_NUM_FRAC : -1;
+        case LEPT_NUM_FRAC:
+            if (ISDIGIT(ch)) {
+                return LEPT_NUM_FRAC;
+            }
+            return (ch == 'e' || ch == 'E') ? LEPT_NUM_EXP : -1;
+        case LEPT_NUM_EXP:
+            if (ch == '+' || ch == '-') {
+                return LEPT_NUM_EXP_SIGN;
+            }
+            return ISDIGIT(ch) ? LEPT_NUM_EXP_DIGITS : -1;
+        default:
+            return ISDIGIT(ch) ? LEPT_NUM_EXP_DIGITS : -1;
+    }
+}
+
+static void lept_push_context_init(lept_context* c, const lept_handler* h, void* ctx) {
+    c->json = c->end = NULL;
+    c->stack = NULL;
+    c->size = c->top = 0;
+    c->arena = NULL;
+    c->insitu = 0;
+    c->intern = NULL;
+    c->stats = NULL;
+    c->allocator = &lept_allocator_global;
+    c->max_depth = LEPT_PARSE_MAX_DEPTH;
+    c->kernels = lept_select_kernels();
+    c->fixed = 0;
+    c->handler = h;
+    c->ctx = ctx;
+}
+
+static lept_push_parser* lept_push_parser_create(lept_value* v, const lept_handler* h, void* ctx) {
+    lept_push_parser* p = (lept_push_parser*)LEPT_MALLOC(sizeof(lept_push_parser));
+    if (v) {
+        lept_init(v);
+        lept_push_context_init(&p->c, &lept_build_handler, &p->c);
+    }
+    else {
+        lept_push_context_init(&p->c, h, ctx);
+    }
+    /* 缓存的字符串在tok中原地解码*/
+    lept_push_context_init(&p->tok, p->c.handler, p->c.ctx);
+    p->tok.insitu = 1;
+    lept_push_context_init(&p->frames, NULL, NULL);
+    p->v = v;
+    p->state = LEPT_PUSH_VALUE;
+    p->sub = 0;
+    p->literal = NULL;
+    p->key = 0;
+    p->ret = LEPT_PARSE_OK;
+    return p;
+}
+
+lept_push_parser* lept_push_parser_new(lept_value* v) {
+    assert(v != NULL);
+    return lept_push_parser_create(v, NULL, NULL);
+}
+
+lept_push_parser* lept_push_parser_new_sax(const lept_handler* h, void* ctx) {
+    assert(h != NULL);
+    return lept_push_parser_create(NULL, h, ctx);
+}
+
+void lept_push_parser_set_max_depth(lept_push_parser* p, size_t max_depth) {
+    assert(p != NULL);
+    p->c.max_depth = max_depth != 0 ? max_depth : LEPT_PARSE_MAX_DEPTH;
+}
+
+/* 一个值完成之后 计入所在的数组或对象*/
+static void lept_push_value_end(lept_push_parser* p) {
+    if (p->frames.top == 0) {
+        p->state = LEPT_PUSH_END;
+    }
+    else {
+        LEPT_PUSH_TOP(p)->size++;
+        p->state = LEPT_PUSH_NEXT;
+    }
+}
+
+static int lept_push_close(lept_push_parser* p) {
+    lept_push_frame f = *(lept_push_frame*)lept_context_pop(&p->frames, sizeof(lept_push_frame));
+    if (f.object) {
+        EMIT(&p->c, on_end_object, (p->c.ctx, f.size));
+    }
+    else {
+        EMIT(&p->c, on_end_array, (p->c.ctx, f.size));
+    }
+    lept_push_value_end(p);
+    return LEPT_PARSE_OK;
+}
+
+static int lept_push_open(lept_push_parser* p, int object) {
+    lept_push_frame* f;
+    if (p->frames.top / sizeof(lept_push_frame) == p->c.max_depth) {
+        return LEPT_PARSE_DEPTH_EXCEEDED;
+    }
+    f = (lept_push_frame*)lept_context_push(&p->frames, sizeof(lept_push_frame));
+    f->size = 0;
+    f->object = object;
+    if (object) {
+        p->state = LEPT_PUSH_FIRST_KEY;
+        EMIT(&p->c, on_start_object, (p->c.ctx));
+    }
+    else {
+        p->state = LEPT_PUSH_FIRST_VALUE;
+        EMIT(&p->c, on_start_array, (p->c.ctx));
+    }
+    return LEPT_PARSE_OK;
+}
+
+/* 数字已经结束(遇到其他字符或输入结束)*/
+static int lept_push_number_end(lept_push_parser* p) {
+    int ret;
+    if (p->sub != LEPT_NUM_ZERO && p->sub != LEPT_NUM_INT && p->sub != LEPT_NUM_FRAC && p->sub != LEPT_NUM_EXP_DIGITS) {
+        return LEPT_PARSE_INVALID_VALUE;
+    }
+    p->tok.json = p->tok.stack;
+    p->tok.end = p->tok.stack + p->tok.top;
+    ret = lept_parse_number(&p->tok);
+    p->tok.top = 0;
+    if (ret == LEPT_PARSE_OK) {
+        lept_push_value_end(p);
+    }
+    return ret;
+}
+
+/* 字符串以'"'结束 或者遇到了控制字符(一定会得到错误)*/
+static int lept_push_string_end(lept_push_parser* p) {
+    const char* s;
+    size_t len;
+    int ret;
+    p->tok.json = p->tok.stack;
+    p->tok.end = p->tok.stack + p->tok.top;
+    ret = lept_parse_string_raw(&p->tok, &s, &len);
+    p->tok.top = 0;
+    if (ret != LEPT_PARSE_OK) {
+        return ret;
+    }
+    if (p->key) {
+        p->state = LEPT_PUSH_COLON;
+        EMIT(&p->c, on_key, (p->c.ctx, s, len));
+    }
+    else {
+        lept_push_value_end(p);
+        EMIT(&p->c, on_string, (p->c.ctx, s, len));
+    }
+    return LEPT_PARSE_OK;
+}
+
+static void lept_push_string_start(lept_push_parser* p, int key) {
+    p->state = LEPT_PUSH_STRING;
+    p->key = key;
+    p->sub = 0;
+    PUTC(&p->tok, '\"');
+}
+
+/* 一个值的第一个字符 与lept_parse_value()的分派相同*/
+static int lept_push_value_start(lept_push_parser* p, const char** s) {
+    switch (**s) {
+        case 't': p->literal = "true"; break;
+        case 'f': p->literal = "false"; break;
+        case 'n': p->literal = "null"; break;
+        case '"':
+            (*s)++;
+            lept_push_string_start(p, 0);
+            return LEPT_PARSE_OK;
+        case '[': (*s)++; return lept_push_open(p, 0);
+        case '{': (*s)++; return lept_push_open(p, 1);
+        case '\0': return LEPT_PARSE_INVALID_VALUE;
+        default:
+            /* 这个字符由数字状态处理*/
+            p->state = LEPT_PUSH_NUMBER;
+            p->sub = LEPT_NUM_START;
+            return LEPT_PARSE_OK;
+    }
+    (*s)++;
+    p->state = LEPT_PUSH_LITERAL;
+    p->sub = 1;
+    return LEPT_PARSE_OK;
+}
+
+static int lept_push_run(lept_push_parser* p, const char* s, const char* end) {
+    const char* q;
+    int ret = LEPT_PARSE_OK, next;
+    char ch;
+    while (s != end) {
+        if (p->state <= LEPT_PUSH_END) {
+            if ((s = p->c.kernels->skip_whitespace(s, end)) == end) {
+                break;
+            }
+        }
+        switch (p->state) {
+            case LEPT_PUSH_FIRST_VALUE:
+                if (*s == ']') {
+                    s++;
+                    ret = lept_push_close(p);
+                    break;
+                }
+                ret = lept_push_value_start(p, &s);
+                break;
+            case LEPT_PUSH_VALUE:
+                ret = lept_push_value_start(p, &s);
+                break;
+            case LEPT_PUSH_FIRST_KEY:
+                if (*s == '}') {
+                    s++;
+                    ret = lept_push_close(p);
+                    break;
+                }
+                /* 否则与','之后相同*/
+                if (*s != '"') {
+                    return LEPT_PARSE_MISS_KEY;
+                }
+                s++;
+                lept_push_string_start(p, 1);
+                break;
+            case LEPT_PUSH_KEY:
+                if (*s != '"') {
+                    return LEPT_PARSE_MISS_KEY;
+                }
+                s++;
+                lept_push_string_start(p, 1);
+                break;
+            case LEPT_PUSH_COLON:
+                if (*s != ':') {
+                    return LEPT_PARSE_MISS_COLON;
+                }
+                s++;
+                p->state = LEPT_PUSH_VALUE;
+                break;
+            case LEPT_PUSH_NEXT:
+                ch = *s++;
+                if (ch == ',') {
+                    p->state = LEPT_PUSH_TOP(p)->object ? LEPT_PUSH_KEY : LEPT_PUSH_VALUE;
+                }
+                else if (ch == (LEPT_PUSH_TOP(p)->object ? '}' : ']')) {
+                    ret = lept_push_close(p);
+                }
+                else {
+                    return LEPT_PUSH_TOP(p)->object ? LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET : LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+                }
+                break;
+            case LEPT_PUSH_END:
+                return LEPT_PARSE_ROOT_NOT_SINGULAR;
+            case LEPT_PUSH_LITERAL:
+                for ( ; s != end && p->literal[p->sub]; s++, p->sub++) {
+                    if (*s != p->literal[p->sub]) {
+                        return LEPT_PARSE_INVALID_VALUE;
+                    }
+                }
+                if (p->literal[p->sub] == '\0') {
+                    lept_push_value_end(p);
+                    if (p->literal[0] == 'n') {
+                        EMIT(&p->c, on_null, (p->c.ctx));
+                    }
+                    else {
+                        EMIT(&p->c, on_bool, (p->c.ctx, p->literal[0] == 't'));
+                    }
+                }
+                break;
+            case LEPT_PUSH_NUMBER:
+                for (q = s; q != end && (next = lept_number_next(p->sub, *q)) >= 0; q++) {
+                    p->sub = next;
+                }
+                if (q != s) {
+                    PUTS(&p->tok, s, (size_t)(q - s));
+                    s = q;
+                }
+                /* 遇到不属于数字的字符 数字结束 这个字符留给下一个状态*/
+                if (s != end) {
+                    ret = lept_push_number_end(p);
+                }
+                break;
+            case LEPT_PUSH_STRING:
+                if (p->sub) {
+                    /* 转义字符后的一个字节*/
+                    PUTC(&p->tok, *s++);
+                    p->sub = 0;
+                    break;
+                }
+                q = p->c.kernels->scan_string(s, end);
+                if (q != s) {
+                    PUTS(&p->tok, s, (size_t)(q - s));
+                    s = q;
+                }
+                if (s == end) {
+                    break;
+                }
+                ch = *s++;
+                PUTC(&p->tok, ch);
+                if (ch == '\\') {
+                    p->sub = 1;
+                }
+                else {
+                    ret = lept_push_string_end(p);
+                }
+                break;
+        }
+        if (ret != LEPT_PARSE_OK) {
+            return ret;
+        }
+    }
+    return LEPT_PARSE_OK;
+}
+
+/* 输入结束 相当于一次性解析读到了'\0'*/
+static int lept_push_eof(lept_push_parser* p) {
+    int ret;
+    switch (p->state) {
+        case LEPT_PUSH_VALUE:
+        case LEPT_PUSH_FIRST_VALUE: return LEPT_PARSE_EXPECT_VALUE;
+        case LEPT_PUSH_FIRST_KEY:
+        case LEPT_PUSH_KEY: return LEPT_PARSE_MISS_KEY;
+        case LEPT_PUSH_COLON: return LEPT_PARSE_MISS_COLON;
+        case LEPT_PUSH_NEXT:
+            return LEPT_PUSH_TOP(p)->object ? LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET : LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
+        case LEPT_PUSH_END: return LEPT_PARSE_OK;
+        case LEPT_PUSH_LITERAL: return LEPT_PARSE_INVALID_VALUE;
+        case LEPT_PUSH_NUMBER:
+            if ((ret = lept_push_number_end(p)) != LEPT_PARSE_OK) {
+                return ret;
+            }
+            return lept_push_eof(p);
+        default:
+            /* 没有结束的字符串 不可能解析成功*/
+            ret = lept_push_string_end(p);
+            assert(ret != LEPT_PARSE_OK);
+            return ret;
+    }
+}
+
+int lept_push_feed(lept_push_parser* p, const char* chunk, size_t len) {
+    assert(p != NULL && (chunk != NULL || len == 0));
+    if (p->ret == LEPT_PARSE_OK && len) {
+        p->ret = lept_push_run(p, chunk, chunk + len);
+    }
+    return p->ret;
+}
+
+/* 释放建立了一半的DOM*/
+static void lept_push_clear(lept_push_parser* p) {
+    if (p->v) {
+        while (p->c.top > 0) {
+            lept_free((lept_value*)lept_context_pop(&p->c, sizeof(lept_value)));
+        }
+    }
+}
+
+int lept_push_finish(lept_push_parser* p) {
+    assert(p != NULL);
+    if (p->ret == LEPT_PARSE_OK) {
+        p->ret = lept_push_eof(p);
+    }
+    if (p->v && p->ret == LEPT_PARSE_OK) {
+        assert(p->c.top == sizeof(lept_value));
+        memcpy(p->v, lept_context_pop(&p->c, sizeof(lept_value)), sizeof(lept_value));
+    }
+    lept_push_clear(p);
+    return p->ret;
+}
+
+void lept_push_parser_free(lept_push_parser* p) {
+    if (p == NULL) {
+        return;
+    }
+    lept_push_clear(p);
+    LEPT_FREE_WITH(p->c.allocator, p->c.stack);
+    LEPT_FREE_WITH(p->tok.allocator, p->tok.stack);
+    LEPT_FREE_WITH(p->frames.allocator, p->frames.stack);
+    LEPT_FREE(p);
+}
+
+/*
+    tape文档：整个文档是一段连续的64位字 高8位是类型 低56位是内容
+    null/false/true占一个字 数字占两个字(第二个字是double的位模式)
+    字符串占一个字 内容是字符串区中的偏移 那里依次存放长度(size_t)、内容和'\0'
+    数组和对象的起始字的内容是结束字之后的位置 越过整个容器是O(1)的
+    结束字的内容是元素或成员个数 对象的成员依次是键(字符串)和值
+*/
+#define LEPT_TAPE_END 7
+#define LEPT_TAPE_WORD(tag, payload) ((uint64_t)(tag) << 56 | (uint64_t)(payload))
+#define LEPT_TAPE_TAG(w) ((unsigned)((w) >> 56))
+#define LEPT_TAPE_PAYLOAD(w) ((size_t)((w) & (((uint64_t)1 << 56) - 1)))
+
+struct lept_tape {
+    lept_context c; /* 解析用的上下文 栈在多次解析之间复用*/
+    lept_context words; /* tape*/
+    lept_context strings; /* 字符串区*/
+    lept_context frames; /* 建立时还没有结束的数组和对象的起始位置*/
+    void* map; /* 从快照加载时words和strings指向这段只读内存 否则为NULL*/
+    size_t map_size;
+};
+
+#define LEPT_TAPE_AT(t, pos) (((const uint64_t*)(t)->words.stack)[pos])
+
+static int lept_tape_put(lept_tape* t, unsigned tag, size_t payload) {
+    uint64_t w = LEPT_TAPE_WORD(tag, payload);
+    memcpy(lept_context_push(&t->words, sizeof(uint64_t)), &w, sizeof(uint64_t));
+    return 0;
+}
+
+static int lept_tape_null(void* ctx) {
+    return lept_tape_put((lept_tape*)ctx, LEPT_NULL, 0);
+}
+
+static int lept_tape_bool(void* ctx, int b) {
+    return lept_tape_put((lept_tape*)ctx, b ? LEPT_TRUE : LEPT_FALSE, 0);
+}
+
+static int lept_tape_number(void* ctx, double n) {
+    lept_tape* t = (lept_tape*)ctx;
+    lept_tape_put(t, LEPT_NUMBER, 0);
+    memcpy(lept_context_push(&t->words, sizeof(double)), &n, sizeof(double));
+    return 0;
+}
+
+/* 字符串值和键都用这个函数*/
+static int lept_tape_string(void* ctx, const char* s, size_t len) {
+    lept_tape* t = (lept_tape*)ctx;
+    size_t offset = t->strings.top;
+    char* p = (char*)lept_context_push(&t->strings, sizeof(size_t) + len + 1);
+    memcpy(p, &len, sizeof(size_t));
+    memcpy(p + sizeof(size_t), s, len + 1);
+    return lept_tape_put(t, LEPT_STRING, offset);
+}
+
+static int lept_tape_start(lept_tape* t, lept_type type) {
+    *(size_t*)lept_context_push(&t->frames, sizeof(size_t)) = t->words.top / sizeof(uint64_t);
+    return lept_tape_put(t, type, 0);
+}
+
+/* 写入结束字 回填起始字中越过容器之后的位置*/
+static int lept_tape_end(lept_tape* t, size_t size) {
+    size_t start = *(size_t*)lept_context_pop(&t->frames, sizeof(size_t));
+    uint64_t* w;
+    lept_tape_put(t, LEPT_TAPE_END, size);
+    w = (uint64_t*)t->words.stack + start;
+    *w = LEPT_TAPE_WORD(LEPT_TAPE_TAG(*w), t->words.top / sizeof(uint64_t));
+    return 0;
+}
+
+static int lept_tape_start_array(void* ctx) {
+    return lept_tape_start((lept_tape*)ctx, LEPT_ARRAY);
+}
+
+static int lept_tape_start_object(void* ctx) {
+    return lept_tape_start((lept_tape*)ctx, LEPT_OBJECT);
+}
+
+static int lept_tape_end_container(void* ctx, size_t size) {
+    return lept_tape_end((lept_tape*)ctx, size);
+}
+
+static const lept_handler lept_tape_handler = {
+    lept_tape_null, lept_tape_bool, lept_tape_number, lept_tape_string,
+    lept_tape_start_array, lept_tape_end_container, lept_tape_start_object, lept_tape_string, lept_tape_end_container
+};
+
+lept_tape* lept_tape_new(void) {
+    lept_tape* t = (lept_tape*)LEPT_MALLOC(sizeof(lept_tape));
+    lept_push_context_init(&t->c, &lept_tape_handler, t);
+    lept_push_context_init(&t->words, NULL, NULL);
+    lept_push_context_init(&t->strings, NULL, NULL);
+    lept_push_context_init(&t->frames, NULL, NULL);
+    t->map = NULL;
+    t->map_size = 0;
+    return t;
+}
+
+static void lept_binary_release(void* p, size_t size);
+
+/* 丢弃加载的快照 之后的解析使用自己的缓冲区*/
+static void lept_tape_unmap(lept_tape* t) {
+    if (t->map) {
+        lept_binary_release(t->map, t->map_size);
+        t->map = NULL;
+        lept_push_context_init(&t->words, NULL, NULL);
+        lept_push_context_init(&t->strings, NULL, NULL);
+    }
+}
+
+/*
+    解析到tape 之前的内容被丢弃 缓冲区保留给这一次使用
+*/
+int lept_tape_parse(lept_tape* t, const char* json, size_t len) {
+    int ret;
+    assert(t != NULL && (json != NULL || len == 0));
+    lept_tape_unmap(t);
+    t->words.top = t->strings.top = t->frames.top = 0;
+    if ((ret = lept_parse_document(&t->c, json, len)) != LEPT_PARSE_OK) {
+        t->words.top = t->strings.top = t->frames.top = 0;
+    }
+    return ret;
+}
+
+void lept_tape_free(lept_tape* t) {
+    if (t == NULL) {
+        return;
+    }
+    lept_tape_unmap(t);
+    LEPT_FREE_WITH(t->c.allocator, t->c.stack);
+    LEPT_FREE_WITH(t->words.allocator, t->words.stack);
+    LEPT_FREE_WITH(t->strings.allocator, t->strings.stack);
+    LEPT_FREE_WITH(t->frames.allocator, t->frames.stack);
+    LEPT_FREE(t);
+}
+
+lept_cursor lept_tape_root(const lept_tape* t) {
+    lept_cursor c;
+    assert(t != NULL && t->words.top > 0);
+    c.tape = t;
+    c.pos = 0;
+    return c;
+}
+
+lept_type lept_cursor_get_type(const lept_cursor* c) {
+    assert(c != NULL && c->tape != NULL);
+    return (lept_type)LEPT_TAPE_TAG(LEPT_TAPE_AT(c->tape, c->pos));
+}
+
+/* 越过c处的值 数字占两个字 容器直接跳到结束字之后*/
+lept_cursor lept_cursor_next(const lept_cursor* c) {
+    lept_cursor n = *c;
+    uint64_t w = LEPT_TAPE_AT(c->tape, c->pos);
+    switch (LEPT_TAPE_TAG(w)) {
+        case LEPT_NUMBER: n.pos += 2; break;
+        case LEPT_ARRAY:
+        case LEPT_OBJECT: n.pos = LEPT_TAPE_PAYLOAD(w); break;
+        default: n.pos++; break;
+    }
+    return n;
+}
+
+int lept_cursor_get_boolean(const lept_cursor* c) {
+    lept_type type = lept_cursor_get_type(c);
+    assert(type == LEPT_TRUE || type == LEPT_FALSE);
+    return type == LEPT_TRUE;
+}
+
+double lept_cursor_get_number(const lept_cursor* c) {
+    double n;
+    assert(lept_cursor_get_type(c) == LEPT_NUMBER);
+    memcpy(&n, &LEPT_TAPE_AT(c->tape, c->pos + 1), sizeof(double));
+    return n;
+}
+
+/* 字符串在字符串区中的位置 长度在它之前*/
+static const char* lept_cursor_string(const lept_cursor* c, size_t* len) {
+    const char* p;
+    assert(lept_cursor_get_type(c) == LEPT_STRING);
+    p = c->tape->strings.stack + LEPT_TAPE_PAYLOAD(LEPT_TAPE_AT(c->tape, c->pos));
+    memcpy(len, p, sizeof(size_t));
+    return p + sizeof(size_t);
+}
+
+const char* lept_cursor_get_string(const lept_cursor* c) {
+    size_t len;
+    return lept_cursor_string(c, &len);
+}
+
+size_t lept_cursor_get_string_length(const lept_cursor* c) {
+    size_t len;
+    lept_cursor_string(c, &len);
+    return len;
+}
+
+/* 结束字就在越过容器之后的位置前面*/
+static size_t lept_cursor_container_size(const lept_cursor* c) {
+    return LEPT_TAPE_PAYLOAD(LEPT_TAPE_AT(c->tape, LEPT_TAPE_PAYLOAD(LEPT_TAPE_AT(c->tape, c->pos)) - 1));
+}
+
+size_t lept_cursor_get_array_size(const lept_cursor* c) {
+    assert(lept_cursor_get_type(c) == LEPT_ARRAY);
+    return lept_cursor_container_size(c);
+}
+
+lept_cursor lept_cursor_get_array_element(const lept_cursor* c, size_t index) {
+    lept_cursor e = *c;
+    assert(index < lept_cursor_get_array_size(c));
+    e.pos++;
+    while (index--) {
+        e = lept_cursor_next(&e);
+    }
+    return e;
+}
+
+size_t lept_cursor_get_object_size(const lept_cursor* c) {
+    assert(lept_cursor_get_type(c) == LEPT_OBJECT);
+    return lept_cursor_container_size(c);
+}
+
+/* 第index个成员的键*/
+static lept_cursor lept_cursor_member(const lept_cursor* c, size_t index) {
+    lept_cursor k = *c;
+    assert(index < lept_cursor_get_object_size(c));
+    k.pos++;
+    while (index--) {
+        k.pos++;
+        k = lept_cursor_next(&k);
+    }
+    return k;
+}
+
+const char* lept_cursor_get_object_key(const lept_cursor* c, size_t index) {
+    lept_cursor k = lept_cursor_member(c, index);
+    return lept_cursor_get_string(&k);
+}
+
+size_t lept_cursor_get_object_key_length(const lept_cursor* c, size_t index) {
+    lept_cursor k = lept_cursor_member(c, index);
+    return lept_cursor_get_string_length(&k);
+}
+
+lept_cursor lept_cursor_get_object_value(const lept_cursor* c, size_t index) {
+    lept_cursor k = lept_cursor_member(c, index);
+    k.pos++;
+    return k;
+}
+
+/* 找不到时返回的游标tape为NULL*/
+lept_cursor lept_cursor_find_object_value(const lept_cursor* c, const char* key, size_t klen) {
+    lept_cursor k = *c;
+    size_t i, size = lept_cursor_get_object_size(c), len;
+    k.pos++;
+    for (i = 0; i < size; i++) {
+        const char* s = lept_cursor_string(&k, &len);
+        k.pos++;
+        if (len == klen && memcmp(s, key, klen) == 0) {
+            return k;
+        }
+        k = lept_cursor_next(&k);
+    }
+    k.tape = NULL;
+    return k;
+}
+
+/*
+    二进制快照：文件头之后依次是tape的字和字符串区 与内存中的布局完全相同
+    tape中只有偏移没有指针 加载时映射整个文件 检查文件头和所有的偏移 不需要解析或复制
+    字和长度按写入时的字节序和size_t保存 文件头记录了这些 不一致的文件拒绝加载
+*/
+#define LEPT_BINARY_VERSION 1
+#define LEPT_BINARY_ORDER 0x01020304u
+
+typedef struct {
+    char magic[8]; /* "LEPTTAPE"*/
+    uint32_t version;
+    uint32_t order; /* 写入LEPT_BINARY_ORDER 读回的值不同说明字节序不同*/
+    uint32_t size_bytes; /* sizeof(size_t)*/
+    uint32_t reserved;
+    uint64_t words; /* tape的字数*/
+    uint64_t strings; /* 字符串区的字节数*/
+} lept_binary_header;
+
+static void lept_tape_value(lept_tape* t, const lept_value* v) {
+    lept_walk k;
+    lept_walk_frame* f;
+    const lept_member* m;
+    lept_walk_init(&k);
+    for (;;) {
+        LEPT_EXPAND(v);
+        switch (v->type) {
+            case LEPT_NULL: lept_tape_null(t); break;
+            case LEPT_FALSE: lept_tape_bool(t, 0); break;
+            case LEPT_TRUE: lept_tape_bool(t, 1); break;
+            case LEPT_NUMBER: lept_tape_number(t, v->u.n); break;
+            case LEPT_STRING: lept_tape_string(t, LEPT_STRING_PTR(v), LEPT_STRING_LEN(v)); break;
+            case LEPT_ARRAY:
+            case LEPT_OBJECT:
+                lept_tape_start(t, v->type);
+                lept_walk_push(&k, v, NULL);
+                break;
+            default: assert(0 && "invalid type");
+        }
+        /* 下一个子结点 结束的容器写入结束字*/
+        for (;;) {
+            if (k.depth == 0) {
+                lept_walk_free(&k);
+                return;
+            }
+            f = LEPT_WALK_TOP(&k);
+            if (f->v->type == LEPT_ARRAY && f->i < f->v->u.a.size) {
+                v = &f->v->u.a.e[f->i++];
+                break;
+            }
+            if (f->v->type == LEPT_OBJECT && f->i < f->v->u.o.size) {
+                m = &f->v->u.o.m[f->i++];
+                lept_tape_string(t, LEPT_MEMBER_KEY(m), LEPT_MEMBER_KLEN(m));
+                v = &m->val;
+                break;
+            }
+            lept_tape_end(t, f->i);
+            k.depth--;
+        }
+    }
+}
+
+/*
+    把v转成tape后写入文件
+*/
+int lept_save_binary(const lept_value* v, const char* path) {
+    lept_tape* t;
+    lept_binary_header h;
+    FILE* fp;
+    int ok;
+    assert(v != NULL && path != NULL);
+    if ((fp = fopen(path, "wb")) == NULL) {
+        return LEPT_PARSE_FILE_ERROR;
+    }
+    t = lept_tape_new();
+    lept_tape_value(t, v);
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "LEPTTAPE", 8);
+    h.version = LEPT_BINARY_VERSION;
+    h.order = LEPT_BINARY_ORDER;
+    h.size_bytes = (uint32_t)sizeof(size_t);
+    h.words = t->words.top / sizeof(uint64_t);
+    h.strings = t->strings.top;
+    ok = fwrite(&h, sizeof(h), 1, fp) == 1
+        && fwrite(t->words.stack, 1, t->words.top, fp) == t->words.top
+        && (t->strings.top == 0 || fwrite(t->strings.stack, 1, t->strings.top, fp) == t->strings.top);
+    ok = fclose(fp) == 0 && ok;
+    lept_tape_free(t);
+    return ok ? LEPT_PARSE_OK : LEPT_PARSE_FILE_ERROR;
+}
+
+static void lept_binary_release(void* p, size_t size) {
+#ifdef LEPT_HAVE_MMAP
+    munmap(p, size);
+#else
+    (void)size;
+    LEPT_FREE(p);
+#endif
+}
+
+/*
+    检查加载的tape 之后游标的访问不再做边界检查 所以这里遍历一次所有的字:
+    根值正好占满整个tape 字符串的偏移和长度都在字符串区内并以'\0'结尾
+    每个容器的起始字指向它的结束字之后 结束字中的个数与实际的元素个数相同 对象的键都是字符串
+    frames中每个还没有结束的容器占两个size_t: 起始位置和已经遇到的值(对象中键和值分别计数)
+*/
+static int lept_binary_validate(lept_tape* t) {
+    size_t pos, n = t->words.top / sizeof(uint64_t), off, len, items, *frame;
+    uint64_t w;
+    for (pos = 0; pos < n; ) {
+        w = LEPT_TAPE_AT(t, pos);
+        if (LEPT_TAPE_TAG(w) == LEPT_TAPE_END) {
+            if (t->frames.top == 0) {
+                return 0;
+            }
+            frame = (size_t*)lept_context_pop(&t->frames, 2 * sizeof(size_t));
+            items = frame[1];
+            if (LEPT_TAPE_TAG(LEPT_TAPE_AT(t, frame[0])) == LEPT_OBJECT) {
+                if (items % 2 != 0) {
+                    return 0;
+                }
+                items /= 2;
+            }
+            if (LEPT_TAPE_PAYLOAD(LEPT_TAPE_AT(t, frame[0])) != pos + 1 || LEPT_TAPE_PAYLOAD(w) != items) {
+                return 0;
+            }
+            pos++;
+            continue;
+        }
+        /* 根值之后不能再有值*/
+        if (t->frames.top == 0 && pos != 0) {
+            return 0;
+        }
+        if (t->frames.top != 0) {
+            frame = (size_t*)(void*)(t->frames.stack + t->frames.top - 2 * sizeof(size_t));
+            if (LEPT_TAPE_TAG(LEPT_TAPE_AT(t, frame[0])) == LEPT_OBJECT && frame[1] % 2 == 0 && LEPT_TAPE_TAG(w) != LEPT_STRING) {
+                return 0;
+            }
+            frame[1]++;
+        }
+        switch (LEPT_TAPE_TAG(w)) {
+            case LEPT_NULL: case LEPT_FALSE: case LEPT_TRUE:
+                pos++;
+                break;
+            case LEPT_NUMBER:
+                if (n - pos < 2) {
+                    return 0;
+                }
+                pos += 2;
+                break;
+            case LEPT_STRING:
+                off = LEPT_TAPE_PAYLOAD(w);
+                if (off > t->strings.top || t->strings.top - off < sizeof(size_t) + 1) {
+                    return 0;
+                }
+                memcpy(&len, t->strings.stack + off, sizeof(size_t));
+                if (len > t->strings.top - off - sizeof(size_t) - 1 || t->strings.stack[off + sizeof(size_t) + len] != '\0') {
+                    return 0;
+                }
+                pos++;
+                break;
+            case LEPT_ARRAY: case LEPT_OBJECT:
+                if (LEPT_TAPE_PAYLOAD(w) <= pos + 1 || LEPT_TAPE_PAYLOAD(w) > n) {
+                    return 0;
+                }
+                frame = (size_t*)lept_context_push(&t->frames, 2 * sizeof(size_t));
+                frame[0] = pos++;
+                frame[1] = 0;
+                break;
+            default:
+                return 0;
+        }
+    }
+    return t->frames.top == 0;
+}
+
+/*
+    检查文件头和文件大小 再检查整个tape 成功时tape的两个区直接指向p 不解析也不复制
+*/
+static lept_tape* lept_binary_attach(void* p, size_t size) {
+    lept_binary_header h;
+    lept_tape* t;
+    uint64_t rest = size - sizeof(h);
+    memcpy(&h, p, sizeof(h));
+    if (memcmp(h.magic, "LEPTTAPE", 8) != 0 || h.version != LEPT_BINARY_VERSION || h.order != LEPT_BINARY_ORDER ||
+        h.size_bytes != sizeof(size_t) || h.words == 0 || h.words > rest / sizeof(uint64_t) ||
+        h.strings != rest - h.words * sizeof(uint64_t)) {
+        lept_binary_release(p, size);
+        return NULL;
+    }
+    t = lept_tape_new();
+    t->map = p;
+    t->map_size = size;
+    t->words.stack = (char*)p + sizeof(h);
+    t->words.size = t->words.top = (size_t)h.words * sizeof(uint64_t);
+    t->words.fixed = 1;
+    t->strings.stack = t->words.stack + t->words.top;
+    t->strings.size = t->strings.top = (size_t)h.strings;
+    t->strings.fixed = 1;
+    if (!lept_binary_validate(t)) {
+        lept_tape_free(t);
+        return NULL;
+    }
+    t->frames.top = 0;
+    return t;
+}
+
+/*
+    加载快照 POSIX系统上只读映射文件 其他系统读入内存
+*/
+lept_tape* lept_load_binary(const char* path) {
+#ifdef LEPT_HAVE_MMAP
+    int fd;
+    struct stat st;
+    void* p;
+    assert(path != NULL);
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < sizeof(lept_binary_header)) {
+        close(fd);
+        return NULL;
+    }
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return NULL;
+    }
+    return lept_binary_attach(p, (size_t)st.st_size);
+#else
+    FILE* fp;
+    char* buf;
+    long size;
+    assert(path != NULL);
+    if ((fp = fopen(path, "rb")) == NULL) {
+        return NULL;
+    }
+    if (fseek(fp, 0, SEEK_END) != 0 || (size = ftell(fp)) < (long)sizeof(lept_binary_header) || fseek(fp, 0, SEEK_SET) != 0) {
+        fclose(fp);
+        return NULL;
+    }
+    buf = (char*)LEPT_MALLOC((size_t)size);
+    if (fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+        fclose(fp);
+        LEPT_FREE(buf);
+        return NULL;
+    }
+    fclose(fp);
+    return lept_binary_attach(buf, (size_t)size);
+#endif
+}
+
+/*
+    Grisu2: 求出能够准确读回的最短十进制表示
+    diy_fp是一个64位尾数和二进制指数 值为f * 2^e
+*/
+typedef struct {
+    uint64_t f;
+    int e;
+} lept_diyfp;
+
+#define LEPT_DP_SIGNIFICAND_MASK (((uint64_t)1 << 52) - 1)
+#define LEPT_DP_HIDDEN_BIT ((uint64_t)1 << 52)
+#define LEPT_DP_EXPONENT_BIAS (0x3FF + 52)
+
+/* 10^k的近似值 k = -348 + 8 * i 尾数已经规格化*/
+static const uint64_t lept_cached_powers_f[] = {
+    0xfa8fd5a0081c0288, 0xbaaee17fa23ebf76, 0x8b16fb203055ac76, 0xcf42894a5dce35ea,
+    0x9a6bb0aa55653b2d, 0xe61acf033d1a45df, 0xab70fe17c79ac6ca, 0xff77b1fcbebcdc4f,
+    0xbe5691ef416bd60c, 0x8dd01fad907ffc3c, 0xd3515c2831559a83, 0x9d71ac8fada6c9b5,
+    0xea9c227723ee8bcb, 0xaecc49914078536d, 0x823c12795db6ce57, 0xc21094364dfb5637,
+    0x9096ea6f3848984f, 0xd77485cb25823ac7, 0xa086cfcd97bf97f4, 0xef340a98172aace5,
+    0xb23867fb2a35b28e, 0x84c8d4dfd2c63f3b, 0xc5dd44271ad3cdba, 0x936b9fcebb25c996,
+    0xdbac6c247d62a584, 0xa3ab66580d5fdaf6, 0xf3e2f893dec3f126, 0xb5b5ada8aaff80b8,
+    0x87625f056c7c4a8b, 0xc9bcff6034c13053, 0x964e858c91ba2655, 0xdff9772470297ebd,
+    0xa6dfbd9fb8e5b88f, 0xf8a95fcf88747d94, 0xb94470938fa89bcf, 0x8a08f0f8bf0f156b,
+    0xcdb02555653131b6, 0x993fe2c6d07b7fac, 0xe45c10c42a2b3b06, 0xaa242499697392d3,
+    0xfd87b5f28300ca0e, 0xbce5086492111aeb, 0x8cbccc096f5088cc, 0xd1b71758e219652c,
+    0x9c40000000000000, 0xe8d4a51000000000, 0xad78ebc5ac620000, 0x813f3978f8940984,
+    0xc097ce7bc90715b3, 0x8f7e32ce7bea5c70, 0xd5d238a4abe98068, 0x9f4f2726179a2245,
+    0xed63a231d4c4fb27, 0xb0de65388cc8ada8, 0x83c7088e1aab65db, 0xc45d1df942711d9a,
+    0x924d692ca61be758, 0xda01ee641a708dea, 0xa26da3999aef774a, 0xf209787bb47d6b85,
+    0xb454e4a179dd1877, 0x865b86925b9bc5c2, 0xc83553c5c8965d3d, 0x952ab45cfa97a0b3,
+    0xde469fbd99a05fe3, 0xa59bc234db398c25, 0xf6c69a72a3989f5c, 0xb7dcbf5354e9bece,
+    0x88fcf317f22241e2, 0xcc20ce9bd35c78a5, 0x98165af37b2153df, 0xe2a0b5dc971f303a,
+    0xa8d9d1535ce3b396, 0xfb9b7cd9a4a7443c, 0xbb764c4ca7a44410, 0x8bab8eefb6409c1a,
+    0xd01fef10a657842c, 0x9b10a4e5e9913129, 0xe7109bfba19c0c9d, 0xac2820d9623bf429,
+    0x80444b5e7aa7cf85, 0xbf21e44003acdd2d, 0x8e679c2f5e44ff8f, 0xd433179d9c8cb841,
+    0x9e19db92b4e31ba9, 0xeb96bf6ebadf77d9, 0xaf87023b9bf0ee6b,
+};
+
+static const short lept_cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const char lept_digits_lut[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static lept_diyfp lept_diyfp_make(uint64_t f, int e) {
+    lept_diyfp r;
+    r.f = f;
+    r.e = e;
+    return r;
+}
+
+/* 四舍五入取128位乘积的高64位*/
+static lept_diyfp lept_diyfp_mul(lept_diyfp a, lept_diyfp b) {
+    uint64_t hi, lo = lept_mul128(a.f, b.f, &hi);
+    return lept_diyfp_make(hi + (lo >> 63), a.e + b.e + 64);
+}
+
+static lept_diyfp lept_diyfp_normalize(lept_diyfp a) {
+    int s = lept_clz64(a.f);
+    return lept_diyfp_make(a.f << s, a.e - s);
+}
+
+/* v和相邻double的中点m-和m+ 规格化后指数相同*/
+static void lept_diyfp_boundaries(lept_diyfp v, lept_diyfp* minus, lept_diyfp* plus) {
+    lept_diyfp pl = lept_diyfp_normalize(lept_diyfp_make((v.f << 1) + 1, v.e - 1));
+    lept_diyfp mi = (v.f == LEPT_DP_HIDDEN_BIT) ?
+        lept_diyfp_make((v.f << 2) - 1, v.e - 2) : lept_diyfp_make((v.f << 1) - 1, v.e - 1);
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+    *plus = pl;
+    *minus = mi;
+}
+
+/* 选一个10^-K 使乘积的二进制指数落在[-60, -32]内*/
+static lept_diyfp lept_cached_power(int e, int* K) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int k = (int)dk;
+    unsigned index;
+    if (dk - k > 0.0) {
+        k++;
+    }
+    index = (unsigned)((k >> 3) + 1);
+    *K = -(-348 + (int)(index << 3));
+    return lept_diyfp_make(lept_cached_powers_f[index], lept_cached_powers_e[index]);
+}
+
+/* 在不越出区间的前提下 把最后一位朝w调整*/
+static void lept_grisu_round(char* buffer, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buffer[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static int lept_count_digits32(uint32_t n) {
+    int d = 1;
+    while (n >= 10) {
+        n /= 10;
+        d++;
+    }
+    return d;
+}
+
+static void lept_grisu_digits(lept_diyfp W, lept_diyfp Mp, uint64_t delta, char* buffer, int* len, int* K) {
+    static const uint64_t pow10[] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+        1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+        100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+        1000000000000000000ULL, 10000000000000000000ULL
+    };
+    const int shift = -Mp.e;
+    const uint64_t one = (uint64_t)1 << shift;
+    const uint64_t wp_w = Mp.f - W.f;
+    uint32_t p1 = (uint32_t)(Mp.f >> shift);
+    uint64_t p2 = Mp.f & (one - 1);
+    int kappa = lept_count_digits32(p1);
+    *len = 0;
+    /* 整数部分*/
+    while (kappa > 0) {
+        uint32_t d = p1 / (uint32_t)pow10[kappa - 1];
+        p1 %= (uint32_t)pow10[kappa - 1];
+        if (d || *len) {
+            buffer[(*len)++] = (char)('0' + d);
+        }
+        kappa--;
+        if ((((uint64_t)p1) << shift) + p2 <= delta) {
+            *K += kappa;
+            lept_grisu_round(buffer, *len, delta, (((uint64_t)p1) << shift) + p2, pow10[kappa] << shift, wp_w);
+            return;
+        }
+    }
+    /* 小数部分*/
+    for (;;) {
+        char d;
+        p2 *= 10;
+        delta *= 10;
+        d = (char)(p2 >> shift);
+        if (d || *len) {
+            buffer[(*len)++] = (char)('0' + d);
+        }
+        p2 &= one - 1;
+        kappa--;
+        if (p2 < delta) {
+            *K += kappa;
+            lept_grisu_round(buffer, *len, delta, p2, one, wp_w * (-kappa < 20 ? pow10[-kappa] : 0));
+            return;
+        }
+    }
+}
+
+/* 正的有限数 buffer中得到不含小数点的数字串 值为buffer * 10^K*/
+static void lept_grisu2(double d, char* buffer, int* len, int* K) {
+    lept_diyfp v, w_m, w_p, c_mk, W, Wp, Wm;
+    uint64_t u;
+    int biased_e;
+    memcpy(&u, &d, sizeof(u));
+    biased_e = (int)((u >> 52) & 0x7FF);
+    if (biased_e != 0) {
+        v = lept_diyfp_make((u & LEPT_DP_SIGNIFICAND_MASK) + LEPT_DP_HIDDEN_BIT, biased_e - LEPT_DP_EXPONENT_BIAS);
+    }
+    else {
+        v = lept_diyfp_make(u & LEPT_DP_SIGNIFICAND_MASK, 1 - LEPT_DP_EXPONENT_BIAS);
+    }
+    lept_diyfp_boundaries(v, &w_m, &w_p);
+    c_mk = lept_cached_power(w_p.e, K);
+    W = lept_diyfp_mul(lept_diyfp_normalize(v), c_mk);
+    Wp = lept_diyfp_mul(w_p, c_mk);
+    Wm = lept_diyfp_mul(w_m, c_mk);
+    Wm.f++;
+    Wp.f--;
+    lept_grisu_digits(W, Wp, Wp.f - Wm.f, buffer, len, K);
+}
+
+static char* lept_write_exponent(int K, char* p) {
+    if (K < 0) {
+        *p++ = '-';
+        K = -K;
+    }
+    if (K >= 100) {
+        *p++ = (char)('0' + K / 100);
+        K %= 100;
+        *p++ = lept_digits_lut[K * 2];
+        *p++ = lept_digits_lut[K * 2 + 1];
+    }
+    else if (K >= 10) {
+        *p++ = lept_digits_lut[K * 2];
+        *p++ = lept_digits_lut[K * 2 + 1];
+    }
+    else {
+        *p++ = (char)('0' + K);
+    }
+    return p;
+}
+
+/* 把数字串和指数排成JSON数字 整数不带小数点 太大或太小时用科学计数法*/
+static char* lept_prettify(char* buffer, int length, int k) {
+    const int kk = length + k; /* 10^(kk-1) <= v < 10^kk */
+    int i;
+    if (0 <= k && kk <= 21) {
+        /* 1234e7 -> 12340000000 */
+        for (i = length; i < kk; i++) {
+            buffer[i] = '0';
+        }
+        return &buffer[kk];
+    }
+    else if (0 < kk && kk <= 21) {
+        /* 1234e-2 -> 12.34 */
+        memmove(&buffer[kk + 1], &buffer[kk], (size_t)(length - kk));
+        buffer[kk] = '.';
+        return &buffer[length + 1];
+    }
+    else if (-6 < kk && kk <= 0) {
+        /* 1234e-6 -> 0.001234 */
+        const int offset = 2 - kk;
+        memmove(&buffer[offset], &buffer[0], (size_t)length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for (i = 2; i < offset; i++) {
+            buffer[i] = '0';
+        }
+        return &buffer[length + offset];
+    }
+    else if (length == 1) {
+        /* 1e30 */
+        buffer[1] = 'e';
+        return lept_write_exponent(kk - 1, &buffer[2]);
+    }
+    else {
+        /* 1234e30 -> 1.234e33 */
+        memmove(&buffer[2], &buffer[1], (size_t)(length - 1));
+        buffer[1] = '.';
+        buffer[length + 1] = 'e';
+        return lept_write_exponent(kk - 1, &buffer[length + 2]);
+    }
+}
+
+/* 最长的输出是"-1.2345678901234567e-308" 返回写入的长度*/
+#define LEPT_NUMBER_BUFFER_SIZE 32
+
+static size_t lept_format_number(char* buffer, double d) {
+    char* p = buffer;
+    int length, K;
+    if (d == 0.0) {
+        if (signbit(d)) {
+            *p++ = '-';
+        }
+        *p++ = '0';
+        return (size_t)(p - buffer);
+    }
+    if (d < 0) {
+        *p++ = '-';
+        d = -d;
+    }
+    lept_grisu2(d, p, &length, &K);
+    return (size_t)(lept_prettify(p, length, K) - buffer);
+}
+
+
+/*
+    输出字符串 不需要转义的连续字节整段复制
+*/
+static void lept_stringify_string(lept_context* c, const char* s, size_t len) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+    const char* end = s + len;
+    const char* q;
+    PUTC(c, '\"');
+    for (;;) {
+        unsigned char ch;
+        char* p;
+        q = c->kernels->scan_string(s, end);
+        if (q != s) {
+            PUTS(c, s, (size_t)(q - s));
+        }
+        if (q == end) {
+            break;
+        }
+        switch (ch = (unsigned char)*q) {
+            case '\"': PUTS(c, "\\\"", 2); break;
+            case '\\': PUTS(c, "\\\\", 2); break;
+            case '\b': PUTS(c, "\\b", 2); break;
+            case '\f': PUTS(c, "\\f", 2); break;
+            case '\n': PUTS(c, "\\n", 2); break;
+            case '\r': PUTS(c, "\\r", 2); break;
+            case '\t': PUTS(c, "\\t", 2); break;
+            default:
+                p = (char*)lept_context_push(c, 6);
+                memcpy(p, "\\u00", 4);
+                p[4] = hex_digits[ch >> 4];
+                p[5] = hex_digits[ch & 15];
+        }
+        s = q + 1;
+    }
+    PUTC(c, '\"');
+}
+
+static void lept_stringify_value(lept_context* c, const lept_value* v) {
+    lept_walk k;
+    lept_walk_frame* f;
+    const lept_member* m;
+    lept_walk_init(&k);
+    for (;;) {
+        LEPT_EXPAND(v);
+        switch (v->type) {
+            case LEPT_NULL:   PUTS(c, "null",  4); break;
+            case LEPT_FALSE:  PUTS(c, "false", 5); break;
+            case LEPT_TRUE:   PUTS(c, "true",  4); break;
+            case LEPT_NUMBER:
+                /* JSON不能表示无穷和NaN 输出null*/
+                if (v->u.n - v->u.n != 0.0) {
+                    PUTS(c, "null", 4);
+                }
+                else {
+                    char buffer[LEPT_NUMBER_BUFFER_SIZE];
+                    size_t n = lept_format_number(buffer, v->u.n);
+                    PUTS(c, buffer, n);
+                }
+                break;
+            case LEPT_STRING: lept_stringify_string(c, LEPT_STRING_PTR(v), LEPT_STRING_LEN(v)); break;
+            case LEPT_ARRAY:
+            case LEPT_OBJECT:
+                PUTC(c, v->type == LEPT_ARRAY ? '[' : '{');
+                lept_walk_push(&k, v, NULL);
+                break;
+            default: assert(0 && "invalid type");
+        }
+        /* 下一个要输出的值 结束的容器输出右括号*/
+        for (;;) {
+            if (k.depth == 0) {
+                lept_walk_free(&k);
+                return;
+            }
+            f = LEPT_WALK_TOP(&k);
+            if (f->v->type == LEPT_ARRAY) {
+                if (f->i < f->v->u.a.size) {
+                    if (f->i > 0) {
+                        PUTC(c, ',');
+                    }
+                    v = &f->v->u.a.e[f->i++];
+                    break;
+                }
+                PUTC(c, ']');
+            }
+            else {
+                if (f->i < f->v->u.o.size) {
+                    if (f->i > 0) {
+                        PUTC(c, ',');
+                    }
+                    m = &f->v->u.o.m[f->i++];
+                    lept_stringify_string(c, LEPT_MEMBER_KEY(m), LEPT_MEMBER_KLEN(m));
+                    PUTC(c, ':');
+                    v = &m->val;
+                    break;
+                }
+                PUTC(c, '}');
+            }
+            k.depth--;
+        }
+    }
+}
+
+/*
+    生成JSON文本 返回的缓冲区以'\0'结尾 由调用者用全局分配器释放
+*/
+char* lept_stringify(const lept_value* v, size_t* length) {
+    lept_context c;
+    assert(v != NULL);
+    c.stack = NULL;
+    c.size = c.top = 0;
+    c.kernels = lept_select_kernels();
+    c.fixed = 0;
+    c.stats = NULL;
+    c.allocator = &lept_allocator_global;
+    c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    lept_stringify_value(&c, v);
+    if (length) {
+        *length = c.top;
+    }
+    PUTC(&c, '\0');
+    return c.stack;
+}
+
+/*
+    生成JSON文本到buf中 栈直接使用buf 放不下时转到临时内存继续生成 以得到需要的长度
+*/
+int lept_stringify_buffer(const lept_value* v, char* buf, size_t size, size_t* length) {
+    lept_context c;
+    assert(v != NULL && (buf != NULL || size == 0));
+    c.stack = buf;
+    c.size = size;
+    c.top = 0;
+    c.kernels = lept_select_kernels();
+    c.fixed = 1;
+    c.stats = NULL;
+    c.allocator = &lept_allocator_global;
+    c.max_depth = LEPT_PARSE_MAX_DEPTH;
+    lept_stringify_value(&c, v);
+    if (length) {
+        *length = c.top;
+    }
+    PUTC(&c, '\0');
+    if (!c.fixed) {
+        LEPT_FREE_WITH(c.allocator, c.stack);
+        return LEPT_STRINGIFY_BUFFER_TOO_SMALL;
+    }
+    return LEPT_STRINGIFY_OK;
+}
+
+/* 放弃成员对键的引用 直接存放的键和借用的键不需要释放*/
+static void lept_free_key(lept_member* m) {
+    if (!(m->val.flags & (LEPT_FLAG_KEY_BORROWED | LEPT_FLAG_KEY_INLINE)) && lept_shared_release(m->key)) {
+        lept_shared_free(m->key);
+    }
+}
+
+/*
+    放弃v对自己内存的引用 v是持有最后一个引用的数组或对象时返回1 由调用者释放子结点和内存
+    其余情况在这里完成 v成为null 作为成员时保留键的归属
+*/
+static int lept_free_enter(lept_value* v) {
+    /* 内存不归v所有(例如来自arena)时 其子结点也都不归v所有 不需要遍历 句柄没有自己的内存*/
+    /* 内存还被其他副本引用时只减少引用计数 不遍历子结点*/
+    if (!(v->flags & (LEPT_FLAG_BORROWED | LEPT_FLAG_LAZY))) {
+        switch (v->type) {
+            case LEPT_STRING:
+                if (!(v->flags & LEPT_FLAG_INLINE) && lept_shared_release(v->u.s.s)) {
+                    lept_shared_free(v->u.s.s);
+                }
                 break;
-            case '\0':
-                STRING_ERROR(LEPT_PARSE_MISS_QUOTATION_MARK);
-            default:
-                if ((unsigned char)ch < 0x20) {
-                    STRING_ERROR(LEPT_PARSE_INVALID_STRING_CHAR);
+            case LEPT_ARRAY:
+                if (v->u.a.e != NULL && lept_shared_release(v->u.a.e)) {
+                    return 1;
+                }
+                break;
+            case LEPT_OBJECT:
+                if (v->u.o.m != NULL && lept_shared_release(v->u.o.m)) {
+                    return 1;
                 }
-                PUTC(c, ch);
+                break;
+            default:
+                break;
         }
     }
+    v->type = LEPT_NULL;
+    v->flags &= LEPT_FLAG_KEY_MASK;
+    return 0;
 }
 
 /*
-    在这里声明parse_value
-*/
-static int lept_parse_value(lept_context* c, lept_value* v);
-
-/*
-    解析数组
+    如果传入的是字符串，则释放v可能已经分配到的内存,将其类型设置为LEPT_NULL
+    如果是其他不需要释放资源的类型，将其类型设置为LEPT_NULL
+    现在加入了array类型，需要将数字中每个对象都要释放一次
+    子结点用显式的栈遍历 不随嵌套层数递归
 */
-static int lept_parse_array(lept_context* c, lept_value* v) {
-    size_t i, size = 0;
-    int ret;
-    EXPECT(c, '[');
-    // 如果是空数组
-    lept_parse_whitespace(c);
-    if (*c->json == ']') {
-        c->json++;
-        v->type = LEPT_ARRAY;
-        v->u.a.e = NULL;
-        v->u.a.size = 0;
-        return LEPT_PARSE_OK;
+void lept_free(lept_value* v) {
+    lept_walk k;
+    lept_walk_frame* f;
+    lept_value* e;
+    /* 首先断言v是不是空指针*/
+    assert(v != NULL);
+    if (!lept_free_enter(v)) {
+        return;
     }
-    for ( ; ;) {
-        lept_value e;
-        lept_init(&e);
-        if ((ret = lept_parse_value(c, &e)) != LEPT_PARSE_OK) {
-            break;
+    lept_walk_init(&k);
+    lept_walk_push(&k, v, NULL);
+    while (k.depth > 0) {
+        f = LEPT_WALK_TOP(&k);
+        v = f->v;
+        if (v->type == LEPT_ARRAY && f->i < v->u.a.size) {
+            e = &v->u.a.e[f->i++];
         }
-        memcpy(lept_context_push(c, sizeof(lept_value)),
-            &e, sizeof(lept_value));
-        size ++;
-        lept_parse_whitespace(c);
-        if (*c->json == ',') {
-            c->json ++;
-            lept_parse_whitespace(c);
-        }
-        else if (*c->json == ']') {
-            c->json ++;
-            v->type = LEPT_ARRAY;
-            /* 弹出并分配内存 这里的size是多少个对象*/
-            v->u.a.size = size;
-            /*下面的size是这些对象需要的内存*/
-            size *= sizeof(lept_value);
-            memcpy(v->u.a.e = (lept_value*)malloc(size), 
-                lept_context_pop(c, size), size);
-            return LEPT_PARSE_OK;
+        else if (v->type == LEPT_OBJECT && f->i < v->u.o.size) {
+            lept_free_key(&v->u.o.m[f->i]);
+            e = &v->u.o.m[f->i++].val;
         }
         else {
-            ret = LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET;
-            break;
+            /* 子结点都已释放 对象的索引与成员数组在同一块内存中*/
+            lept_shared_free(v->type == LEPT_ARRAY ? (void*)v->u.a.e : (void*)v->u.o.m);
+            v->type = LEPT_NULL;
+            v->flags &= LEPT_FLAG_KEY_MASK;
+            k.depth--;
+            continue;
+        }
+        if (lept_free_enter(e)) {
+            lept_walk_push(&k, e, NULL);
         }
     }
+    lept_walk_free(&k);
+}
 
-    for( i = 0; i < size; i++) {
-        lept_free((lept_value*)lept_context_pop(c, sizeof(lept_value)));
+/* 为v自己的内存增加一个引用 v的副本因此可以独立地释放*/
+static void lept_value_retain(const lept_value* v) {
+    if (!(v->flags & (LEPT_FLAG_BORROWED | LEPT_FLAG_LAZY | LEPT_FLAG_INLINE))) {
+        switch (v->type) {
+            case LEPT_STRING: lept_shared_retain(v->u.s.s); break;
+            case LEPT_ARRAY:  if (v->u.a.e) lept_shared_retain(v->u.a.e); break;
+            case LEPT_OBJECT: if (v->u.o.m) lept_shared_retain(v->u.o.m); break;
+            default: break;
+        }
     }
-    return ret;
 }
 
-
 /*
-    写入解析出来的根值
+    复制 数组、对象和长字符串只增加引用计数 与src共享内存
+    内存不属于src时(arena或原地解析)深复制 副本不依赖arena和输入缓冲区
 */
-static int lept_parse_value(lept_context* c, lept_value* v) {
-    switch (*c->json) {
-        case 't':  return lept_parse_literal(c, v, "true", LEPT_TRUE);
-        case 'f':  return lept_parse_literal(c, v, "false", LEPT_FALSE);
-        case 'n':  return lept_parse_literal(c, v, "null", LEPT_NULL);
-        default:   return lept_parse_number(c, v);
-        case '"':  return lept_parse_string(c, v);
-        case '[':  return lept_parse_array(c, v);
-        case '\0': return LEPT_PARSE_EXPECT_VALUE;
+void lept_copy(lept_value* dst, const lept_value* src) {
+    unsigned key;
+    assert(dst != NULL && src != NULL && dst != src);
+    lept_free(dst);
+    key = dst->flags & LEPT_FLAG_KEY_MASK;
+    if ((src->flags & (LEPT_FLAG_BORROWED | LEPT_FLAG_BORROWED_CHILDREN)) && src->type >= LEPT_STRING) {
+        lept_value_copy(dst, src);
+        dst->flags = (dst->flags & ~LEPT_FLAG_KEY_MASK) | key;
+        return;
     }
+    lept_value_retain(src);
+    dst->u = src->u;
+    dst->type = src->type;
+    dst->flags = (src->flags & ~LEPT_FLAG_KEY_MASK) | key;
 }
 
 /*
-    解析JSON文本
+    把src的内容转移到dst src成为null 作为成员时两者各自保留键
 */
-int lept_parse(lept_value* v, const char* json) {
-    lept_context c;
-    int ret;
-    assert(v != NULL);
-    c.json = json;
-    c.stack = NULL;
-    c.size = c.top = 0;
-    lept_init(v);
-    lept_parse_whitespace(&c);
-    if ((ret = lept_parse_value(&c, v)) == LEPT_PARSE_OK) {
-        lept_parse_whitespace(&c);
-        if (*c.json != '\0') {
-            v->type = LEPT_NULL;
-            ret = LEPT_PARSE_ROOT_NOT_SINGULAR;
-        }
-    }
-    assert(c.top == 0);
-    free(c.stack);
-    return ret;
+void lept_move(lept_value* dst, lept_value* src) {
+    assert(dst != NULL && src != NULL && dst != src);
+    lept_free(dst);
+    dst->u = src->u;
+    dst->type = src->type;
+    dst->flags = (dst->flags & LEPT_FLAG_KEY_MASK) | (src->flags & ~LEPT_FLAG_KEY_MASK);
+    src->type = LEPT_NULL;
+    src->flags &= LEPT_FLAG_KEY_MASK;
 }
 
-/*
-    如果传入的是字符串，则释放v可能已经分配到的内存,将其类型设置为LEPT_NULL
-    如果是其他不需要释放资源的类型，将其类型设置为LEPT_NULL
-    现在加入了array类型，需要将数字中每个对象都要释放一次
-*/
-void lept_free(lept_value* v) {
-    /* 这个i用于遍历数组对象*/
-    size_t i;
-    /* 首先断言v是不是空指针*/
-    assert(v != NULL);
-    /* 只有给定的v是字符串对象或者数组对象的时候 才执行释放操作*/
-    switch (v->type) {
-        case LEPT_STRING:
-            free(v->u.s.s);
-            break;
-        case LEPT_ARRAY:
-            for ( i = 0; i < v->u.a.size; i++) {
-                lept_free(&v->u.a.e[i]);
-            }
-            free(v->u.a.e);
-            break;
-        default:
-            break;
+void lept_swap(lept_value* lhs, lept_value* rhs) {
+    lept_value temp;
+    assert(lhs != NULL && rhs != NULL);
+    if (lhs != rhs) {
+        temp = *lhs;
+        lhs->u = rhs->u;
+        lhs->type = rhs->type;
+        lhs->flags = (lhs->flags & LEPT_FLAG_KEY_MASK) | (rhs->flags & ~LEPT_FLAG_KEY_MASK);
+        rhs->u = temp.u;
+        rhs->type = temp.type;
+        rhs->flags = (rhs->flags & LEPT_FLAG_KEY_MASK) | (temp.flags & ~LEPT_FLAG_KEY_MASK);
     }
-    /* 释放后将v的类型设置为LEPT_NULL*/
-    v->type = LEPT_NULL;
 }
 
 /*
@@ -410,6 +5455,7 @@ void lept_set_boolean(lept_value* v, int b) {
 
 double lept_get_number(const lept_value* v) {
     assert(v->type == LEPT_NUMBER);
+    LEPT_EXPAND(v);
     return v->u.n;
 }
 
@@ -421,20 +5467,27 @@ void lept_set_number(lept_value* v, double n) {
 
 const char* lept_get_string(const lept_value* v) {
     assert(v != NULL && v->type == LEPT_STRING);
-    return v->u.s.s;
+    LEPT_EXPAND(v);
+    return LEPT_STRING_PTR(v);
 }
 
 size_t lept_get_string_length(const lept_value* v) {
     assert(v != NULL && v->type == LEPT_STRING);
-    return v->u.s.len;
+    LEPT_EXPAND(v);
+    return LEPT_STRING_LEN(v);
 }
 
 void lept_set_string(lept_value* v, const char* s, size_t len) {
     assert(v!= NULL && (s != NULL || len == 0));
     /* 首先释放可能的内存*/
     lept_free(v);
+    /* 短字符串直接存放在v中*/
+    if (len <= LEPT_INLINE_MAX) {
+        lept_set_inline_string(v, s, len);
+        return;
+    }
     /* 为字符串s申请内存 多申请一个作为终止符*/
-    v->u.s.s = (char*) malloc(len + 1);
+    v->u.s.s = (char*) lept_shared_alloc(len + 1);
     /* 复制内容*/
     memcpy(v->u.s.s, s, len);
     /* 在结尾加上终止符*/
@@ -447,34 +5500,600 @@ void lept_set_string(lept_value* v, const char* s, size_t len) {
 
 size_t lept_get_array_size(const lept_value* v) {
     assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
     return v->u.a.size;
 }
 
 lept_value* lept_get_array_element(const lept_value* v, size_t index) {
-    assert(v != NULL && v->type == LEPT_ARRAY && v->u.a.size > index);
+    assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
+    assert(v->u.a.size > index);
     return &v->u.a.e[index];
 
 }
 
+/*
+    数组和对象的容量 自己的内存记录在引用计数旁边 arena中的内存正好是size个元素
+*/
+static size_t lept_container_capacity(const void* p, unsigned flags, size_t size) {
+    return p == NULL ? 0 : flags & LEPT_FLAG_BORROWED ? size : LEPT_SHARED(p)->capacity;
+}
+
+/* 按1.5倍增长到至少needed*/
+static size_t lept_grow_capacity(size_t capacity, size_t needed) {
+    while (capacity < needed) {
+        capacity = capacity < 4 ? 4 : capacity + capacity / 2;
+    }
+    return capacity;
+}
+
+/*
+    修改数组之前调用 之后e只属于v 正好能容纳capacity个元素
+    与其他副本共享或者来自arena时复制一层 子结点只增加引用计数
+*/
+static void lept_array_own(lept_value* v, size_t capacity) {
+    lept_value old;
+    lept_value* e;
+    size_t i, size = v->u.a.size;
+    assert(capacity >= size);
+    if (v->u.a.e != NULL && !(v->flags & LEPT_FLAG_BORROWED) && LEPT_ATOMIC_LOAD(&LEPT_SHARED(v->u.a.e)->refs) == 1) {
+        /* 只属于v 原地修改之前作废缓存的散列值*/
+        LEPT_ATOMIC_STORE_HASH(&LEPT_SHARED(v->u.a.e)->hash, 0);
+        if (capacity != LEPT_SHARED(v->u.a.e)->capacity) {
+            if (capacity == 0) {
+                lept_shared_free(v->u.a.e);
+                v->u.a.e = NULL;
+                return;
+            }
+            e = (lept_value*)((char*)LEPT_REALLOC(LEPT_SHARED(v->u.a.e), LEPT_SHARED_HEADER + capacity * sizeof(lept_value)) + LEPT_SHARED_HEADER);
+            LEPT_SHARED(e)->capacity = capacity;
+            v->u.a.e = e;
+        }
+        return;
+    }
+    e = NULL;
+    if (capacity) {
+        e = (lept_value*)lept_shared_alloc(capacity * sizeof(lept_value));
+        LEPT_SHARED(e)->capacity = capacity;
+        for (i = 0; i < size; i++) {
+            lept_value_retain(&v->u.a.e[i]);
+        }
+        if (size) {
+            memcpy(e, v->u.a.e, size * sizeof(lept_value));
+        }
+    }
+    /* 放弃原来的内存 最后的所有者释放时抵消上面增加的引用*/
+    old = *v;
+    lept_free(&old);
+    v->u.a.e = e;
+    /* 子结点原样保留 原来借用的内存仍被它们引用*/
+    v->flags = (v->flags & LEPT_FLAG_KEY_MASK) | (v->flags & (LEPT_FLAG_BORROWED | LEPT_FLAG_BORROWED_CHILDREN) ? LEPT_FLAG_BORROWED_CHILDREN : 0);
+}
+
+void lept_set_array(lept_value* v, size_t capacity) {
+    assert(v != NULL);
+    lept_free(v);
+    v->type = LEPT_ARRAY;
+    v->u.a.size = 0;
+    v->u.a.e = NULL;
+    if (capacity) {
+        lept_array_own(v, capacity);
+    }
+}
+
+size_t lept_get_array_capacity(const lept_value* v) {
+    assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
+    return lept_container_capacity(v->u.a.e, v->flags, v->u.a.size);
+}
+
+void lept_reserve_array(lept_value* v, size_t capacity) {
+    size_t current = lept_get_array_capacity(v);
+    lept_array_own(v, capacity > current ? capacity : current);
+}
+
+void lept_shrink_array(lept_value* v) {
+    assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
+    lept_array_own(v, v->u.a.size);
+}
+
+void lept_clear_array(lept_value* v) {
+    assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
+    lept_erase_array_element(v, 0, v->u.a.size);
+}
+
+lept_value* lept_pushback_array_element(lept_value* v) {
+    return lept_insert_array_element(v, lept_get_array_size(v));
+}
+
+void lept_popback_array_element(lept_value* v) {
+    assert(v != NULL && v->type == LEPT_ARRAY && v->u.a.size > 0);
+    lept_erase_array_element(v, v->u.a.size - 1, 1);
+}
+
+lept_value* lept_insert_array_element(lept_value* v, size_t index) {
+    lept_value* e;
+    size_t capacity = lept_get_array_capacity(v);
+    assert(index <= v->u.a.size);
+    lept_array_own(v, v->u.a.size < capacity ? capacity : lept_grow_capacity(capacity, v->u.a.size + 1));
+    e = &v->u.a.e[index];
+    memmove(e + 1, e, (v->u.a.size - index) * sizeof(lept_value));
+    v->u.a.size++;
+    lept_init(e);
+    return e;
+}
+
+void lept_erase_array_element(lept_value* v, size_t index, size_t count) {
+    size_t i;
+    assert(v != NULL && v->type == LEPT_ARRAY);
+    LEPT_EXPAND(v);
+    assert(index <= v->u.a.size && count <= v->u.a.size - index);
+    if (count == 0) {
+        return;
+    }
+    lept_array_own(v, lept_container_capacity(v->u.a.e, v->flags, v->u.a.size));
+    for (i = index; i < index + count; i++) {
+        lept_free(&v->u.a.e[i]);
+    }
+    memmove(&v->u.a.e[index], &v->u.a.e[index + count], (v->u.a.size - index - count) * sizeof(lept_value));
+    v->u.a.size -= count;
+}
+
 size_t lept_get_object_size(const lept_value* v) {
     assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
     return v->u.o.size;
 }
 
 const char* lept_get_object_key(const lept_value* v, size_t index) {
     assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
     assert(index < v->u.o.size);
-    return v->u.o.m[index].key;
+    return LEPT_MEMBER_KEY(&v->u.o.m[index]);
 }
 size_t lept_get_object_key_length(const lept_value* v, size_t index) {
     assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
     assert(index < v->u.o.size);
-    return v->u.o.m[index].klen;
+    return LEPT_MEMBER_KLEN(&v->u.o.m[index]);
 }
 lept_value* lept_get_object_value(const lept_value* v, size_t index) {
     assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
+    assert(index < v->u.o.size);
+    return &v->u.o.m[index].val;
+}
+
+/*
+    按键查找成员的下标 有索引时按散列查找 否则线性扫描
+    有重复的键时返回第一个
+*/
+size_t lept_find_object_index(const lept_value* v, const char* key, size_t klen) {
+    size_t i, slots, capacity;
+    assert(v != NULL && v->type == LEPT_OBJECT && (key != NULL || klen == 0));
+    LEPT_EXPAND(v);
+    capacity = lept_container_capacity(v->u.o.m, v->flags, v->u.o.size);
+    if ((slots = lept_object_index_slots(capacity)) != 0) {
+        const uint32_t* index = LEPT_OBJECT_INDEX(v->u.o.m, capacity);
+        for (i = (size_t)lept_hash_bytes(key, klen) & (slots - 1); index[i] != 0; i = (i + 1) & (slots - 1)) {
+            const lept_member* m = &v->u.o.m[index[i] - 1];
+            /* 传入共享字符串表中的键时 比较指针就够了*/
+            if (LEPT_MEMBER_KLEN(m) == klen && (LEPT_MEMBER_KEY(m) == key || memcmp(LEPT_MEMBER_KEY(m), key, klen) == 0)) {
+                return index[i] - 1;
+            }
+        }
+        return LEPT_KEY_NOT_EXIST;
+    }
+    for (i = 0; i < v->u.o.size; i++) {
+        if (LEPT_MEMBER_KLEN(&v->u.o.m[i]) == klen && (LEPT_MEMBER_KEY(&v->u.o.m[i]) == key || memcmp(LEPT_MEMBER_KEY(&v->u.o.m[i]), key, klen) == 0)) {
+            return i;
+        }
+    }
+    return LEPT_KEY_NOT_EXIST;
+}
+
+lept_value* lept_find_object_value(const lept_value* v, const char* key, size_t klen) {
+    size_t index = lept_find_object_index(v, key, klen);
+    return index != LEPT_KEY_NOT_EXIST ? &v->u.o.m[index].val : NULL;
+}
+
+/* 成员数组和索引一起申请*/
+#define LEPT_OBJECT_BYTES(capacity) ((capacity) * sizeof(lept_member) + lept_object_index_slots(capacity) * sizeof(uint32_t))
+
+/*
+    修改对象之前调用 之后m只属于v 正好能容纳capacity个成员 索引按capacity重建
+    与其他副本共享或者来自arena时复制一层 键和值只增加引用计数
+*/
+static void lept_object_own(lept_value* v, size_t capacity) {
+    lept_value old;
+    lept_member* m;
+    size_t i, size = v->u.o.size;
+    assert(capacity >= size);
+    if (v->u.o.m != NULL && !(v->flags & LEPT_FLAG_BORROWED) && LEPT_ATOMIC_LOAD(&LEPT_SHARED(v->u.o.m)->refs) == 1) {
+        LEPT_ATOMIC_STORE_HASH(&LEPT_SHARED(v->u.o.m)->hash, 0);
+        if (capacity != LEPT_SHARED(v->u.o.m)->capacity) {
+            if (capacity == 0) {
+                lept_shared_free(v->u.o.m);
+                v->u.o.m = NULL;
+                return;
+            }
+            m = (lept_member*)((char*)LEPT_REALLOC(LEPT_SHARED(v->u.o.m), LEPT_SHARED_HEADER + LEPT_OBJECT_BYTES(capacity)) + LEPT_SHARED_HEADER);
+            LEPT_SHARED(m)->capacity = capacity;
+            v->u.o.m = m;
+            if (lept_object_index_slots(capacity)) {
+                lept_object_build_index(m, size, capacity);
+            }
+        }
+        return;
+    }
+    m = NULL;
+    if (capacity) {
+        m = (lept_member*)lept_shared_alloc(LEPT_OBJECT_BYTES(capacity));
+        LEPT_SHARED(m)->capacity = capacity;
+        for (i = 0; i < size; i++) {
+            const lept_member* sm = &v->u.o.m[i];
+            if (!(sm->val.flags & (LEPT_FLAG_KEY_BORROWED | LEPT_FLAG_KEY_INLINE))) {
+                lept_shared_retain(sm->key);
+            }
+            lept_value_retain(&sm->val);
+        }
+        if (size) {
+            memcpy(m, v->u.o.m, size * sizeof(lept_member));
+        }
+        if (lept_object_index_slots(capacity)) {
+            lept_object_build_index(m, size, capacity);
+        }
+    }
+    old = *v;
+    lept_free(&old);
+    v->u.o.m = m;
+    v->flags = (v->flags & LEPT_FLAG_KEY_MASK) | (v->flags & (LEPT_FLAG_BORROWED | LEPT_FLAG_BORROWED_CHILDREN) ? LEPT_FLAG_BORROWED_CHILDREN : 0);
+}
+
+void lept_set_object(lept_value* v, size_t capacity) {
+    assert(v != NULL);
+    lept_free(v);
+    v->type = LEPT_OBJECT;
+    v->u.o.size = 0;
+    v->u.o.m = NULL;
+    if (capacity) {
+        lept_object_own(v, capacity);
+    }
+}
+
+size_t lept_get_object_capacity(const lept_value* v) {
+    assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
+    return lept_container_capacity(v->u.o.m, v->flags, v->u.o.size);
+}
+
+void lept_reserve_object(lept_value* v, size_t capacity) {
+    size_t current = lept_get_object_capacity(v);
+    lept_object_own(v, capacity > current ? capacity : current);
+}
+
+void lept_shrink_object(lept_value* v) {
+    assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
+    lept_object_own(v, v->u.o.size);
+}
+
+void lept_clear_object(lept_value* v) {
+    lept_member* m;
+    size_t i;
+    assert(v != NULL && v->type == LEPT_OBJECT);
+    LEPT_EXPAND(v);
+    if (v->u.o.size == 0) {
+        return;
+    }
+    lept_object_own(v, lept_container_capacity(v->u.o.m, v->flags, v->u.o.size));
+    for (i = 0; i < v->u.o.size; i++) {
+        m = &v->u.o.m[i];
+        lept_free_key(m);
+        lept_free(&m->val);
+    }
+    v->u.o.size = 0;
+    if (lept_object_index_slots(LEPT_SHARED(v->u.o.m)->capacity)) {
+        lept_object_build_index(v->u.o.m, 0, LEPT_SHARED(v->u.o.m)->capacity);
+    }
+}
+
+lept_value* lept_set_object_value(lept_value* v, const char* key, size_t klen) {
+    size_t index = lept_find_object_index(v, key, klen), capacity = lept_get_object_capacity(v);
+    lept_member* m;
+    if (index != LEPT_KEY_NOT_EXIST) {
+        lept_object_own(v, capacity);
+        return &v->u.o.m[index].val;
+    }
+    lept_object_own(v, v->u.o.size < capacity ? capacity : lept_grow_capacity(capacity, v->u.o.size + 1));
+    m = &v->u.o.m[v->u.o.size];
+    lept_init(&m->val);
+    if (klen <= LEPT_INLINE_MAX) {
+        /* 短键直接存放在key和klen的位置上*/
+        char* p = (char*)&m->key;
+        if (klen) {
+            memcpy(p, key, klen);
+        }
+        p[klen] = '\0';
+        m->val.flags = LEPT_FLAG_KEY_INLINE | (unsigned)klen << 24;
+    }
+    else {
+        memcpy(m->key = (char*)lept_shared_alloc(klen + 1), key, klen);
+        m->key[klen] = '\0';
+        m->klen = klen;
+    }
+    if (lept_object_index_slots(LEPT_SHARED(v->u.o.m)->capacity)) {
+        lept_object_index_add(v->u.o.m, LEPT_SHARED(v->u.o.m)->capacity, v->u.o.size);
+    }
+    return &v->u.o.m[v->u.o.size++].val;
+}
+
+void lept_remove_object_value(lept_value* v, size_t index) {
+    lept_member* m;
+    size_t capacity = lept_get_object_capacity(v);
     assert(index < v->u.o.size);
-    return v->u.o.m[index].val;
+    lept_object_own(v, capacity);
+    m = &v->u.o.m[index];
+    lept_free_key(m);
+    lept_free(&m->val);
+    memmove(m, m + 1, (v->u.o.size - index - 1) * sizeof(lept_member));
+    v->u.o.size--;
+    /* 后面的成员都移动了位置*/
+    if (lept_object_index_slots(capacity)) {
+        lept_object_build_index(v->u.o.m, v->u.o.size, capacity);
+    }
+}
+
+/*
+    比较和散列 共享的内存不会被原地修改 它的散列值缓存在引用计数旁边
+    只有计数大于1时才读写缓存 计数从1增加时(lept_shared_retain())和原地修改之前缓存作废
+*/
+static const void* lept_value_shared(const lept_value* v) {
+    const void* p;
+    if (v->type < LEPT_STRING || (v->flags & (LEPT_FLAG_BORROWED | LEPT_FLAG_LAZY | LEPT_FLAG_INLINE))) {
+        return NULL;
+    }
+    p = v->type == LEPT_STRING ? (const void*)v->u.s.s : v->type == LEPT_ARRAY ? (const void*)v->u.a.e : (const void*)v->u.o.m;
+    return p != NULL && LEPT_ATOMIC_LOAD(&LEPT_SHARED(p)->refs) > 1 ? p : NULL;
+}
+
+static uint64_t lept_hash_mix(uint64_t h) {
+    h = (h ^ h >> 33) * 0xff51afd7ed558ccdu;
+    h = (h ^ h >> 33) * 0xc4ceb9fe1a85ec53u;
+    return h ^ h >> 33;
+}
+
+static void lept_hash_store(const lept_value* v, uint64_t h) {
+    const void* p = lept_value_shared(v);
+    if (p != NULL) {
+        LEPT_ATOMIC_STORE_HASH(&LEPT_SHARED(p)->hash, h);
+    }
+}
+
+/* 标量、空容器和缓存了散列值的容器直接得到*h 其余的容器返回0 由lept_hash()遍历子结点*/
+static int lept_hash_leaf(const lept_value* v, uint64_t* h) {
+    const void* p;
+    double n;
+    if ((p = lept_value_shared(v)) != NULL && (*h = LEPT_ATOMIC_LOAD_HASH(&LEPT_SHARED(p)->hash)) != 0) {
+        return 1;
+    }
+    switch (v->type) {
+        case LEPT_NUMBER:
+            /* 与lept_is_equal()一致 0和-0相同 NaN都相同*/
+            n = v->u.n;
+            if (n != n) {
+                *h = 0x7ff8000000000000u;
+            }
+            else {
+                n = n == 0.0 ? 0.0 : n;
+                memcpy(h, &n, sizeof(*h));
+            }
+            *h = lept_hash_mix(*h);
+            break;
+        case LEPT_STRING:
+            *h = lept_hash_bytes(LEPT_STRING_PTR(v), LEPT_STRING_LEN(v));
+            break;
+        case LEPT_ARRAY:
+            if (v->u.a.size > 0) {
+                return 0;
+            }
+            *h = 0x9e3779b97f4a7c15u;
+            break;
+        case LEPT_OBJECT:
+            if (v->u.o.size > 0) {
+                return 0;
+            }
+            *h = lept_hash_mix(0);
+            break;
+        default:
+            *h = lept_hash_mix((uint64_t)v->type + 1);
+            break;
+    }
+    if (p != NULL) {
+        LEPT_ATOMIC_STORE_HASH(&LEPT_SHARED(p)->hash, *h);
+    }
+    return 1;
+}
+
+/*
+    数组的散列值按顺序混合子结点的散列值 对象的成员散列值相加 与成员顺序无关
+    f->h是容器已经累计的值 f->i指向下一个子结点 刚得到散列值的是第f->i-1个
+*/
+uint64_t lept_hash(const lept_value* v) {
+    lept_walk k;
+    lept_walk_frame* f;
+    uint64_t h;
+    assert(v != NULL);
+    lept_walk_init(&k);
+    for (;;) {
+        LEPT_EXPAND(v);
+        if (!lept_hash_leaf(v, &h)) {
+            f = lept_walk_push(&k, v, NULL);
+            f->i = 1;
+            if (v->type == LEPT_ARRAY) {
+                f->h = 0x9e3779b97f4a7c15u ^ (uint64_t)v->u.a.size;
+                v = &v->u.a.e[0];
+            }
+            else {
+                v = &v->u.o.m[0].val;
+            }
+            continue;
+        }
+        /* h合并到所在的容器中 容器结束时它的散列值再合并到上一层*/
+        for (;;) {
+            if (k.depth == 0) {
+                lept_walk_free(&k);
+                return h;
+            }
+            f = LEPT_WALK_TOP(&k);
+            v = f->v;
+            if (v->type == LEPT_ARRAY) {
+                f->h = lept_hash_mix(f->h + h);
+                if (f->i < v->u.a.size) {
+                    v = &v->u.a.e[f->i++];
+                    break;
+                }
+                h = f->h;
+            }
+            else {
+                f->h += lept_hash_mix(LEPT_MEMBER_HASH(&v->u.o.m[f->i - 1]) + h * 0x9e3779b97f4a7c15u);
+                if (f->i < v->u.o.size) {
+                    v = &v->u.o.m[f->i++].val;
+                    break;
+                }
+                h = lept_hash_mix(f->h ^ (uint64_t)v->u.o.size << 3);
+            }
+            lept_hash_store(v, h);
+            k.depth--;
+        }
+    }
+}
+
+/* 两边都缓存了散列值并且不同时一定不相等 不计算新的散列值*/
+static int lept_cached_hash_differs(const lept_value* lhs, const lept_value* rhs) {
+    const void* p = lept_value_shared(lhs);
+    const void* q = lept_value_shared(rhs);
+    uint64_t h, k;
+    if (p == NULL || q == NULL) {
+        return 0;
+    }
+    h = LEPT_ATOMIC_LOAD_HASH(&LEPT_SHARED(p)->hash);
+    k = LEPT_ATOMIC_LOAD_HASH(&LEPT_SHARED(q)->hash);
+    return h != 0 && k != 0 && h != k;
+}
+
+/* 标量和不需要比较子结点就能确定的容器返回0或1 其余返回-1 由lept_is_equal()逐个比较子结点*/
+static int lept_is_equal_leaf(const lept_value* lhs, const lept_value* rhs) {
+    LEPT_EXPAND(lhs);
+    LEPT_EXPAND(rhs);
+    if (lhs->type != rhs->type) {
+        return 0;
+    }
+    switch (lhs->type) {
+        case LEPT_NUMBER:
+            return lhs->u.n == rhs->u.n || (lhs->u.n != lhs->u.n && rhs->u.n != rhs->u.n);
+        case LEPT_STRING:
+            return LEPT_STRING_LEN(lhs) == LEPT_STRING_LEN(rhs) && memcmp(LEPT_STRING_PTR(lhs), LEPT_STRING_PTR(rhs), LEPT_STRING_LEN(lhs)) == 0;
+        case LEPT_ARRAY:
+            if (lhs->u.a.size != rhs->u.a.size || lept_cached_hash_differs(lhs, rhs)) {
+                return 0;
+            }
+            /* 共享同一块内存的副本不需要比较*/
+            return lhs->u.a.size == 0 || lhs->u.a.e == rhs->u.a.e ? 1 : -1;
+        case LEPT_OBJECT:
+            if (lhs->u.o.size != rhs->u.o.size || lept_cached_hash_differs(lhs, rhs)) {
+                return 0;
+            }
+            return lhs->u.o.size == 0 || lhs->u.o.m == rhs->u.o.m ? 1 : -1;
+        default:
+            return 1;
+    }
+}
+
+/*
+    对象中下一对要比较的成员值 返回1时放在*lhs和*rhs中 返回0时已经确定不相等 返回-1时已经比较完
+    成员顺序相同的部分按位置比较 不需要查找 f->n为0
+    顺序不同时f->n记录按位置比较过的成员个数加1 f->i从头开始 要求lhs的键互不相同 每个键通过索引找到rhs中同名的成员
+    lhs的size个键各自找到rhs中不同的成员 所以rhs的键也互不相同 结果与参数的顺序无关
+    按位置比较过的成员只需要检查它们的键不重复
+*/
+static int lept_is_equal_next_member(lept_walk_frame* f, const lept_value** lhs, const lept_value** rhs) {
+    const lept_member* m;
+    const lept_member* o;
+    size_t size = f->v->u.o.size, k;
+    if (f->n == 0) {
+        if (f->i == size) {
+            return -1;
+        }
+        m = &f->v->u.o.m[f->i];
+        o = &f->w->u.o.m[f->i];
+        if (LEPT_MEMBER_KLEN(m) == LEPT_MEMBER_KLEN(o) && memcmp(LEPT_MEMBER_KEY(m), LEPT_MEMBER_KEY(o), LEPT_MEMBER_KLEN(m)) == 0) {
+            f->i++;
+            *lhs = &m->val;
+            *rhs = &o->val;
+            return 1;
+        }
+        f->n = f->i + 1;
+        f->i = 0;
+    }
+    for ( ; f->i < size; f->i++) {
+        m = &f->v->u.o.m[f->i];
+        if (lept_find_object_index(f->v, LEPT_MEMBER_KEY(m), LEPT_MEMBER_KLEN(m)) != f->i) {
+            return 0;
+        }
+        if (f->i + 1 < f->n) {
+            continue;
+        }
+        if ((k = lept_find_object_index(f->w, LEPT_MEMBER_KEY(m), LEPT_MEMBER_KLEN(m))) == LEPT_KEY_NOT_EXIST) {
+            return 0;
+        }
+        f->i++;
+        *lhs = &m->val;
+        *rhs = &f->w->u.o.m[k].val;
+        return 1;
+    }
+    return -1;
+}
+
+int lept_is_equal(const lept_value* lhs, const lept_value* rhs) {
+    lept_walk k;
+    lept_walk_frame* f;
+    int ret;
+    assert(lhs != NULL && rhs != NULL);
+    lept_walk_init(&k);
+    for (;;) {
+        if ((ret = lept_is_equal_leaf(lhs, rhs)) < 0) {
+            lept_walk_push(&k, lhs, rhs);
+            ret = 1;
+        }
+        /* 下一对要比较的子结点 比较完的容器出栈*/
+        for (;;) {
+            if (ret == 0 || k.depth == 0) {
+                lept_walk_free(&k);
+                return ret;
+            }
+            f = LEPT_WALK_TOP(&k);
+            if (f->v->type == LEPT_ARRAY) {
+                if (f->i < f->v->u.a.size) {
+                    lhs = &f->v->u.a.e[f->i];
+                    rhs = &f->w->u.a.e[f->i++];
+                    break;
+                }
+            }
+            else {
+                if ((ret = lept_is_equal_next_member(f, &lhs, &rhs)) == 1) {
+                    break;
+                }
+                if (ret == 0) {
+                    continue;
+                }
+            }
+            ret = 1;
+            k.depth--;
+        }
+    }
 }
 
 /* leptjson.c */
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define LEPTJSON_H__
 
 #include <stddef.h> /* size_t */
+#include <stdint.h> /* uint64_t */
 
 /*  声明数据类型 使用枚举*/
 typedef enum {
@@ -25,13 +26,15 @@ struct lept_value {
     union {
         struct { lept_member* m; size_t size; }o; /* object*/
         struct { lept_value* e; size_t size; }a; /* array */
-        struct { char* s; size_t len; }s; /* string */
+        struct { char* s; size_t len; }s; /* string 短字符串直接存放在这16个字节中*/
         double n; /* number */
     }u;
     lept_type type;
+    unsigned flags; /* 存储归属等标志位 由库内部维护 */
 };
 
 /* member结构体是一个JSON键值对*/
+/* 短键直接存放在key和klen的位置上 读取键需要使用lept_get_object_key()和lept_get_object_key_length()*/
 struct lept_member {
     char* key; /* key 一个字符串*/
     size_t klen; /* key字符串的长度*/
@@ -50,21 +53,320 @@ enum {
     LEPT_PARSE_INVALID_STRING_CHAR,
     LEPT_PARSE_INVALID_UNICODE_HEX,
     LEPT_PARSE_INVALID_UNICODE_SURROGATE,
-    LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET
+    LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET,
+    LEPT_PARSE_MISS_KEY,
+    LEPT_PARSE_MISS_COLON,
+    LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET,
+    LEPT_PARSE_FILE_ERROR,
+    LEPT_PARSE_STOPPED,
+    LEPT_PARSE_DEPTH_EXCEEDED
 };
 
 /* 访问所有类型之前 都需要初始化 初始化将其设置为NULL类型即可*/
-#define lept_init(v) do { (v)->type = LEPT_NULL; } while(0)
+#define lept_init(v) do { (v)->type = LEPT_NULL; (v)->flags = 0; } while(0)
+
+/* 内存分配器：库中所有的内存都通过它申请和释放 user原样传给三个函数
+   lept_set_allocator()设置全局的分配器 a为NULL时恢复为malloc()/realloc()/free()
+   必须在申请任何内存之前设置 之前申请的内存仍然由新的分配器释放 设置本身不是线程安全的
+   多线程解析NDJSON时分配器本身需要是线程安全的
+*/
+typedef struct {
+    void* (*alloc)(void* user, size_t size);
+    void* (*realloc)(void* user, void* p, size_t size);
+    void (*free)(void* user, void* p);
+    void* user;
+} lept_allocator;
+
+void lept_set_allocator(const lept_allocator* a);
+
+/* arena分配器：按块申请内存 解析出的所有结点/字符串/数组都从块中顺序切分
+   释放整个文档只需要lept_arena_reset()或lept_arena_destroy() 不需要遍历树
+*/
+typedef struct lept_arena_block lept_arena_block;
+
+typedef struct {
+    lept_arena_block* head; /* 当前正在切分的块 之前的块挂在它后面*/
+    size_t block_size; /* 下一次申请新块的大小*/
+    const lept_allocator* allocator; /* 块从这个分配器申请 为NULL时使用全局分配器 lept_arena_init()置为NULL*/
+} lept_arena;
+
+/* block_size为0时使用默认块大小*/
+void lept_arena_init(lept_arena* a, size_t block_size);
+/* 丢弃arena中的所有内容 保留当前块以便下次复用*/
+void lept_arena_reset(lept_arena* a);
+/* 归还arena的所有内存*/
+void lept_arena_destroy(lept_arena* a);
 
 /* 函数声明：解析JSON
    传入一个不可更改的字符串JSON文本
    以及一个根结点指针
+   数组和对象最多嵌套1024层 更深时返回LEPT_PARSE_DEPTH_EXCEEDED
 */
 int lept_parse(lept_value* v, const char* json_str);
 
-/* 释放内存并将类型设置为NULL*/
+/* 函数声明：解析长度为len的JSON文本
+   json不需要以'\0'结尾 其中的'\0'按普通字节处理
+*/
+int lept_parse_n(lept_value* v, const char* json, size_t len);
+
+/* 共享字符串表：多个文档中相同的键只保存一份 不可修改
+   表只增不减 其中的字符串在lept_intern_free()之前一直有效 不是线程安全的
+*/
+typedef struct lept_intern lept_intern;
+
+lept_intern* lept_intern_new(void);
+/* 使用这个表的文档必须先释放*/
+void lept_intern_free(lept_intern* t);
+/* 函数声明：返回与s内容相同的共享副本 以'\0'结尾 同样的内容总是得到同一个指针
+   用这个指针查找使用同一个表解析出的对象时 键的比较只需要比较指针
+*/
+const char* lept_intern_string(lept_intern* t, const char* s, size_t len);
+
+/* 解析选项 未使用的字段置0
+   先用lept_parse_options_init()全部置0再设置需要的字段 以后增加的字段不影响调用者的代码
+*/
+typedef struct {
+    unsigned flags;
+    lept_intern* intern; /* 不为NULL时 对象的键都从这个表中取得 lept_free()不释放它们 按需解析时不使用*/
+    lept_arena* arena; /* 不为NULL时 结果的内存都从arena分配 与lept_parse_arena()相同 按需解析时不使用*/
+    const lept_allocator* allocator; /* 不为NULL时 栈和索引等临时内存从这里申请 结果仍然使用全局分配器或arena*/
+    /* 数组和对象最多嵌套的层数 超过时返回LEPT_PARSE_DEPTH_EXCEEDED 为0时使用默认的1024层
+       解析、lept_free()、生成JSON、复制、比较和散列都不递归 每层在堆上占几十字节 C栈的用量与层数无关*/
+    size_t max_depth;
+} lept_parse_options;
+
+void lept_parse_options_init(lept_parse_options* opts);
+
+/* 已废弃 结构索引的解析在所有测试的文本上都比默认的解析慢 现在被忽略 保留是为了旧的代码仍能编译*/
+#define LEPT_PARSE_STRUCTURAL 0x1u
+/* 按需解析：验证整个文本后只建立根值的句柄 字符串、数字、数组和对象在第一次被访问时才转换
+   没有访问的子树不建立 结果引用json 在结果释放之前json必须保持有效且不变
+   访问会展开句柄 多个线程同时读取同一个结果时需要加锁
+*/
+#define LEPT_PARSE_LAZY 0x2u
+/* 有共享字符串表时 不能直接存放在值中的较短字符串值也从表中取得*/
+#define LEPT_PARSE_INTERN_STRINGS 0x4u
+
+/* 函数声明：按选项解析长度为len的JSON文本 opts为NULL时与lept_parse_n()相同
+   各种选项下的结果和错误码都与lept_parse_n()相同
+*/
+int lept_parse_ex(lept_value* v, const char* json, size_t len, const lept_parse_options* opts);
+
+/* 可以复用的解析器 解析用的栈在多次解析之间保留 适合大量的小文本 每个线程使用自己的解析器*/
+typedef struct lept_parser lept_parser;
+
+/* 函数声明：建立解析器 复制opts(可以为NULL) 其中的共享字符串表和arena由调用者管理
+   stack_size为栈的初始大小 为0时使用LEPT_PARSE_STACK_INIT_SIZE
+*/
+lept_parser* lept_parser_new(const lept_parse_options* opts, size_t stack_size);
+/* 函数声明：与lept_parse_ex()相同 但使用解析器的选项和栈*/
+int lept_parser_parse(lept_parser* p, lept_value* v, const char* json, size_t len);
+void lept_parser_free(lept_parser* p);
+
+/* 统计各阶段周期数时的阶段 各阶段不重叠 LEPT_PHASE_CONTAINER是其余的全部时间(括号、字面量和建立结点)*/
+enum {
+    LEPT_PHASE_WHITESPACE,
+    LEPT_PHASE_STRING,
+    LEPT_PHASE_NUMBER,
+    LEPT_PHASE_CONTAINER,
+    LEPT_PHASE_COUNT
+};
+
+/* 同时记录各阶段的周期数 x86上使用时间戳计数器 其他平台是clock()的单位 记录本身也有开销*/
+#define LEPT_PARSE_STATS_CYCLES 0x8u
+
+/* 一次解析的统计 只有编译库时定义了LEPT_STATS才会记录 否则全部为0*/
+typedef struct {
+    size_t bytes; /* 读取的字节数 出错时是出错的位置*/
+    size_t nodes[7]; /* 按lept_type分类的值的个数 不包括键*/
+    size_t keys; /* 对象的键的个数*/
+    size_t string_bytes; /* 字符串和键解码后的总字节数*/
+    size_t escapes; /* 转义序列的个数 包括\uXXXX*/
+    size_t unicode_escapes; /* \uXXXX的个数 代理对算两个*/
+    size_t surrogates; /* 代理对的个数*/
+    size_t stack_grows; /* 解析栈扩容的次数*/
+    size_t stack_high_water; /* 解析栈的最大使用量(字节)*/
+    size_t max_depth; /* 数组和对象的最大嵌套深度*/
+    size_t allocs; /* 为结果申请内存的次数 使用arena时是从arena切分的次数*/
+    size_t alloc_bytes; /* 为结果申请的字节数*/
+    uint64_t cycles[LEPT_PHASE_COUNT]; /* 使用LEPT_PARSE_STATS_CYCLES时各阶段的周期数*/
+} lept_parse_stats;
+
+/* 函数声明：与lept_parse_ex()相同 同时把统计写入stats
+   用于找出真实输入中慢的原因 不需要统计时使用lept_parse_ex()
+*/
+int lept_parse_ex_stats(lept_value* v, const char* json, size_t len, const lept_parse_options* opts, lept_parse_stats* stats);
+
+/* 编译好的一组JSON Pointer(RFC 6901) 可以用于多次投影解析*/
+typedef struct lept_projection lept_projection;
+
+/* 函数声明：编译count条JSON Pointer 例如"/user/id"
+   键"*"匹配数组的所有元素 在对象中仍然只匹配键"*" 有不合法的路径时返回NULL
+*/
+lept_projection* lept_projection_compile(const char* const* paths, size_t count);
+void lept_projection_free(lept_projection* p);
+
+/* 函数声明：投影解析 只为路径匹配到的值建立结点
+   v成为一个数组 第i个元素是第i条路径匹配到的所有值组成的数组 按文本中的顺序排列
+   其他子树只匹配引号和括号就越过 不建立结点也不检查其中的语法 所以其中的错误不一定能发现
+*/
+int lept_parse_projection(lept_value* v, const char* json, size_t len, const lept_projection* p);
+
+/* 函数声明：解析文件 POSIX系统上以只读方式映射文件 不复制内容
+   文件无法打开或读取时返回LEPT_PARSE_FILE_ERROR
+*/
+int lept_parse_file(lept_value* v, const char* path);
+
+/* 函数声明：使用arena解析JSON
+   解析结果的内存全部来自arena 生命周期与arena相同
+   对这样的结果调用lept_free()只会把类型置为NULL 不会释放内存
+   arena中的值不应再用lept_set_*()赋予新的字符串或数组
+*/
+int lept_parse_arena(lept_value* v, lept_arena* a, const char* json_str);
+
+/* 函数声明：原地解析JSON
+   字符串直接在json中解码 结果中的字符串指向json 不再分配内存
+   json会被改写 在结果释放之前必须保持有效
+*/
+int lept_parse_insitu(lept_value* v, char* json, size_t len);
+
+/* 事件驱动解析的处理函数 不需要的事件可以设为NULL
+   每个函数的第一个参数是传给lept_parse_sax()的ctx 返回非0时中止解析
+   字符串和键以'\0'结尾 只在调用期间有效
+   结束事件的size是数组的元素个数或对象的成员个数
+*/
+typedef struct {
+    int (*on_null)(void* ctx);
+    int (*on_bool)(void* ctx, int b);
+    int (*on_number)(void* ctx, double n);
+    int (*on_string)(void* ctx, const char* s, size_t len);
+    int (*on_start_array)(void* ctx);
+    int (*on_end_array)(void* ctx, size_t size);
+    int (*on_start_object)(void* ctx);
+    int (*on_key)(void* ctx, const char* key, size_t klen);
+    int (*on_end_object)(void* ctx, size_t size);
+} lept_handler;
+
+/* 函数声明：事件驱动解析 不建立DOM 内存占用只和嵌套深度及最长的字符串有关
+   处理函数中止解析时返回LEPT_PARSE_STOPPED
+   出错时在此之前的事件已经发出
+*/
+int lept_parse_sax(const char* json, size_t len, const lept_handler* h, void* ctx);
+
+/* NDJSON每一行的回调 line是从1开始的行号 ret是这一行的解析结果 成功时v是解析出的值
+   回调返回后v被释放 需要保留时复制*v后对v调用lept_init()
+   返回非0时停止解析
+*/
+typedef int (*lept_ndjson_callback)(void* ctx, size_t line, int ret, lept_value* v);
+
+/* 函数声明：解析NDJSON(每行一个JSON文本) 空行跳过
+   nthreads为解析线程数 不大于0时使用所有CPU 不支持线程的平台上在调用线程中解析
+   ordered不为0时 回调在调用线程中按行的顺序逐个调用
+   否则回调在工作线程中并发调用 顺序不定 回调必须是线程安全的 停止后其他线程正在处理的一批记录仍可能回调
+   回调要求停止时返回LEPT_PARSE_STOPPED 否则返回LEPT_PARSE_OK 每行的错误通过回调报告
+*/
+int lept_parse_ndjson(const char* json, size_t len, int nthreads, int ordered, lept_ndjson_callback cb, void* ctx);
+
+/* 推送式解析器 输入可以分成任意大小的块依次送入 不需要先缓存整个文本
+   结果和错误码与一次性解析相同
+*/
+typedef struct lept_push_parser lept_push_parser;
+
+/* 建立DOM 成功时lept_push_finish()把结果写入v*/
+lept_push_parser* lept_push_parser_new(lept_value* v);
+/* 不建立DOM 事件交给h*/
+lept_push_parser* lept_push_parser_new_sax(const lept_handler* h, void* ctx);
+/* 数组和对象最多嵌套的层数 与lept_parse_options.max_depth相同 为0时使用默认的1024层 在送入输入之前设置*/
+void lept_push_parser_set_max_depth(lept_push_parser* p, size_t max_depth);
+/* 送入一块输入 返回目前为止的结果 出错后不再处理之后的输入*/
+int lept_push_feed(lept_push_parser* p, const char* chunk, size_t len);
+/* 输入结束 返回最终的结果 之后只能调用lept_push_parser_free()*/
+int lept_push_finish(lept_push_parser* p);
+void lept_push_parser_free(lept_push_parser* p);
+
+/* tape文档：只读的紧凑表示 所有值依次存放在一段连续的64位字中 字符串放在另一个缓冲区中
+   数组和对象带有跳转位置 越过一个容器是O(1)的 遍历时不需要追踪指针
+*/
+typedef struct lept_tape lept_tape;
+
+/* 指向tape中的一个值 tape重新解析或释放后失效*/
+typedef struct {
+    const lept_tape* tape;
+    size_t pos;
+} lept_cursor;
+
+lept_tape* lept_tape_new(void);
+/* 函数声明：解析JSON文本到tape 丢弃之前的内容 缓冲区在多次解析之间复用
+   返回值与lept_parse_n()相同 失败时tape为空
+*/
+int lept_tape_parse(lept_tape* t, const char* json, size_t len);
+void lept_tape_free(lept_tape* t);
+
+/* 根值的游标*/
+lept_cursor lept_tape_root(const lept_tape* t);
+/* 越过c处的值 O(1) 数组中得到下一个元素 对象中键和值依次排列*/
+lept_cursor lept_cursor_next(const lept_cursor* c);
+
+/* 与lept_get_*()对应的读取API 按下标访问需要越过之前的元素 是O(index)的
+   字符串以'\0'结尾 在tape有效期间有效
+*/
+lept_type lept_cursor_get_type(const lept_cursor* c);
+int lept_cursor_get_boolean(const lept_cursor* c);
+double lept_cursor_get_number(const lept_cursor* c);
+const char* lept_cursor_get_string(const lept_cursor* c);
+size_t lept_cursor_get_string_length(const lept_cursor* c);
+size_t lept_cursor_get_array_size(const lept_cursor* c);
+lept_cursor lept_cursor_get_array_element(const lept_cursor* c, size_t index);
+size_t lept_cursor_get_object_size(const lept_cursor* c);
+const char* lept_cursor_get_object_key(const lept_cursor* c, size_t index);
+size_t lept_cursor_get_object_key_length(const lept_cursor* c, size_t index);
+lept_cursor lept_cursor_get_object_value(const lept_cursor* c, size_t index);
+/* 找不到时返回的游标的tape为NULL*/
+lept_cursor lept_cursor_find_object_value(const lept_cursor* c, const char* key, size_t klen);
+
+/* 函数声明：把v保存为二进制快照 数字和字符串都已经转换好 内容只有偏移没有指针
+   成功时返回LEPT_PARSE_OK 无法写入时返回LEPT_PARSE_FILE_ERROR
+*/
+int lept_save_binary(const lept_value* v, const char* path);
+/* 函数声明：加载二进制快照 POSIX系统上只映射文件 不解析也不复制
+   加载时顺序检查一遍所有的偏移、长度和容器的结构 之后用游标直接读取映射的内容 lept_tape_free()时解除映射
+   文件不存在、版本、字节序或size_t不同、大小与文件头不符、内容损坏时返回NULL
+*/
+lept_tape* lept_load_binary(const char* path);
+
+/* 生成JSON文本的返回值*/
+enum {
+    LEPT_STRINGIFY_OK = 0,
+    LEPT_STRINGIFY_BUFFER_TOO_SMALL
+};
+
+/* 函数声明：生成JSON文本
+   返回以'\0'结尾的缓冲区 由调用者用全局分配器的free释放(默认即free()) length不为NULL时写入文本长度(不含'\0')
+   数字输出为能准确读回的最短形式 无穷和NaN输出为null
+*/
+char* lept_stringify(const lept_value* v, size_t* length);
+
+/* 函数声明：生成JSON文本到调用者的缓冲区buf中 不申请内存
+   buf需要能放下文本和结尾的'\0' 放不下时返回LEPT_STRINGIFY_BUFFER_TOO_SMALL
+   无论成功与否 length不为NULL时都写入完整文本的长度(不含'\0')
+*/
+int lept_stringify_buffer(const lept_value* v, char* buf, size_t size, size_t* length);
+
+/* 释放内存并将类型设置为NULL 内存还被其他副本共享时只减少引用计数*/
 void lept_free(lept_value* v);
 
+/* 函数声明：复制src到dst 数组、对象和长字符串与src共享内存 只增加引用计数 是O(1)的
+   共享同一份内存的值可以在多个线程中同时读取和释放 按需解析的值除外
+   下面的修改函数会先复制共享的一层 通过lept_get_array_element()等取得的指针修改子结点之前
+   先对容器调用lept_reserve_array()或lept_reserve_object() 否则会同时改变所有副本 同样dst不能是src中的子结点
+   src或者它的子孙的内存来自arena或原地解析的输入时深复制 副本不依赖它们
+   放入容器的值不会改变这个判断 来自arena或原地解析的值应当先用lept_copy()复制再放入 而不是lept_move()
+*/
+void lept_copy(lept_value* dst, const lept_value* src);
+/* 把src的内容转移到dst src变为null*/
+void lept_move(lept_value* dst, lept_value* src);
+void lept_swap(lept_value* lhs, lept_value* rhs);
+
 /* 函数声明：访问结果 获取类型*/
 lept_type lept_get_type(const lept_value* v);
 
@@ -85,9 +387,52 @@ void lept_set_string(lept_value* v, const char* s, size_t len);
 size_t lept_get_array_size(const lept_value* v);
 lept_value* lept_get_array_element(const lept_value* v, size_t index);
 
+/* 修改数组 容量不够时按1.5倍增长 尾部追加均摊O(1) 解析出的数组容量等于大小
+   修改之前数组的内存只属于v 与其他副本共享或者来自arena时先复制一层(子结点仍然共享)
+   返回的指针指向null结点 在下一次修改之前有效
+*/
+void lept_set_array(lept_value* v, size_t capacity);
+size_t lept_get_array_capacity(const lept_value* v);
+void lept_reserve_array(lept_value* v, size_t capacity);
+void lept_shrink_array(lept_value* v);
+void lept_clear_array(lept_value* v);
+lept_value* lept_pushback_array_element(lept_value* v);
+void lept_popback_array_element(lept_value* v);
+lept_value* lept_insert_array_element(lept_value* v, size_t index);
+void lept_erase_array_element(lept_value* v, size_t index, size_t count);
+
 size_t lept_get_object_size(const lept_value* v);
 const char* lept_get_object_key(const lept_value* v, size_t index);
 size_t lept_get_object_key_length(const lept_value* v, size_t index);
 lept_value* lept_get_object_value(const lept_value* v, size_t index);
 
+/* 按键查找成员 成员较多的对象在解析时建立散列索引 查找是O(1)的
+   找不到时分别返回LEPT_KEY_NOT_EXIST和NULL
+*/
+#define LEPT_KEY_NOT_EXIST ((size_t)-1)
+size_t lept_find_object_index(const lept_value* v, const char* key, size_t klen);
+lept_value* lept_find_object_value(const lept_value* v, const char* key, size_t klen);
+
+/* 修改对象 规则与数组相同 容量足够大时散列索引随成员一起维护
+   lept_set_object_value()返回键对应的值 键不存在时在末尾加入null成员
+   lept_remove_object_value()保持其余成员的顺序
+*/
+void lept_set_object(lept_value* v, size_t capacity);
+size_t lept_get_object_capacity(const lept_value* v);
+void lept_reserve_object(lept_value* v, size_t capacity);
+void lept_shrink_object(lept_value* v);
+void lept_clear_object(lept_value* v);
+lept_value* lept_set_object_value(lept_value* v, const char* key, size_t klen);
+void lept_remove_object_value(lept_value* v, size_t index);
+
+/* 比较两个值 数字按==比较(NaN与NaN相等) 字符串按字节比较 对象与成员顺序无关 按键通过索引查找
+   共享同一块内存的副本直接相等 有重复键的对象只有成员的顺序也完全相同时才相等
+*/
+int lept_is_equal(const lept_value* lhs, const lept_value* rhs);
+/* 散列值 相等的值散列值一定相同 对象与成员顺序无关
+   与其他副本共享的数组、对象和长字符串缓存散列值 再次计算和比较不同的缓存是O(1)的
+   缓存在只剩一个所有者时作废 通过取得的指针修改共享的子结点后缓存不再准确
+*/
+uint64_t lept_hash(const lept_value* v);
+
 #endif /* LEPTJSON_H__ */
\ No newline at end of file
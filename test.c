@@ -1,8 +1,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include "leptjson.h"
 
+#if !defined(LEPT_NO_THREADS) && (defined(__unix__) || defined(__APPLE__))
+    #define TEST_HAVE_PTHREADS
+    #include <pthread.h>
+#endif
+
 static int main_ret = 0;
 static int test_count = 0;
 static int test_pass = 0;
@@ -31,6 +37,80 @@ static int test_pass = 0;
 #define EXPECT_EQ_SIZE_T(expect, actual) EXPECT_EQ_BASE((expect) == (actual), (size_t)expect, (size_t)actual, "%zu")
 #endif
 
+/* 多线程的测试同时经过分配器 计数是原子的*/
+#if defined(__GNUC__) || defined(__clang__)
+    #define TEST_ATOMIC_ADD(p, n) __atomic_add_fetch(p, n, __ATOMIC_RELAXED)
+#else
+    #define TEST_ATOMIC_ADD(p, n) (*(p) += (n))
+#endif
+
+typedef struct {
+    size_t allocs; /* 申请的次数 realloc()只在p为NULL时计数*/
+    size_t live; /* 还没有释放的块数*/
+} test_alloc_count;
+
+static void* test_alloc(void* user, size_t size) {
+    test_alloc_count* n = (test_alloc_count*)user;
+    TEST_ATOMIC_ADD(&n->allocs, 1);
+    TEST_ATOMIC_ADD(&n->live, 1);
+    return malloc(size);
+}
+
+static void* test_realloc(void* user, void* p, size_t size) {
+    test_alloc_count* n = (test_alloc_count*)user;
+    if (p == NULL) {
+        TEST_ATOMIC_ADD(&n->allocs, 1);
+        TEST_ATOMIC_ADD(&n->live, 1);
+    }
+    return realloc(p, size);
+}
+
+static void test_dealloc(void* user, void* p) {
+    test_alloc_count* n = (test_alloc_count*)user;
+    if (p != NULL) {
+        TEST_ATOMIC_ADD(&n->live, (size_t)-1);
+    }
+    free(p);
+}
+
+/* 所有测试都经过这个分配器 结束时检查没有泄漏*/
+static test_alloc_count test_allocs = { 0, 0 };
+static const lept_allocator test_allocator = { test_alloc, test_realloc, test_dealloc, &test_allocs };
+
+/* lept_stringify()的结果由全局分配器释放*/
+static void free_json(char* s) {
+    test_allocator.free(test_allocator.user, s);
+}
+
+/* TEST_NUMBER、TEST_STRING和TEST_ROUNDTRIP中lept_parse()的次数和分配次数 最后报告平均每次解析的分配次数*/
+typedef struct {
+    const char* name;
+    size_t parses, allocs;
+} test_parse_count;
+
+static test_parse_count parse_counts[] = { { "number", 0, 0 }, { "string", 0, 0 }, { "roundtrip", 0, 0 } };
+
+static int counted_parse(test_parse_count* n, lept_value* v, const char* json) {
+    size_t allocs = test_allocs.allocs;
+    int ret = lept_parse(v, json);
+    n->parses++;
+    n->allocs += test_allocs.allocs - allocs;
+    return ret;
+}
+
+/* 用推送式解析器每次送入一个字节*/
+static int push_parse_bytes(lept_value* v, const char* json, size_t len) {
+    lept_push_parser* p = lept_push_parser_new(v);
+    size_t i;
+    int ret;
+    for (i = 0; i < len; i++) {
+        lept_push_feed(p, json + i, 1);
+    }
+    ret = lept_push_finish(p);
+    lept_push_parser_free(p);
+    return ret;
+}
+
 static void test_parse_null() {
     lept_value v;
     lept_init(&v);
@@ -62,7 +142,11 @@ static void test_parse_false() {
     do {\
         lept_value v;\
         lept_init(&v);\
-        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, counted_parse(&parse_counts[0], &v, json));\
+        EXPECT_EQ_INT(LEPT_NUMBER, lept_get_type(&v));\
+        EXPECT_EQ_DOUBLE(expect, lept_get_number(&v));\
+        lept_free(&v);\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, push_parse_bytes(&v, json, strlen(json)));\
         EXPECT_EQ_INT(LEPT_NUMBER, lept_get_type(&v));\
         EXPECT_EQ_DOUBLE(expect, lept_get_number(&v));\
         lept_free(&v);\
@@ -98,13 +182,25 @@ static void test_parse_number() {
     TEST_NUMBER(-2.2250738585072014e-308, "-2.2250738585072014e-308");
     TEST_NUMBER( 1.7976931348623157e+308, "1.7976931348623157e+308");  /* Max double */
     TEST_NUMBER(-1.7976931348623157e+308, "-1.7976931348623157e+308");
+
+    /* 需要正确舍入的情况 */
+    TEST_NUMBER(1e23, "1e23");
+    TEST_NUMBER(9007199254740992.0, "9007199254740993"); /* 恰好一半 向偶数舍入 */
+    TEST_NUMBER(9007199254740994.0, "9007199254740993.0000000000000000000001");
+    TEST_NUMBER(2.2250738585072011e-308, "2.2250738585072011e-308");
+    TEST_NUMBER(1.2345678901234568e+29, "123456789012345678901234567890");
+    TEST_NUMBER(1e-300, "0.0000000000000000000000000000000000000000000000000001e-248");
 }
 
 #define TEST_STRING(expect, json)\
     do {\
         lept_value v;\
         lept_init(&v);\
-        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, counted_parse(&parse_counts[1], &v, json));\
+        EXPECT_EQ_INT(LEPT_STRING, lept_get_type(&v));\
+        EXPECT_EQ_STRING(expect, lept_get_string(&v), lept_get_string_length(&v));\
+        lept_free(&v);\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, push_parse_bytes(&v, json, strlen(json)));\
         EXPECT_EQ_INT(LEPT_STRING, lept_get_type(&v));\
         EXPECT_EQ_STRING(expect, lept_get_string(&v), lept_get_string_length(&v));\
         lept_free(&v);\
@@ -121,6 +217,26 @@ static void test_parse_string() {
     TEST_STRING("\xE2\x82\xAC", "\"\\u20AC\""); /* Euro sign U+20AC */
     TEST_STRING("\xF0\x9D\x84\x9E", "\"\\uD834\\uDD1E\"");  /* G clef sign U+1D11E */
     TEST_STRING("\xF0\x9D\x84\x9E", "\"\\ud834\\udd1e\"");  /* G clef sign U+1D11E */
+
+    /* 跨越多个16/32字节块的普通字符和转义 */
+    TEST_STRING("0123456789abcdef0123456789abcdef0123456789abcdef",
+        "\"0123456789abcdef0123456789abcdef0123456789abcdef\"");
+    TEST_STRING("0123456789abcdef0123456789abcde\t0123456789abcdef\"0\\",
+        "\"0123456789abcdef0123456789abcde\\t0123456789abcdef\\\"0\\\\\"");
+    TEST_STRING("\xE2\x82\xAC" "0123456789abcdef0123456789abcdef\xE2\x82\xAC",
+        "\"\xE2\x82\xAC" "0123456789abcdef0123456789abcdef\\u20AC\"");
+}
+
+static void test_parse_whitespace() {
+    lept_value v;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "\n\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t[\r\n"
+        "                                        1 ,\r\n"
+        "                                        [ true ]\r\n"
+        "]                                                                          "));
+    EXPECT_EQ_INT(LEPT_ARRAY, lept_get_type(&v));
+    EXPECT_EQ_SIZE_T(2, lept_get_array_size(&v));
+    lept_free(&v);
 }
 
 static void test_parse_array() {
@@ -163,6 +279,100 @@ static void test_parse_array() {
     lept_free(&v);
 }
 
+static void test_parse_object() {
+    lept_value v;
+    size_t i;
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, " { } "));
+    EXPECT_EQ_INT(LEPT_OBJECT, lept_get_type(&v));
+    EXPECT_EQ_SIZE_T(0, lept_get_object_size(&v));
+    lept_free(&v);
+
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v,
+        " { "
+        "\"n\" : null , "
+        "\"f\" : false , "
+        "\"t\" : true , "
+        "\"i\" : 123 , "
+        "\"s\" : \"abc\", "
+        "\"a\" : [ 1, 2, 3 ],"
+        "\"o\" : { \"1\" : 1, \"2\" : 2, \"3\" : 3 }"
+        " } "
+    ));
+    EXPECT_EQ_INT(LEPT_OBJECT, lept_get_type(&v));
+    EXPECT_EQ_SIZE_T(7, lept_get_object_size(&v));
+    EXPECT_EQ_STRING("n", lept_get_object_key(&v, 0), lept_get_object_key_length(&v, 0));
+    EXPECT_EQ_INT(LEPT_NULL,   lept_get_type(lept_get_object_value(&v, 0)));
+    EXPECT_EQ_STRING("f", lept_get_object_key(&v, 1), lept_get_object_key_length(&v, 1));
+    EXPECT_EQ_INT(LEPT_FALSE,  lept_get_type(lept_get_object_value(&v, 1)));
+    EXPECT_EQ_STRING("t", lept_get_object_key(&v, 2), lept_get_object_key_length(&v, 2));
+    EXPECT_EQ_INT(LEPT_TRUE,   lept_get_type(lept_get_object_value(&v, 2)));
+    EXPECT_EQ_STRING("i", lept_get_object_key(&v, 3), lept_get_object_key_length(&v, 3));
+    EXPECT_EQ_INT(LEPT_NUMBER, lept_get_type(lept_get_object_value(&v, 3)));
+    EXPECT_EQ_DOUBLE(123.0, lept_get_number(lept_get_object_value(&v, 3)));
+    EXPECT_EQ_STRING("s", lept_get_object_key(&v, 4), lept_get_object_key_length(&v, 4));
+    EXPECT_EQ_INT(LEPT_STRING, lept_get_type(lept_get_object_value(&v, 4)));
+    EXPECT_EQ_STRING("abc", lept_get_string(lept_get_object_value(&v, 4)), lept_get_string_length(lept_get_object_value(&v, 4)));
+    EXPECT_EQ_STRING("a", lept_get_object_key(&v, 5), lept_get_object_key_length(&v, 5));
+    EXPECT_EQ_INT(LEPT_ARRAY, lept_get_type(lept_get_object_value(&v, 5)));
+    EXPECT_EQ_SIZE_T(3, lept_get_array_size(lept_get_object_value(&v, 5)));
+    for (i = 0; i < 3; i++) {
+        lept_value* e = lept_get_array_element(lept_get_object_value(&v, 5), i);
+        EXPECT_EQ_INT(LEPT_NUMBER, lept_get_type(e));
+        EXPECT_EQ_DOUBLE(i + 1.0, lept_get_number(e));
+    }
+    EXPECT_EQ_STRING("o", lept_get_object_key(&v, 6), lept_get_object_key_length(&v, 6));
+    {
+        lept_value* o = lept_get_object_value(&v, 6);
+        EXPECT_EQ_INT(LEPT_OBJECT, lept_get_type(o));
+        for (i = 0; i < 3; i++) {
+            lept_value* ov = lept_get_object_value(o, i);
+            EXPECT_TRUE('1' + i == (size_t)lept_get_object_key(o, i)[0]);
+            EXPECT_EQ_SIZE_T(1, lept_get_object_key_length(o, i));
+            EXPECT_EQ_INT(LEPT_NUMBER, lept_get_type(ov));
+            EXPECT_EQ_DOUBLE(i + 1.0, lept_get_number(ov));
+        }
+    }
+    EXPECT_EQ_SIZE_T(4, lept_find_object_index(&v, "s", 1));
+    EXPECT_EQ_STRING("abc", lept_get_string(lept_find_object_value(&v, "s", 1)), lept_get_string_length(lept_find_object_value(&v, "s", 1)));
+    EXPECT_EQ_SIZE_T(LEPT_KEY_NOT_EXIST, lept_find_object_index(&v, "x", 1));
+    EXPECT_TRUE(lept_find_object_value(&v, "x", 1) == NULL);
+    lept_free(&v);
+}
+
+static void test_find_object_value() {
+    char json[4096], key[16];
+    size_t i, n = 0, len;
+    lept_value v;
+    /* 成员较多的对象使用散列索引 */
+    n += sprintf(json + n, "{");
+    for (i = 0; i < 100; i++) {
+        n += sprintf(json + n, "%s\"key%u\":%u", i ? "," : "", (unsigned)i, (unsigned)i);
+    }
+    n += sprintf(json + n, ",\"key7\":\"duplicate\"}");
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+    EXPECT_EQ_SIZE_T(101, lept_get_object_size(&v));
+    for (i = 0; i < 100; i++) {
+        len = sprintf(key, "key%u", (unsigned)i);
+        EXPECT_EQ_SIZE_T(i, lept_find_object_index(&v, key, len));
+        EXPECT_EQ_DOUBLE((double)i, lept_get_number(lept_find_object_value(&v, key, len)));
+    }
+    EXPECT_EQ_SIZE_T(LEPT_KEY_NOT_EXIST, lept_find_object_index(&v, "key100", 6));
+    EXPECT_EQ_SIZE_T(LEPT_KEY_NOT_EXIST, lept_find_object_index(&v, "key", 3));
+    EXPECT_EQ_SIZE_T(LEPT_KEY_NOT_EXIST, lept_find_object_index(&v, "", 0));
+    lept_free(&v);
+
+    /* 原地解析的键引用输入缓冲区 */
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_insitu(&v, json, n));
+    EXPECT_EQ_SIZE_T(42, lept_find_object_index(&v, "key42", 5));
+    EXPECT_TRUE(lept_get_object_key(&v, 42) > json && lept_get_object_key(&v, 42) < json + n);
+    lept_set_number(lept_get_object_value(&v, 42), 1.0);
+    lept_free(&v);
+}
+
 #define TEST_ERROR(error, json)\
     do {\
         lept_value v;\
@@ -170,6 +380,9 @@ static void test_parse_array() {
         v.type = LEPT_FALSE;\
         EXPECT_EQ_INT(error, lept_parse(&v, json));\
         EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));\
+        v.type = LEPT_FALSE;\
+        EXPECT_EQ_INT(error, push_parse_bytes(&v, json, strlen(json)));\
+        EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));\
         lept_free(&v);\
     } while(0)
 
@@ -226,6 +439,7 @@ static void test_parse_invalid_string_escape() {
 static void test_parse_invalid_string_char() {
     TEST_ERROR(LEPT_PARSE_INVALID_STRING_CHAR, "\"\x01\"");
     TEST_ERROR(LEPT_PARSE_INVALID_STRING_CHAR, "\"\x1F\"");
+    TEST_ERROR(LEPT_PARSE_INVALID_STRING_CHAR, "\"0123456789abcdef0123456789abcdef\x1F\"");
 }
 
 static void test_parse_invalid_unicode_hex() {
@@ -259,13 +473,1109 @@ static void test_parse_miss_comma_or_square_bracket() {
     TEST_ERROR(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, "[[]");
 }
 
+static void test_parse_miss_key() {
+    TEST_ERROR(LEPT_PARSE_MISS_KEY, "{:1,");
+    TEST_ERROR(LEPT_PARSE_MISS_KEY, "{1:1,");
+    TEST_ERROR(LEPT_PARSE_MISS_KEY, "{true:1,");
+    TEST_ERROR(LEPT_PARSE_MISS_KEY, "{false:1,");
+    TEST_ERROR(LEPT_PARSE_MISS_KEY, "{null:1,");
+    TEST_ERROR(LEPT_PARSE_MISS_KEY, "{[]:1,");
+    TEST_ERROR(LEPT_PARSE_MISS_KEY, "{{}:1,");
+    TEST_ERROR(LEPT_PARSE_MISS_KEY, "{\"a\":1,");
+}
+
+static void test_parse_miss_colon() {
+    TEST_ERROR(LEPT_PARSE_MISS_COLON, "{\"a\"}");
+    TEST_ERROR(LEPT_PARSE_MISS_COLON, "{\"a\",\"b\"}");
+}
+
+static void test_parse_miss_comma_or_curly_bracket() {
+    TEST_ERROR(LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1");
+    TEST_ERROR(LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1]");
+    TEST_ERROR(LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":1 \"b\"");
+    TEST_ERROR(LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, "{\"a\":{}");
+}
+
+/* depth层嵌套的数组 最里面是一个对象*/
+static char* nested_json(size_t depth) {
+    char* json = (char*)malloc(depth * 2 + 3);
+    memset(json, '[', depth);
+    memcpy(json + depth, "{}", 2);
+    memset(json + depth + 2, ']', depth);
+    json[depth * 2 + 2] = '\0';
+    return json;
+}
+
+/*
+    生成、复制、比较和散列json的解析结果v 都成功时返回1 深复制的副本来自arena
+    在其他线程中调用 不使用EXPECT_*
+*/
+static int walk_deep(const lept_value* v, const char* json) {
+    lept_parse_options opts;
+    lept_arena a;
+    lept_value w, c;
+    char* out;
+    size_t len;
+    int ok;
+    out = lept_stringify(v, &len);
+    ok = len == strlen(json) && memcmp(json, out, len) == 0;
+    free_json(out);
+    lept_arena_init(&a, 0);
+    lept_parse_options_init(&opts);
+    opts.arena = &a;
+    opts.max_depth = len;
+    lept_init(&c);
+    ok = ok && lept_parse_ex(&w, json, strlen(json), &opts) == LEPT_PARSE_OK;
+    if (ok) {
+        lept_copy(&c, &w);
+        lept_free(&w);
+    }
+    lept_arena_destroy(&a);
+    ok = ok && lept_is_equal(v, &c) && lept_hash(v) == lept_hash(&c);
+    lept_free(&c);
+    return ok;
+}
+
+#ifdef TEST_HAVE_PTHREADS
+/* 在64KB的线程栈上解析、使用和释放默认限制以内最深的文本*/
+static void* deep_thread(void* p) {
+    char* json = nested_json(1023);
+    lept_value v;
+    int* ok = (int*)p;
+    *ok = lept_parse(&v, json) == LEPT_PARSE_OK && walk_deep(&v, json);
+    lept_free(&v);
+    free(json);
+    return NULL;
+}
+#endif
+
+static void test_parse_depth_exceeded() {
+    static const char* shallow = "[[1], {\"a\": 1}]";
+    static const char* deep = "[[1], {\"a\": []}]";
+#ifdef TEST_HAVE_PTHREADS
+    pthread_attr_t attr;
+    pthread_t thread;
+    int ok = 0;
+#endif
+    lept_parse_options opts;
+    lept_handler none = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+    lept_push_parser* pp;
+    lept_value v;
+    char* json;
+    lept_parse_options_init(&opts);
+    opts.max_depth = 2;
+    /* 默认1024层 对象也算一层*/
+    json = nested_json(1023);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+    EXPECT_EQ_INT(LEPT_ARRAY, lept_get_type(&v));
+    lept_free(&v);
+    free(json);
+    json = nested_json(1024);
+    TEST_ERROR(LEPT_PARSE_DEPTH_EXCEEDED, json);
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parse_sax(json, strlen(json), &none, NULL));
+    free(json);
+#ifdef TEST_HAVE_PTHREADS
+    pthread_attr_init(&attr);
+    EXPECT_EQ_INT(0, pthread_attr_setstacksize(&attr, 64 * 1024));
+    EXPECT_EQ_INT(0, pthread_create(&thread, &attr, deep_thread, &ok));
+    pthread_join(thread, NULL);
+    pthread_attr_destroy(&attr);
+    EXPECT_TRUE(ok);
+#endif
+
+    /* 限制可以放宽 解析和遍历都不递归 C栈的用量不随深度增长*/
+    json = nested_json(100000);
+    opts.max_depth = 100001;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v, json, strlen(json), &opts));
+    EXPECT_TRUE(walk_deep(&v, json));
+    lept_free(&v);
+    opts.flags = LEPT_PARSE_LAZY;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v, json, strlen(json), &opts));
+    lept_free(&v);
+    opts.max_depth = 100000;
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parse_ex(&v, json, strlen(json), &opts));
+    free(json);
+
+    opts.flags = 0;
+    opts.max_depth = 2;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v, shallow, strlen(shallow), &opts));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_parse_ex(&v, deep, strlen(deep), &opts));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+
+    /* 推送式解析器使用同样的限制*/
+    pp = lept_push_parser_new(&v);
+    lept_push_parser_set_max_depth(pp, 2);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_feed(pp, shallow, strlen(shallow)));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_finish(pp));
+    lept_push_parser_free(pp);
+    lept_free(&v);
+    pp = lept_push_parser_new(&v);
+    lept_push_parser_set_max_depth(pp, 2);
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_push_feed(pp, deep, strlen(deep)));
+    EXPECT_EQ_INT(LEPT_PARSE_DEPTH_EXCEEDED, lept_push_finish(pp));
+    lept_push_parser_free(pp);
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+}
+
+static void test_parse_arena() {
+    lept_arena a;
+    lept_value v;
+    size_t i;
+
+    lept_arena_init(&a, 64);
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_arena(&v, &a, "[ \"abc\" , [ 1 , \"Hello\\nWorld\" ] , [ ] ]"));
+    EXPECT_EQ_INT(LEPT_ARRAY, lept_get_type(&v));
+    EXPECT_EQ_SIZE_T(3, lept_get_array_size(&v));
+    EXPECT_EQ_STRING("abc", lept_get_string(lept_get_array_element(&v, 0)), lept_get_string_length(lept_get_array_element(&v, 0)));
+    EXPECT_EQ_SIZE_T(2, lept_get_array_size(lept_get_array_element(&v, 1)));
+    EXPECT_EQ_STRING("Hello\nWorld",
+        lept_get_string(lept_get_array_element(lept_get_array_element(&v, 1), 1)),
+        lept_get_string_length(lept_get_array_element(lept_get_array_element(&v, 1), 1)));
+    EXPECT_EQ_SIZE_T(0, lept_get_array_size(lept_get_array_element(&v, 2)));
+    /* 对arena中的值调用lept_free()是安全的 */
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+
+    /* reset之后arena可以复用 大于块大小的字符串单独分配 */
+    lept_arena_reset(&a);
+    for (i = 0; i < 3; i++) {
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_arena(&v, &a, "\"0123456789012345678901234567890123456789\""));
+        EXPECT_EQ_SIZE_T(40, lept_get_string_length(&v));
+    }
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_parse_arena(&v, &a, "[\"abc\", [1, 2"));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_parse_arena(&v, &a, "[\"abc\"] x"));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_arena(&v, &a, "{\"a\":{\"b\":[\"c\"]}}"));
+    EXPECT_EQ_STRING("c", lept_get_string(lept_get_array_element(lept_find_object_value(lept_find_object_value(&v, "a", 1), "b", 1), 0)), 1);
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COLON, lept_parse_arena(&v, &a, "{\"a\":{\"b\" 1}}"));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+    lept_arena_destroy(&a);
+}
+
+static void test_parse_insitu() {
+    char json[] = "[ \"abc\" , \"Hello\\nWorld\" , [ \"\\u20AC\\uD834\\uDD1E\\\"x\" ] , 1.5 , \"\" ]";
+    char bad[] = "[\"abc\", \"\\v\"]";
+    lept_value v;
+    lept_value* e;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_insitu(&v, json, sizeof(json) - 1));
+    EXPECT_EQ_INT(LEPT_ARRAY, lept_get_type(&v));
+    EXPECT_EQ_SIZE_T(5, lept_get_array_size(&v));
+    e = lept_get_array_element(&v, 0);
+    EXPECT_EQ_STRING("abc", lept_get_string(e), lept_get_string_length(e));
+    /* 字符串引用输入缓冲区 */
+    EXPECT_TRUE(lept_get_string(e) >= json && lept_get_string(e) < json + sizeof(json));
+    e = lept_get_array_element(&v, 1);
+    EXPECT_EQ_STRING("Hello\nWorld", lept_get_string(e), lept_get_string_length(e));
+    EXPECT_EQ_INT('\0', lept_get_string(e)[lept_get_string_length(e)]);
+    e = lept_get_array_element(lept_get_array_element(&v, 2), 0);
+    EXPECT_EQ_STRING("\xE2\x82\xAC\xF0\x9D\x84\x9E\"x", lept_get_string(e), lept_get_string_length(e));
+    EXPECT_EQ_DOUBLE(1.5, lept_get_number(lept_get_array_element(&v, 3)));
+    e = lept_get_array_element(&v, 4);
+    EXPECT_EQ_STRING("", lept_get_string(e), lept_get_string_length(e));
+    lept_free(&v);
+
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_STRING_ESCAPE, lept_parse_insitu(&v, bad, sizeof(bad) - 1));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+}
+
+static void test_parse_n() {
+    lept_value v;
+    lept_init(&v);
+    /* 长度之后的内容不属于输入 */
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, "[ 1 , \"ab\" ]xyz", 12));
+    EXPECT_EQ_INT(LEPT_ARRAY, lept_get_type(&v));
+    EXPECT_EQ_SIZE_T(2, lept_get_array_size(&v));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v, "123456", 3));
+    EXPECT_EQ_DOUBLE(123.0, lept_get_number(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_VALUE, lept_parse_n(&v, "null", 3));
+    EXPECT_EQ_INT(LEPT_PARSE_EXPECT_VALUE, lept_parse_n(&v, "null", 0));
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_QUOTATION_MARK, lept_parse_n(&v, "\"abc\"", 4));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_UNICODE_HEX, lept_parse_n(&v, "\"\\u0041\"", 5));
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_parse_n(&v, "[1]", 2));
+    /* '\0'不再表示输入结束 */
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_STRING_CHAR, lept_parse_n(&v, "\"a\0b\"", 5));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_parse_n(&v, "1\0", 2));
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_VALUE, lept_parse_n(&v, "\0", 1));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+}
+
+static void test_parse_file() {
+    const char* path = "leptjson_test_file.json";
+    FILE* fp;
+    lept_value v;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_FILE_ERROR, lept_parse_file(&v, "leptjson_no_such_file.json"));
+    if ((fp = fopen(path, "wb")) == NULL) {
+        return;
+    }
+    fputs(" [ \"Hello\\nWorld\" , [ 1.5 ] ]\n", fp);
+    fclose(fp);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_file(&v, path));
+    EXPECT_EQ_INT(LEPT_ARRAY, lept_get_type(&v));
+    EXPECT_EQ_SIZE_T(2, lept_get_array_size(&v));
+    EXPECT_EQ_STRING("Hello\nWorld", lept_get_string(lept_get_array_element(&v, 0)), lept_get_string_length(lept_get_array_element(&v, 0)));
+    lept_free(&v);
+    if ((fp = fopen(path, "wb")) != NULL) {
+        fclose(fp);
+        EXPECT_EQ_INT(LEPT_PARSE_EXPECT_VALUE, lept_parse_file(&v, path));
+    }
+    remove(path);
+}
+
+/* 把事件记录成文本 达到limit个事件时中止*/
+typedef struct {
+    char buf[256];
+    size_t len;
+    int count, limit;
+} sax_log;
+
+static int sax_put(void* ctx, const char* s, size_t n) {
+    sax_log* log = (sax_log*)ctx;
+    if (log->len + n < sizeof(log->buf)) {
+        memcpy(log->buf + log->len, s, n);
+        log->len += n;
+        log->buf[log->len] = '\0';
+    }
+    return ++log->count == log->limit;
+}
+
+static int sax_null(void* ctx) { return sax_put(ctx, "n ", 2); }
+static int sax_bool(void* ctx, int b) { return sax_put(ctx, b ? "t " : "f ", 2); }
+static int sax_number(void* ctx, double n) {
+    char buf[32];
+    sprintf(buf, "%g ", n);
+    return sax_put(ctx, buf, strlen(buf));
+}
+static int sax_string(void* ctx, const char* s, size_t len) {
+    char buf[64];
+    EXPECT_EQ_INT('\0', s[len]);
+    sprintf(buf, "s:%.*s ", (int)len, s);
+    return sax_put(ctx, buf, strlen(buf));
+}
+static int sax_start_array(void* ctx) { return sax_put(ctx, "[ ", 2); }
+static int sax_end_array(void* ctx, size_t size) {
+    char buf[32];
+    sprintf(buf, "]%d ", (int)size);
+    return sax_put(ctx, buf, strlen(buf));
+}
+static int sax_start_object(void* ctx) { return sax_put(ctx, "{ ", 2); }
+static int sax_key(void* ctx, const char* key, size_t klen) {
+    char buf[64];
+    EXPECT_EQ_INT('\0', key[klen]);
+    sprintf(buf, "k:%.*s ", (int)klen, key);
+    return sax_put(ctx, buf, strlen(buf));
+}
+static int sax_end_object(void* ctx, size_t size) {
+    char buf[32];
+    sprintf(buf, "}%d ", (int)size);
+    return sax_put(ctx, buf, strlen(buf));
+}
+
+static const lept_handler sax_log_handler = {
+    sax_null, sax_bool, sax_number, sax_string,
+    sax_start_array, sax_end_array, sax_start_object, sax_key, sax_end_object
+};
+
+#define TEST_SAX(expect, json)\
+    do {\
+        sax_log log;\
+        log.len = 0;\
+        log.buf[0] = '\0';\
+        log.count = log.limit = 0;\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_sax(json, strlen(json), &sax_log_handler, &log));\
+        EXPECT_EQ_STRING(expect, log.buf, log.len);\
+    } while(0)
+
+static void test_parse_sax() {
+    sax_log log;
+    const char* json = " { \"a\" : [ 1 , 2.5, \"x\\ty\" ] , \"b\" : { } , \"c\" : [ null , true , false ] } ";
+    lept_handler none = { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+    TEST_SAX("n ", "null");
+    TEST_SAX("s:Hello ", "\"Hello\"");
+    TEST_SAX("[ ]0 ", "[ ]");
+    TEST_SAX("{ k:a [ 1 2.5 s:x\ty ]3 k:b { }0 k:c [ n t f ]3 }3 ", json);
+
+    /* 处理函数返回非0时中止*/
+    log.len = 0;
+    log.count = 0;
+    log.limit = 4;
+    EXPECT_EQ_INT(LEPT_PARSE_STOPPED, lept_parse_sax(json, strlen(json), &sax_log_handler, &log));
+    EXPECT_EQ_INT(4, log.count);
+    EXPECT_EQ_STRING("{ k:a [ 1 ", log.buf, log.len);
+
+    /* 出错时之前的事件已经发出*/
+    log.len = 0;
+    log.count = log.limit = 0;
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_parse_sax("[1 2]", 5, &sax_log_handler, &log));
+    EXPECT_EQ_STRING("[ 1 ", log.buf, log.len);
+
+    /* 处理函数都为NULL时只做校验*/
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_sax(json, strlen(json), &none, NULL));
+    EXPECT_EQ_INT(LEPT_PARSE_EXPECT_VALUE, lept_parse_sax(" ", 1, &none, NULL));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, lept_parse_sax("[] x", 4, &none, NULL));
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COLON, lept_parse_sax("{\"a\"}", 5, &none, NULL));
+}
+
+static void test_parse_push() {
+    static const char* docs[] = {
+        "null", " true ", "-1.5e+10", "\"Hello\\n\\u20AC\\uD834\\uDD1E\"",
+        "[ ]", "{ }", " [ 1 , [ 2 , [ ] ] , { \"a\" : [ null , false ] } , \"x\" ] ",
+        "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}"
+    };
+    static const size_t chunks[] = { 1, 2, 3, 7, 1000 };
+    size_t i, j, k;
+    for (i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) {
+        lept_value v, v2;
+        char *json, *json2;
+        size_t len = strlen(docs[i]);
+        lept_init(&v);
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, docs[i]));
+        json = lept_stringify(&v, NULL);
+        /* 按不同大小分块送入 结果应与一次性解析相同*/
+        for (j = 0; j < sizeof(chunks) / sizeof(chunks[0]); j++) {
+            lept_push_parser* p = lept_push_parser_new(&v2);
+            for (k = 0; k < len; k += chunks[j]) {
+                EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_feed(p, docs[i] + k, len - k < chunks[j] ? len - k : chunks[j]));
+            }
+            EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_finish(p));
+            lept_push_parser_free(p);
+            json2 = lept_stringify(&v2, NULL);
+            EXPECT_EQ_BASE(strcmp(json, json2) == 0, json, json2, "%s");
+            free_json(json2);
+            lept_free(&v2);
+        }
+        free_json(json);
+        lept_free(&v);
+    }
+}
+
+static void test_parse_push_sax() {
+    const char* json = " { \"a\" : [ 1 , 2.5, \"x\\ty\" ] , \"b\" : { } , \"c\" : [ null , true , false ] } ";
+    lept_push_parser* p;
+    lept_value v;
+    sax_log log;
+    size_t i;
+    log.len = 0;
+    log.buf[0] = '\0';
+    log.count = log.limit = 0;
+    p = lept_push_parser_new_sax(&sax_log_handler, &log);
+    for (i = 0; json[i]; i++) {
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_feed(p, json + i, 1));
+    }
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_finish(p));
+    lept_push_parser_free(p);
+    EXPECT_EQ_STRING("{ k:a [ 1 2.5 s:x\ty ]3 k:b { }0 k:c [ n t f ]3 }3 ", log.buf, log.len);
+
+    /* 中止之后不再处理输入*/
+    log.len = 0;
+    log.count = 0;
+    log.limit = 4;
+    p = lept_push_parser_new_sax(&sax_log_handler, &log);
+    EXPECT_EQ_INT(LEPT_PARSE_STOPPED, lept_push_feed(p, json, strlen(json)));
+    EXPECT_EQ_INT(LEPT_PARSE_STOPPED, lept_push_feed(p, json, strlen(json)));
+    EXPECT_EQ_INT(LEPT_PARSE_STOPPED, lept_push_finish(p));
+    lept_push_parser_free(p);
+    EXPECT_EQ_STRING("{ k:a [ 1 ", log.buf, log.len);
+
+    /* 没有调用lept_push_finish()也可以释放 建立了一半的DOM一起释放*/
+    p = lept_push_parser_new(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_feed(p, "[1, [\"abc\", {\"k\": 2", 19));
+    lept_push_parser_free(p);
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+}
+
+/* 每一行的结果按行号记录 各行互不干扰 无序模式下也不需要加锁*/
+typedef struct {
+    int ret[4001];
+    double n[4001];
+    size_t last; /* 有序模式下检查行号递增*/
+    int ordered, in_order, stop_at;
+} ndjson_log;
+
+static int ndjson_record(void* ctx, size_t line, int ret, lept_value* v) {
+    ndjson_log* log = (ndjson_log*)ctx;
+    if (line < 1 || line > 4000) {
+        return 1;
+    }
+    log->ret[line] = ret;
+    if (ret == LEPT_PARSE_OK) {
+        log->n[line] = lept_get_number(lept_get_array_element(v, 0));
+    }
+    if (log->ordered) {
+        log->in_order &= line > log->last;
+        log->last = line;
+    }
+    return (size_t)log->stop_at == line;
+}
+
+static void test_parse_ndjson() {
+    static ndjson_log log;
+    static const int threads[] = { 1, 4 };
+    char* buf = (char*)malloc(4000 * 64);
+    size_t len = 0, i, j;
+    /* 第i行: 每7行一个空行 每13行一个错误 其余是[i, ...] 部分行用\r\n结尾 总长度超过一批*/
+    for (i = 1; i <= 4000; i++) {
+        if (i % 7 == 0) {
+            len += sprintf(buf + len, i % 2 ? "\n" : "  \r\n");
+        }
+        else if (i % 13 == 0) {
+            len += sprintf(buf + len, "[%d, ]\n", (int)i);
+        }
+        else {
+            len += sprintf(buf + len, i % 2 ? "[%d, \"0123456789abcdef0123456789abcdef\"]\n" : " [%d, {\"0123456789abcdef\": 0}]\r\n", (int)i);
+        }
+    }
+    len--; /* 最后一行没有换行符*/
+    for (i = 0; i < sizeof(threads) / sizeof(threads[0]); i++) {
+        for (j = 0; j < 2; j++) {
+            size_t k;
+            int ok = 1;
+            memset(&log, 0, sizeof(log));
+            log.ordered = (int)j;
+            log.in_order = 1;
+            EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ndjson(buf, len, threads[i], (int)j, ndjson_record, &log));
+            for (k = 1; k <= 4000; k++) {
+                if (k % 7 == 0) {
+                    ok &= log.ret[k] == 0 && log.n[k] == 0.0;
+                }
+                else if (k % 13 == 0) {
+                    ok &= log.ret[k] == LEPT_PARSE_INVALID_VALUE;
+                }
+                else {
+                    ok &= log.ret[k] == LEPT_PARSE_OK && log.n[k] == (double)k;
+                }
+            }
+            EXPECT_TRUE(ok);
+            EXPECT_TRUE(log.in_order);
+        }
+        /* 有序模式下停止之后不再回调*/
+        memset(&log, 0, sizeof(log));
+        log.ordered = 1;
+        log.in_order = 1;
+        log.stop_at = 2000;
+        EXPECT_EQ_INT(LEPT_PARSE_STOPPED, lept_parse_ndjson(buf, len, threads[i], 1, ndjson_record, &log));
+        EXPECT_EQ_SIZE_T(2000, log.last);
+    }
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ndjson(NULL, 0, 0, 1, ndjson_record, &log));
+    free(buf);
+}
+
+/* 按需解析展开时按64字节一块越过数组和对象*/
+static void test_parse_lazy_skip() {
+    lept_parse_options opts;
+    lept_value v1, v2;
+    char* buf = (char*)malloc(200 * 160);
+    char *s1, *s2;
+    size_t len = 0, i, j;
+    lept_parse_options_init(&opts);
+    opts.flags = LEPT_PARSE_LAZY;
+    /* 第i个字符串有i % 130个字符 以不同长度的'\\'串和转义的'"'结尾 引号落在块内的各个位置*/
+    len += sprintf(buf + len, "{\"list\" : [\n");
+    for (i = 0; i < 200; i++) {
+        len += sprintf(buf + len, "  {\"k%d\":\"", (int)i);
+        for (j = 0; j < i % 130; j++) {
+            buf[len++] = (char)('a' + j % 26);
+        }
+        for (j = 0; j < i % 5; j++) {
+            len += sprintf(buf + len, "\\\\");
+        }
+        len += sprintf(buf + len, i % 3 ? "\\\"{[,:]}\", \"n\": [-1.5e3, true, false, null, {}]}" : "\",\"n\":%d}", (int)i);
+        len += sprintf(buf + len, i < 199 ? ",\n" : "\n]}");
+    }
+    lept_init(&v1);
+    lept_init(&v2);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v1, buf, len));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v2, buf, len, &opts));
+    s1 = lept_stringify(&v1, NULL);
+    s2 = lept_stringify(&v2, NULL);
+    EXPECT_EQ_BASE(strcmp(s1, s2) == 0, "same", "different", "%s");
+    free_json(s1);
+    free_json(s2);
+    lept_free(&v1);
+    lept_free(&v2);
+    /* 每个前缀都出错 错误码与逐字节的解析器相同*/
+    for (i = 0; i < len; i += 7) {
+        int ret = lept_parse_n(&v1, buf, i);
+        EXPECT_EQ_INT(ret, lept_parse_ex(&v2, buf, i, &opts));
+        EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v2));
+    }
+    free(buf);
+}
+
+/* 递归比较tape中的值和DOM*/
+static int tape_equal(const lept_cursor* c, const lept_value* v) {
+    lept_cursor e;
+    size_t i;
+    if (lept_cursor_get_type(c) != lept_get_type(v)) {
+        return 0;
+    }
+    switch (lept_get_type(v)) {
+        case LEPT_NUMBER:
+            return lept_cursor_get_number(c) == lept_get_number(v);
+        case LEPT_STRING:
+            return lept_cursor_get_string_length(c) == lept_get_string_length(v) &&
+                memcmp(lept_cursor_get_string(c), lept_get_string(v), lept_get_string_length(v) + 1) == 0;
+        case LEPT_ARRAY:
+            if (lept_cursor_get_array_size(c) != lept_get_array_size(v)) {
+                return 0;
+            }
+            /* 顺序遍历用lept_cursor_next() 同时检查按下标访问*/
+            for (i = 0; i < lept_get_array_size(v); i++) {
+                lept_cursor x = lept_cursor_get_array_element(c, i);
+                e = i ? lept_cursor_next(&e) : x;
+                if (e.pos != x.pos || !tape_equal(&e, lept_get_array_element(v, i))) {
+                    return 0;
+                }
+            }
+            return 1;
+        case LEPT_OBJECT:
+            if (lept_cursor_get_object_size(c) != lept_get_object_size(v)) {
+                return 0;
+            }
+            for (i = 0; i < lept_get_object_size(v); i++) {
+                if (lept_cursor_get_object_key_length(c, i) != lept_get_object_key_length(v, i) ||
+                    memcmp(lept_cursor_get_object_key(c, i), lept_get_object_key(v, i), lept_get_object_key_length(v, i) + 1) != 0) {
+                    return 0;
+                }
+                e = lept_cursor_get_object_value(c, i);
+                if (!tape_equal(&e, lept_get_object_value(v, i))) {
+                    return 0;
+                }
+            }
+            return 1;
+        default:
+            return 1;
+    }
+}
+
+static void test_parse_tape() {
+    static const char* json[] = {
+        "null", "true", " false ", "-1.5e300", "\"Hello\\u0000World\"", "[]", "{}", "[[], {}, [[1]]]",
+        "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}",
+        "[1, \"a\", {\"k\": [true, {\"x\": \"\"}]}, [null, [false]], 2.5]"
+    };
+    static const char* bad[] = { "", "nul", "[1,]", "{\"a\" 1}", "[\"\\x\"]", "{\"a\":1} x" };
+    lept_tape* t = lept_tape_new();
+    lept_value v;
+    lept_cursor c, e;
+    size_t i;
+    for (i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        lept_init(&v);
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json[i]));
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_tape_parse(t, json[i], strlen(json[i])));
+        c = lept_tape_root(t);
+        EXPECT_TRUE(tape_equal(&c, &v));
+        lept_free(&v);
+    }
+    for (i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        EXPECT_EQ_INT(lept_parse(&v, bad[i]), lept_tape_parse(t, bad[i], strlen(bad[i])));
+    }
+    /* 越过容器 按键查找*/
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_tape_parse(t, "{\"a\":[[1,2],{\"b\":3}],\"c\":\"x\"}", 29));
+    c = lept_tape_root(t);
+    e = lept_cursor_find_object_value(&c, "c", 1);
+    EXPECT_TRUE(e.tape != NULL);
+    EXPECT_EQ_STRING("x", lept_cursor_get_string(&e), lept_cursor_get_string_length(&e));
+    e = lept_cursor_find_object_value(&c, "b", 1);
+    EXPECT_TRUE(e.tape == NULL);
+    e = lept_cursor_get_object_value(&c, 0);
+    e = lept_cursor_next(&e);
+    EXPECT_EQ_STRING("c", lept_cursor_get_string(&e), lept_cursor_get_string_length(&e));
+    lept_tape_free(t);
+}
+
+/* 访问tape中的每个值 返回值的个数*/
+static size_t tape_walk(const lept_cursor* c) {
+    lept_cursor e;
+    size_t i, n = 1;
+    switch (lept_cursor_get_type(c)) {
+        case LEPT_NUMBER:
+            (void)lept_cursor_get_number(c);
+            return 1;
+        case LEPT_STRING:
+            return lept_cursor_get_string(c)[lept_cursor_get_string_length(c)] == '\0' ? 1 : 0;
+        case LEPT_ARRAY:
+            for (i = 0; i < lept_cursor_get_array_size(c); i++) {
+                e = lept_cursor_get_array_element(c, i);
+                n += tape_walk(&e);
+            }
+            return n;
+        case LEPT_OBJECT:
+            for (i = 0; i < lept_cursor_get_object_size(c); i++) {
+                n += lept_cursor_get_object_key(c, i)[lept_cursor_get_object_key_length(c, i)] == '\0';
+                e = lept_cursor_get_object_value(c, i);
+                n += tape_walk(&e);
+            }
+            return n;
+        default:
+            return 1;
+    }
+}
+
+static void test_parse_binary() {
+    static const char* json[] = {
+        "null", "true", "-1.5e300", "\"Hello\\u0000World\"", "[]", "{}", "[[], {}, [[1]]]",
+        "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"a long string that is not inline\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2}}"
+    };
+    const char* path = "leptjson_test_file.bin";
+    lept_parse_options opts;
+    lept_tape* t;
+    lept_value v;
+    lept_cursor c;
+    FILE* fp;
+    char buf[512];
+    size_t i, len;
+    lept_parse_options_init(&opts);
+    opts.flags = LEPT_PARSE_LAZY;
+    EXPECT_TRUE(lept_load_binary("leptjson_no_such_file.bin") == NULL);
+    for (i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json[i]));
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_save_binary(&v, path));
+        EXPECT_TRUE((t = lept_load_binary(path)) != NULL);
+        if (t) {
+            c = lept_tape_root(t);
+            EXPECT_TRUE(tape_equal(&c, &v));
+            lept_tape_free(t);
+        }
+        lept_free(&v);
+    }
+    /* 按需解析的结果保存时展开*/
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v, json[7], strlen(json[7]), &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_save_binary(&v, path));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json[7]));
+    EXPECT_TRUE((t = lept_load_binary(path)) != NULL);
+    if (t) {
+        c = lept_tape_root(t);
+        EXPECT_TRUE(tape_equal(&c, &v));
+        /* 加载的tape也可以用于解析*/
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_tape_parse(t, "[1]", 3));
+        c = lept_tape_root(t);
+        EXPECT_EQ_SIZE_T(1, lept_cursor_get_array_size(&c));
+        lept_tape_free(t);
+    }
+    lept_free(&v);
+    if ((fp = fopen(path, "rb")) == NULL) {
+        return;
+    }
+    len = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+    /* 截断 多出字节 版本不同的文件都拒绝加载*/
+    for (i = 0; i < 4; i++) {
+        static const size_t cut[] = { 0, 16, 40, 1 };
+        if ((fp = fopen(path, "wb")) != NULL) {
+            fwrite(buf, 1, i < 3 ? cut[i] : len - 1, fp);
+            fclose(fp);
+            EXPECT_TRUE(lept_load_binary(path) == NULL);
+        }
+    }
+    if ((fp = fopen(path, "wb")) != NULL) {
+        fwrite(buf, 1, len, fp);
+        fputc(0, fp);
+        fclose(fp);
+        EXPECT_TRUE(lept_load_binary(path) == NULL);
+    }
+    /* 内容损坏的文件要么拒绝加载 要么所有的访问都在文件之内 文件头占40个字节*/
+    for (i = 40; i < len; i++) {
+        buf[i] = (char)~buf[i];
+        if ((fp = fopen(path, "wb")) != NULL) {
+            fwrite(buf, 1, len, fp);
+            fclose(fp);
+            if ((t = lept_load_binary(path)) != NULL) {
+                c = lept_tape_root(t);
+                EXPECT_TRUE(tape_walk(&c) > 0);
+                lept_tape_free(t);
+            }
+        }
+        buf[i] = (char)~buf[i];
+    }
+    buf[8]++;
+    if ((fp = fopen(path, "wb")) != NULL) {
+        fwrite(buf, 1, len, fp);
+        fclose(fp);
+        EXPECT_TRUE(lept_load_binary(path) == NULL);
+    }
+    remove(path);
+}
+
+static void test_parse_lazy() {
+    lept_parse_options opts;
+    static const char* json[] = {
+        "null", " 1.5e3 ", "\"a\\\"b\\\\\"", "[]", "{}", "[ 1 , [ ] , { } ,\"]\", {\"}\" : [\"\\\\\"]}]",
+        "{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}"
+    };
+    static const char* bad[] = { "", "nul", "[1,]", "{\"a\" 1}", "[\"\\x\"]", "{\"a\":1} x", "[1e309]" };
+    lept_value v1, v2;
+    lept_value* e;
+    char *s1, *s2;
+    char* buf = (char*)malloc(300 * 120);
+    size_t len = 0, i, j;
+    lept_parse_options_init(&opts);
+    opts.flags = LEPT_PARSE_LAZY;
+    /* 展开全部结点后与一次性解析相同*/
+    for (i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v1, json[i]));
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v2, json[i], strlen(json[i]), &opts));
+        EXPECT_EQ_INT(lept_get_type(&v1), lept_get_type(&v2));
+        s1 = lept_stringify(&v1, NULL);
+        s2 = lept_stringify(&v2, NULL);
+        EXPECT_EQ_BASE(strcmp(s1, s2) == 0, s1, s2, "%s");
+        free_json(s1);
+        free_json(s2);
+        lept_free(&v1);
+        lept_free(&v2);
+    }
+    for (i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        v2.type = LEPT_FALSE;
+        EXPECT_EQ_INT(lept_parse(&v1, bad[i]), lept_parse_ex(&v2, bad[i], strlen(bad[i]), &opts));
+        EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v2));
+    }
+    /* 长数组中只访问个别成员 越过的子树中有跨越64字节的字符串和各种括号*/
+    len += sprintf(buf + len, "{\"items\": [");
+    for (i = 0; i < 300; i++) {
+        len += sprintf(buf + len, "%s{\"id\": %d, \"tags\": [\"", i ? ", " : "", (int)i);
+        for (j = 0; j < i % 70; j++) {
+            buf[len++] = "[]{}\\\"x"[j % 7];
+            if (buf[len - 1] == '\\' || buf[len - 1] == '\"') {
+                buf[len - 1] = '\\';
+                buf[len++] = j % 2 ? '\\' : '\"';
+            }
+        }
+        len += sprintf(buf + len, "\", [[%d]]], \"name\": \"n%d\"}", (int)i, (int)i);
+    }
+    len += sprintf(buf + len, "], \"count\": 300}");
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v2, buf, len, &opts));
+    EXPECT_EQ_DOUBLE(300.0, lept_get_number(lept_find_object_value(&v2, "count", 5)));
+    e = lept_find_object_value(&v2, "items", 5);
+    EXPECT_EQ_SIZE_T(300, lept_get_array_size(e));
+    e = lept_get_array_element(e, 299);
+    EXPECT_EQ_DOUBLE(299.0, lept_get_number(lept_find_object_value(e, "id", 2)));
+    EXPECT_EQ_STRING("n299", lept_get_string(lept_find_object_value(e, "name", 4)), lept_get_string_length(lept_find_object_value(e, "name", 4)));
+    e = lept_get_array_element(lept_find_object_value(e, "tags", 4), 1);
+    EXPECT_EQ_DOUBLE(299.0, lept_get_number(lept_get_array_element(lept_get_array_element(e, 0), 0)));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_n(&v1, buf, len));
+    s1 = lept_stringify(&v1, NULL);
+    s2 = lept_stringify(&v2, NULL);
+    EXPECT_EQ_BASE(strcmp(s1, s2) == 0, "same", "different", "%s");
+    free_json(s1);
+    free_json(s2);
+    lept_free(&v1);
+    lept_free(&v2);
+    free(buf);
+}
+
+#define TEST_PROJECTION(expect, json, ...)\
+    do {\
+        static const char* paths[] = { __VA_ARGS__ };\
+        lept_projection* p = lept_projection_compile(paths, sizeof(paths) / sizeof(paths[0]));\
+        lept_value v;\
+        char* s;\
+        EXPECT_TRUE(p != NULL);\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_projection(&v, json, strlen(json), p));\
+        s = lept_stringify(&v, NULL);\
+        EXPECT_EQ_BASE(strcmp(expect, s) == 0, expect, s, "%s");\
+        free_json(s);\
+        lept_free(&v);\
+        lept_projection_free(p);\
+    } while(0)
+
+static int projection_parse(lept_value* v, const char* json, const lept_projection* p) {
+    return lept_parse_projection(v, json, strlen(json), p);
+}
+
+static void test_parse_projection() {
+    static const char* bad[] = { "a", "/~2", "/a~" };
+    static const char* paths[] = { "/a/*/b" };
+    const char* json =
+        "{\"user\": {\"id\": 7, \"name\": \"x\"}, \"events\": [{\"ts\": 1}, {\"ts\": 2, \"x\": [1, {\"ts\": 9}]}, {\"y\": \"}\"}],"
+        " \"meta\": {\"region\": \"eu\"}, \"a/b\": 1, \"m~n\": 2, \"arr\": [10, 20, 30], \"*\": 3}";
+    lept_projection* p;
+    lept_value v;
+    size_t i;
+    for (i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        EXPECT_TRUE(lept_projection_compile(&bad[i], 1) == NULL);
+    }
+    TEST_PROJECTION("[[7],[1,2],[\"eu\"],[],[1],[2],[20],[],[3]]", json,
+        "/user/id", "/events/*/ts", "/meta/region", "/missing", "/a~1b", "/m~0n", "/arr/1", "/arr/01", "/*");
+    /* 路径在浅处结束时建立整个值 更深的路径在其中查找*/
+    TEST_PROJECTION("[[{\"id\":7,\"name\":\"x\"}],[\"x\"],[7],[7]]", json, "/user", "/user/name", "/user/id", "/user/id");
+    TEST_PROJECTION("[[[1,2,3]],[2],[1,2,3]]", "[1, 2, 3]", "", "/1", "/*");
+    /* 没有路径时越过整个文本*/
+    p = lept_projection_compile(NULL, 0);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_projection(&v, json, strlen(json), p));
+    EXPECT_EQ_SIZE_T(0, lept_get_array_size(&v));
+    lept_free(&v);
+    lept_projection_free(p);
+    /* 匹配到的部分按正常解析检查 越过的部分只检查括号和引号*/
+    p = lept_projection_compile(paths, 1);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, projection_parse(&v, "{\"x\": [tru, 1e999], \"a\": []}", p));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_INVALID_VALUE, projection_parse(&v, "{\"a\": [{\"b\": tru}]}", p));
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v));
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, projection_parse(&v, "{\"a\": [{\"b\": 1}, {\"b\": 2} }", p));
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_QUOTATION_MARK, projection_parse(&v, "{\"x\": \"abc}", p));
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_CURLY_BRACKET, projection_parse(&v, "{\"x\": [\"]\"}", p));
+    EXPECT_EQ_INT(LEPT_PARSE_ROOT_NOT_SINGULAR, projection_parse(&v, "{} x", p));
+    EXPECT_EQ_INT(LEPT_PARSE_EXPECT_VALUE, projection_parse(&v, " ", p));
+    lept_projection_free(p);
+}
+
+static void test_parse_intern() {
+    lept_intern* t = lept_intern_new();
+    lept_parse_options opts;
+    static const char* json = "{\"id\":1,\"a_rather_long_key_name\":\"a string value longer than 16\",\"s\":\"short\",\"o\":{\"id\":2}}";
+    lept_value v1, v2, v3;
+    const char* k;
+    char *s1, *s2;
+    char buf[64 * 40];
+    size_t len = 0, i;
+    lept_parse_options_init(&opts);
+    opts.flags = LEPT_PARSE_INTERN_STRINGS;
+    opts.intern = t;
+    /* 相同的内容得到同一个指针*/
+    k = lept_intern_string(t, "id", 2);
+    EXPECT_TRUE(k == lept_intern_string(t, "id", 2));
+    EXPECT_EQ_STRING("id", k, (size_t)2);
+    EXPECT_TRUE(k != lept_intern_string(t, "i", 1));
+    EXPECT_EQ_STRING("", lept_intern_string(t, "", 0), (size_t)0);
+    /* 两个文档的键和较长的字符串值共享同一份副本 结果与一次性解析相同*/
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v1, json, strlen(json), &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v2, json, strlen(json), &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v3, json));
+    for (i = 0; i < 4; i++) {
+        EXPECT_TRUE(lept_get_object_key(&v1, i) == lept_get_object_key(&v2, i));
+    }
+    EXPECT_TRUE(lept_get_object_key(&v1, 0) == k);
+    EXPECT_TRUE(lept_get_object_key(lept_get_object_value(&v1, 3), 0) == k);
+    EXPECT_TRUE(lept_get_string(lept_get_object_value(&v1, 1)) == lept_get_string(lept_get_object_value(&v2, 1)));
+    EXPECT_EQ_SIZE_T(1, lept_find_object_index(&v1, lept_intern_string(t, "a_rather_long_key_name", 22), 22));
+    EXPECT_EQ_SIZE_T(3, lept_find_object_index(&v2, "o", 1));
+    s1 = lept_stringify(&v1, NULL);
+    s2 = lept_stringify(&v3, NULL);
+    EXPECT_EQ_BASE(strcmp(s1, s2) == 0, s1, s2, "%s");
+    free_json(s1);
+    free_json(s2);
+    lept_free(&v1);
+    lept_free(&v2);
+    lept_free(&v3);
+    /* 有索引的对象 键的个数超过表的初始大小*/
+    len += sprintf(buf + len, "{");
+    for (i = 0; i < 100; i++) {
+        len += sprintf(buf + len, "%s\"key%d\":%d", i ? "," : "", (int)i, (int)i);
+    }
+    len += sprintf(buf + len, "}");
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v1, buf, len, &opts));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v2, buf, len, &opts));
+    EXPECT_EQ_SIZE_T(100, lept_get_object_size(&v1));
+    EXPECT_TRUE(lept_get_object_key(&v1, 99) == lept_get_object_key(&v2, 99));
+    EXPECT_EQ_SIZE_T(57, lept_find_object_index(&v1, "key57", 5));
+    EXPECT_EQ_SIZE_T(LEPT_KEY_NOT_EXIST, lept_find_object_index(&v1, "key100", 6));
+    lept_free(&v1);
+    lept_free(&v2);
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COLON, lept_parse_ex(&v1, "{\"key1\" 1}", 11, &opts));
+    lept_intern_free(t);
+}
+
+static void test_parse_parser() {
+    static const char* json[] = {
+        "null", "\"a string longer than the initial stack\"", "[1, [2, [3, [4]]]]", "[1,]",
+        "{\"n\":null,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"k\":\"v\\u00e9\"}}", "{\"a\" 1}", "[\"\\x\"]"
+    };
+    static const unsigned flags[] = { 0, LEPT_PARSE_LAZY };
+    lept_parse_options opts;
+    lept_arena a;
+    lept_parser* p;
+    lept_value v1, v2;
+    char *s1, *s2;
+    size_t i, j, k;
+    lept_parse_options_init(&opts);
+    lept_arena_init(&a, 0);
+    /* 栈从很小开始 错误之后继续使用 结果与一次性解析相同*/
+    for (k = 0; k < 3; k++) {
+        opts.flags = k < 2 ? flags[k] : 0;
+        opts.intern = NULL;
+        opts.arena = k < 2 ? NULL : &a;
+        p = lept_parser_new(&opts, k == 0 ? 0 : 4);
+        for (j = 0; j < 2; j++) {
+            for (i = 0; i < sizeof(json) / sizeof(json[0]); i++) {
+                int ret = lept_parse(&v1, json[i]);
+                v2.type = LEPT_FALSE;
+                EXPECT_EQ_INT(ret, lept_parser_parse(p, &v2, json[i], strlen(json[i])));
+                EXPECT_EQ_INT(lept_get_type(&v1), lept_get_type(&v2));
+                if (ret == LEPT_PARSE_OK) {
+                    s1 = lept_stringify(&v1, NULL);
+                    s2 = lept_stringify(&v2, NULL);
+                    EXPECT_EQ_BASE(strcmp(s1, s2) == 0, s1, s2, "%s");
+                    free_json(s1);
+                    free_json(s2);
+                }
+                lept_free(&v1);
+                lept_free(&v2);
+            }
+        }
+        lept_parser_free(p);
+        lept_arena_reset(&a);
+    }
+    p = lept_parser_new(NULL, 0);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parser_parse(p, &v1, "[true]", 6));
+    EXPECT_EQ_INT(LEPT_TRUE, lept_get_type(lept_get_array_element(&v1, 0)));
+    lept_free(&v1);
+    lept_parser_free(p);
+    lept_arena_destroy(&a);
+}
+
+static void test_parse_stats() {
+    static const char* json = " {\"a\" : [1, 2.5, \"x\\n\\u00e9\\ud83d\\ude00\"], \"b\" : {\"c\" : [[null]], \"d\" : true}} ";
+    lept_parse_options opts;
+    lept_parse_stats st;
+    lept_value v;
+    size_t i;
+    lept_parse_options_init(&opts);
+    opts.flags = LEPT_PARSE_STATS_CYCLES;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex_stats(&v, json, strlen(json), &opts, &st));
+    EXPECT_EQ_INT(LEPT_OBJECT, lept_get_type(&v));
+    lept_free(&v);
+#ifdef LEPT_STATS
+    EXPECT_EQ_SIZE_T(strlen(json), st.bytes);
+    EXPECT_EQ_SIZE_T(1, st.nodes[LEPT_NULL]);
+    EXPECT_EQ_SIZE_T(1, st.nodes[LEPT_TRUE]);
+    EXPECT_EQ_SIZE_T(2, st.nodes[LEPT_NUMBER]);
+    EXPECT_EQ_SIZE_T(1, st.nodes[LEPT_STRING]);
+    EXPECT_EQ_SIZE_T(3, st.nodes[LEPT_ARRAY]);
+    EXPECT_EQ_SIZE_T(2, st.nodes[LEPT_OBJECT]);
+    EXPECT_EQ_SIZE_T(4, st.keys);
+    /* 键4个字节 "x\n"2个字节 é 2个字节 表情4个字节*/
+    EXPECT_EQ_SIZE_T(12, st.string_bytes);
+    EXPECT_EQ_SIZE_T(4, st.escapes);
+    EXPECT_EQ_SIZE_T(3, st.unicode_escapes);
+    EXPECT_EQ_SIZE_T(1, st.surrogates);
+    EXPECT_EQ_SIZE_T(4, st.max_depth);
+    EXPECT_TRUE(st.stack_high_water > 0);
+    EXPECT_TRUE(st.allocs > 0 && st.alloc_bytes > 0);
+    /* 出错时记录出错的位置*/
+    opts.flags = 0;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex_stats(&v, json, strlen(json), &opts, &st));
+    lept_free(&v);
+    EXPECT_EQ_SIZE_T(4, st.keys);
+    EXPECT_EQ_SIZE_T(4, st.max_depth);
+    EXPECT_EQ_SIZE_T(0, st.cycles[LEPT_PHASE_CONTAINER]);
+    EXPECT_EQ_INT(LEPT_PARSE_MISS_COMMA_OR_SQUARE_BRACKET, lept_parse_ex_stats(&v, "[1, 2 x", 7, &opts, &st));
+    EXPECT_EQ_SIZE_T(6, st.bytes);
+    EXPECT_EQ_SIZE_T(2, st.nodes[LEPT_NUMBER]);
+#else
+    for (i = 0; i < LEPT_PHASE_COUNT; i++) {
+        EXPECT_TRUE(st.cycles[i] == 0);
+    }
+    EXPECT_EQ_SIZE_T(0, st.bytes);
+    EXPECT_EQ_SIZE_T(0, st.keys);
+#endif
+    (void)i;
+}
+
+static void test_parse_allocator() {
+    static const char* paths[] = { "/a/1" };
+    test_alloc_count global = { 0, 0 }, local = { 0, 0 }, block = { 0, 0 };
+    lept_allocator ga = { test_alloc, test_realloc, test_dealloc, NULL };
+    lept_allocator la = { test_alloc, test_realloc, test_dealloc, NULL };
+    lept_allocator ba = { test_alloc, test_realloc, test_dealloc, NULL };
+    lept_parse_options opts;
+    const char* json = "{\"a\":[1,2,3],\"b\":\"a string that is too long to be inline\"}";
+    lept_projection* pj;
+    lept_push_parser* pp;
+    lept_parser* p;
+    lept_intern* t;
+    lept_tape* tape;
+    lept_arena a;
+    lept_value v;
+    char* s;
+    lept_parse_options_init(&opts);
+    ga.user = &global;
+    la.user = &local;
+    ba.user = &block;
+    lept_set_allocator(&ga);
+
+    /* 栈和数组各一次*/
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "[1,2,3]"));
+    EXPECT_EQ_SIZE_T(2, global.allocs);
+    lept_free(&v);
+    EXPECT_EQ_SIZE_T(0, global.live);
+    s = lept_stringify(&v, NULL);
+    EXPECT_EQ_SIZE_T(1, global.live);
+    ga.free(ga.user, s);
+
+    /* 临时内存来自实例的分配器 结果来自全局分配器*/
+    opts.allocator = &la;
+    global.allocs = 0;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v, json, strlen(json), &opts));
+    EXPECT_TRUE(local.allocs > 0);
+    EXPECT_EQ_SIZE_T(0, local.live);
+    EXPECT_TRUE(global.allocs > 0);
+    lept_free(&v);
+    p = lept_parser_new(&opts, 0);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parser_parse(p, &v, json, strlen(json)));
+    lept_free(&v);
+    EXPECT_TRUE(local.live > 0);
+    lept_parser_free(p);
+    EXPECT_EQ_SIZE_T(0, local.live);
+
+    /* arena的块来自它自己的分配器*/
+    lept_arena_init(&a, 0);
+    a.allocator = &ba;
+    opts.arena = &a;
+    global.allocs = 0;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v, json, strlen(json), &opts));
+    EXPECT_EQ_SIZE_T(0, global.allocs);
+    EXPECT_EQ_SIZE_T(1, block.live);
+    lept_arena_destroy(&a);
+    EXPECT_EQ_SIZE_T(0, block.live);
+    opts.arena = NULL;
+
+    /* 其他的入口也都经过全局分配器*/
+    t = lept_intern_new();
+    opts.intern = t;
+    opts.flags = LEPT_PARSE_LAZY;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v, json, strlen(json), &opts));
+    EXPECT_EQ_INT(LEPT_STRING, lept_get_type(lept_find_object_value(&v, "b", 1)));
+    lept_free(&v);
+    opts.flags = 0;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v, json, strlen(json), &opts));
+    lept_free(&v);
+    lept_intern_free(t);
+    pj = lept_projection_compile(paths, 1);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_projection(&v, json, strlen(json), pj));
+    lept_free(&v);
+    lept_projection_free(pj);
+    pp = lept_push_parser_new(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_feed(pp, json, 10));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_feed(pp, json + 10, strlen(json) - 10));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_push_finish(pp));
+    lept_push_parser_free(pp);
+    lept_free(&v);
+    tape = lept_tape_new();
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_tape_parse(tape, json, strlen(json)));
+    lept_tape_free(tape);
+    lept_set_string(&v, "a string that is too long to be inline", 38);
+    lept_free(&v);
+    EXPECT_EQ_SIZE_T(0, global.live);
+    EXPECT_EQ_SIZE_T(0, local.live);
+
+    lept_set_allocator(&test_allocator);
+}
+
 static void test_parse() {
     test_parse_null();
     test_parse_true();
     test_parse_false();
     test_parse_number();
     test_parse_string();
+    test_parse_whitespace();
     test_parse_array();
+    test_parse_object();
+    test_find_object_value();
     test_parse_expect_value();
     test_parse_invalid_value();
     test_parse_root_not_singular();
@@ -276,6 +1586,375 @@ static void test_parse() {
     test_parse_invalid_unicode_hex();
     test_parse_invalid_unicode_surrogate();
     test_parse_miss_comma_or_square_bracket();
+    test_parse_miss_key();
+    test_parse_miss_colon();
+    test_parse_miss_comma_or_curly_bracket();
+    test_parse_depth_exceeded();
+    test_parse_arena();
+    test_parse_insitu();
+    test_parse_n();
+    test_parse_file();
+    test_parse_sax();
+    test_parse_push();
+    test_parse_push_sax();
+    test_parse_ndjson();
+    test_parse_lazy_skip();
+    test_parse_tape();
+    test_parse_binary();
+    test_parse_lazy();
+    test_parse_projection();
+    test_parse_intern();
+    test_parse_parser();
+    test_parse_stats();
+    test_parse_allocator();
+}
+
+#define TEST_ROUNDTRIP(json)\
+    do {\
+        lept_value v;\
+        char* json2;\
+        size_t length;\
+        lept_init(&v);\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, counted_parse(&parse_counts[2], &v, json));\
+        json2 = lept_stringify(&v, &length);\
+        EXPECT_EQ_STRING(json, json2, length);\
+        lept_free(&v);\
+        free_json(json2);\
+    } while(0)
+
+static void test_stringify_number() {
+    TEST_ROUNDTRIP("0");
+    TEST_ROUNDTRIP("-0");
+    TEST_ROUNDTRIP("1");
+    TEST_ROUNDTRIP("-1");
+    TEST_ROUNDTRIP("1.5");
+    TEST_ROUNDTRIP("-1.5");
+    TEST_ROUNDTRIP("3.25");
+    TEST_ROUNDTRIP("0.1");
+    TEST_ROUNDTRIP("0.000001");
+    TEST_ROUNDTRIP("1e-7");
+    TEST_ROUNDTRIP("1.234e-10");
+    TEST_ROUNDTRIP("100000000000000000000");
+    TEST_ROUNDTRIP("1e21");
+    TEST_ROUNDTRIP("-1.2345e30");
+    TEST_ROUNDTRIP("3.141592653589793");
+
+    TEST_ROUNDTRIP("1.0000000000000002"); /* the smallest number > 1 */
+    TEST_ROUNDTRIP("5e-324"); /* minimum denormal */
+    TEST_ROUNDTRIP("-5e-324");
+    TEST_ROUNDTRIP("2.225073858507201e-308");  /* Max subnormal double */
+    TEST_ROUNDTRIP("-2.225073858507201e-308");
+    TEST_ROUNDTRIP("2.2250738585072014e-308");  /* Min normal positive double */
+    TEST_ROUNDTRIP("-2.2250738585072014e-308");
+    TEST_ROUNDTRIP("1.7976931348623157e308");  /* Max double */
+    TEST_ROUNDTRIP("-1.7976931348623157e308");
+}
+
+/* 随机的位模式 生成后再解析必须得到相同的double*/
+static void test_stringify_number_lossless() {
+    unsigned long long x = 88172645463325252ULL;
+    int i, same = 1;
+    for (i = 0; i < 100000; i++) {
+        lept_value v, v2;
+        double d, d2;
+        char* json;
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        memcpy(&d, &x, sizeof(d));
+        if (d - d != 0.0) {
+            continue;
+        }
+        lept_init(&v);
+        lept_init(&v2);
+        lept_set_number(&v, d);
+        json = lept_stringify(&v, NULL);
+        if (lept_parse(&v2, json) != LEPT_PARSE_OK || (d2 = lept_get_number(&v2), memcmp(&d, &d2, sizeof(d)) != 0)) {
+            fprintf(stderr, "%s:%d: %.17g -> %s\n", __FILE__, __LINE__, d, json);
+            same = 0;
+        }
+        free_json(json);
+        lept_free(&v2);
+    }
+    EXPECT_TRUE(same);
+}
+
+static void test_stringify_string() {
+    TEST_ROUNDTRIP("\"\"");
+    TEST_ROUNDTRIP("\"Hello\"");
+    TEST_ROUNDTRIP("\"Hello\\nWorld\"");
+    TEST_ROUNDTRIP("\"\\\" \\\\ / \\b \\f \\n \\r \\t\"");
+    TEST_ROUNDTRIP("\"Hello\\u0000World\"");
+    TEST_ROUNDTRIP("\"\\u001F\\u0001\"");
+    TEST_ROUNDTRIP("\"\xE2\x82\xAC \xF0\x9D\x84\x9E\"");
+    /* 超过一个SIMD块的连续普通字符和转义混排*/
+    TEST_ROUNDTRIP("\"0123456789abcdef0123456789abcdef0123456789abcdef\\t0123456789abcdef0123456789abcdef\\\"\"");
+}
+
+static void test_stringify_array() {
+    TEST_ROUNDTRIP("[]");
+    TEST_ROUNDTRIP("[null,false,true,123,\"abc\",[1,2,3]]");
+}
+
+static void test_stringify_object() {
+    TEST_ROUNDTRIP("{}");
+    TEST_ROUNDTRIP("{\"n\":null,\"f\":false,\"t\":true,\"i\":123,\"s\":\"abc\",\"a\":[1,2,3],\"o\":{\"1\":1,\"2\":2,\"3\":3}}");
+}
+
+static void test_stringify_special() {
+    lept_value v;
+    char* json;
+    size_t length;
+    lept_init(&v);
+    lept_set_number(&v, HUGE_VAL);
+    json = lept_stringify(&v, &length);
+    EXPECT_EQ_STRING("null", json, length);
+    free_json(json);
+    lept_set_number(&v, 1e300 * 1e300 * 0.0);
+    json = lept_stringify(&v, &length);
+    EXPECT_EQ_STRING("null", json, length);
+    free_json(json);
+    lept_free(&v);
+}
+
+static void test_stringify_buffer() {
+    lept_value v;
+    char buf[16];
+    size_t length;
+    lept_init(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "[ 1.5, \"a\\tb\" ]"));
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify_buffer(&v, buf, sizeof(buf), &length));
+    EXPECT_EQ_STRING("[1.5,\"a\\tb\"]", buf, length);
+    EXPECT_EQ_INT('\0', buf[length]);
+    /* 刚好放下文本和'\0'*/
+    EXPECT_EQ_INT(LEPT_STRINGIFY_OK, lept_stringify_buffer(&v, buf, 13, &length));
+    EXPECT_EQ_STRING("[1.5,\"a\\tb\"]", buf, length);
+    /* 放不下时给出需要的长度*/
+    length = 0;
+    EXPECT_EQ_INT(LEPT_STRINGIFY_BUFFER_TOO_SMALL, lept_stringify_buffer(&v, buf, 12, &length));
+    EXPECT_EQ_SIZE_T(12, length);
+    length = 0;
+    EXPECT_EQ_INT(LEPT_STRINGIFY_BUFFER_TOO_SMALL, lept_stringify_buffer(&v, NULL, 0, &length));
+    EXPECT_EQ_SIZE_T(12, length);
+    lept_free(&v);
+}
+
+static void test_stringify() {
+    test_stringify_number();
+    test_stringify_number_lossless();
+    test_stringify_string();
+    test_stringify_array();
+    test_stringify_object();
+    test_stringify_special();
+    test_stringify_buffer();
+}
+
+#define TEST_EQUAL(json1, json2, equality) \
+    do {\
+        lept_value v1, v2;\
+        lept_init(&v1);\
+        lept_init(&v2);\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v1, json1));\
+        EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v2, json2));\
+        EXPECT_EQ_INT(equality, lept_is_equal(&v1, &v2));\
+        EXPECT_EQ_INT(equality, lept_is_equal(&v2, &v1));\
+        if (equality) {\
+            EXPECT_TRUE(lept_hash(&v1) == lept_hash(&v2));\
+        }\
+        lept_free(&v1);\
+        lept_free(&v2);\
+    } while(0)
+
+static void test_equal_basic() {
+    TEST_EQUAL("true", "true", 1);
+    TEST_EQUAL("true", "false", 0);
+    TEST_EQUAL("false", "false", 1);
+    TEST_EQUAL("null", "null", 1);
+    TEST_EQUAL("null", "0", 0);
+    TEST_EQUAL("123", "123", 1);
+    TEST_EQUAL("123", "456", 0);
+    TEST_EQUAL("0", "-0", 1);
+    TEST_EQUAL("1e2", "100", 1);
+    TEST_EQUAL("\"abc\"", "\"abc\"", 1);
+    TEST_EQUAL("\"abc\"", "\"abcd\"", 0);
+    TEST_EQUAL("\"a\\u0000b\"", "\"a\\u0000c\"", 0);
+    TEST_EQUAL("\"a string longer than inline\"", "\"a string longer than inline\"", 1);
+    TEST_EQUAL("\"a string longer than inline\"", "\"a string longer than inlinE\"", 0);
+    TEST_EQUAL("[]", "[]", 1);
+    TEST_EQUAL("[]", "null", 0);
+    TEST_EQUAL("[1,2,3]", "[1,2,3]", 1);
+    TEST_EQUAL("[1,2,3]", "[1,2,3,4]", 0);
+    TEST_EQUAL("[1,2,3]", "[3,2,1]", 0);
+    TEST_EQUAL("[[]]", "[[]]", 1);
+    TEST_EQUAL("{}", "{}", 1);
+    TEST_EQUAL("{}", "null", 0);
+    TEST_EQUAL("{}", "[]", 0);
+    TEST_EQUAL("{\"a\":1,\"b\":2}", "{\"a\":1,\"b\":2}", 1);
+    TEST_EQUAL("{\"a\":1,\"b\":2}", "{\"b\":2,\"a\":1}", 1);
+    TEST_EQUAL("{\"a\":1,\"b\":2}", "{\"a\":1,\"b\":3}", 0);
+    TEST_EQUAL("{\"a\":1,\"b\":2}", "{\"a\":1,\"b\":2,\"c\":3}", 0);
+    TEST_EQUAL("{\"a\":1,\"b\":2}", "{\"a\":1,\"c\":2}", 0);
+    TEST_EQUAL("{\"a\":{\"b\":{\"c\":{}}}}", "{\"a\":{\"b\":{\"c\":{}}}}", 1);
+    TEST_EQUAL("{\"a\":{\"b\":{\"c\":{}}}}", "{\"a\":{\"b\":{\"c\":[]}}}", 0);
+    TEST_EQUAL("{\"a\":[1,{\"x\":\"y\",\"z\":null}]}", "{\"a\":[1,{\"z\":null,\"x\":\"y\"}]}", 1);
+    /* 有重复键时只有顺序相同才相等*/
+    TEST_EQUAL("{\"a\":1,\"a\":1}", "{\"a\":1,\"a\":1}", 1);
+    TEST_EQUAL("{\"a\":1,\"a\":2}", "{\"a\":1,\"a\":2}", 1);
+    TEST_EQUAL("{\"a\":1,\"a\":2}", "{\"a\":2,\"a\":1}", 0);
+    TEST_EQUAL("{\"a\":1,\"a\":1}", "{\"a\":1,\"b\":1}", 0);
+    TEST_EQUAL("{\"a\":1,\"b\":2,\"a\":1}", "{\"b\":2,\"a\":1,\"a\":1}", 0);
+    TEST_EQUAL("{\"a\":1,\"a\":1,\"b\":2}", "{\"a\":1,\"b\":2,\"b\":2}", 0);
+    TEST_EQUAL("{\"a\":1,\"b\":2,\"c\":3}", "{\"a\":1,\"c\":3,\"b\":2}", 1);
+}
+
+/* 成员较多时通过索引查找 NaN与自己相等 不同的解析方式结果相同*/
+static void test_equal_special() {
+    static const char* keys[] = { "\"k0\"", "\"k1\"", "\"k2\"", "\"k3\"", "\"k4\"", "\"k5\"", "\"k6\"", "\"k7\"", "\"k8\"", "\"k9\"",
+        "\"k10\"", "\"k11\"", "\"k12\"", "\"k13\"", "\"k14\"", "\"k15\"", "\"k16\"", "\"k17\"", "\"k18\"", "\"k19\"" };
+    char json1[512], json2[512];
+    size_t i, n1 = 0, n2 = 0;
+    lept_parse_options opts;
+    lept_value v1, v2;
+
+    lept_parse_options_init(&opts);
+    opts.flags = LEPT_PARSE_LAZY;
+    json1[n1++] = json2[n2++] = '{';
+    for (i = 0; i < 20; i++) {
+        n1 += (size_t)sprintf(json1 + n1, "%s%s:%d", i ? "," : "", keys[i], (int)i);
+        n2 += (size_t)sprintf(json2 + n2, "%s%s:%d", i ? "," : "", keys[19 - i], (int)(19 - i));
+    }
+    json1[n1++] = json2[n2++] = '}';
+    json1[n1] = json2[n2] = '\0';
+    TEST_EQUAL(json1, json2, 1);
+    json2[n2 - 2] = '1';
+    TEST_EQUAL(json1, json2, 0);
+
+    lept_init(&v1);
+    lept_init(&v2);
+    lept_set_number(&v1, 1e300 * 1e300 * 0.0);
+    lept_copy(&v2, &v1);
+    EXPECT_TRUE(lept_is_equal(&v1, &v2));
+    EXPECT_TRUE(lept_hash(&v1) == lept_hash(&v2));
+
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v1, json1));
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v2, json1, strlen(json1), &opts));
+    EXPECT_TRUE(lept_is_equal(&v1, &v2));
+    EXPECT_TRUE(lept_hash(&v1) == lept_hash(&v2));
+    lept_free(&v2);
+    opts.flags = 0;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_ex(&v2, json2, strlen(json2), &opts));
+    EXPECT_FALSE(lept_is_equal(&v1, &v2));
+    lept_free(&v1);
+    lept_free(&v2);
+}
+
+/* 共享的内存缓存散列值 只剩一个所有者并修改之后重新计算*/
+static void test_equal_cached_hash() {
+    lept_value v1, v2, v3;
+    uint64_t h;
+    lept_init(&v2);
+    lept_init(&v3);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v1, "[1,2,{\"a\":\"a string longer than inline\"}]"));
+    h = lept_hash(&v1);
+    lept_copy(&v2, &v1);
+    EXPECT_TRUE(lept_is_equal(&v1, &v2));
+    EXPECT_TRUE(h == lept_hash(&v2));
+    EXPECT_TRUE(h == lept_hash(&v1));
+
+    /* 修改时复制一层 缓存不会带到新的内存中*/
+    lept_set_number(lept_pushback_array_element(&v2), 3.0);
+    EXPECT_FALSE(lept_is_equal(&v1, &v2));
+    EXPECT_TRUE(h != lept_hash(&v2));
+    lept_copy(&v3, &v2);
+    EXPECT_FALSE(lept_is_equal(&v1, &v3));
+
+    /* v1重新成为唯一的所有者 原地修改后散列值随之改变*/
+    lept_free(&v2);
+    lept_free(&v3);
+    lept_copy(&v2, &v1);
+    EXPECT_TRUE(h == lept_hash(&v2));
+    lept_free(&v2);
+    lept_set_number(lept_get_array_element(&v1, 0), 0.0);
+    EXPECT_TRUE(h != lept_hash(&v1));
+    lept_free(&v1);
+}
+
+#ifdef TEST_HAVE_PTHREADS
+typedef struct {
+    lept_value v; /* 这个线程自己的副本 与其他线程共享内存*/
+    uint64_t hash;
+    int ok;
+} hash_thread_arg;
+
+/* 同时计算和比较共享的值 缓存的散列值被并发地读写*/
+static void* hash_thread(void* p) {
+    hash_thread_arg* arg = (hash_thread_arg*)p;
+    lept_value c;
+    int i;
+    lept_init(&c);
+    arg->ok = 1;
+    for (i = 0; i < 200; i++) {
+        lept_copy(&c, &arg->v);
+        arg->ok &= lept_hash(&c) == arg->hash && lept_is_equal(&c, &arg->v);
+        lept_free(&c);
+    }
+    lept_free(&arg->v);
+    return NULL;
+}
+#endif
+
+/* 多个线程同时读取和释放之后 剩下的所有者原地修改 散列值不能沿用之前的缓存*/
+static void test_equal_hash_threads() {
+#ifdef TEST_HAVE_PTHREADS
+    hash_thread_arg args[4];
+    pthread_t threads[4];
+    lept_value v, c, w;
+    uint64_t h;
+    int i;
+    lept_init(&c);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, "[1,\"a string longer than inline\",{\"x\":null,\"y\":[true]}]"));
+    h = lept_hash(&v);
+    for (i = 0; i < 4; i++) {
+        lept_init(&args[i].v);
+        lept_copy(&args[i].v, &v);
+        args[i].hash = h;
+    }
+    for (i = 0; i < 4; i++) {
+        EXPECT_EQ_INT(0, pthread_create(&threads[i], NULL, hash_thread, &args[i]));
+    }
+    for (i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+        EXPECT_TRUE(args[i].ok);
+    }
+
+    /* 通过取得的指针修改 再次共享时重新计算*/
+    lept_set_number(lept_get_array_element(&v, 0), 2.0);
+    lept_copy(&c, &v);
+    EXPECT_TRUE(lept_hash(&c) != h);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&w, "[2,\"a string longer than inline\",{\"x\":null,\"y\":[true]}]"));
+    EXPECT_TRUE(lept_is_equal(&c, &w));
+    EXPECT_TRUE(lept_hash(&c) == lept_hash(&w));
+    h = lept_hash(&c);
+    lept_free(&c);
+
+    /* 通过修改函数原地修改*/
+    lept_popback_array_element(&v);
+    lept_copy(&c, &v);
+    EXPECT_TRUE(lept_hash(&c) != h);
+    lept_popback_array_element(&w);
+    EXPECT_TRUE(lept_is_equal(&c, &w));
+    EXPECT_TRUE(lept_hash(&c) == lept_hash(&w));
+    lept_free(&c);
+    lept_free(&v);
+    lept_free(&w);
+#endif
+}
+
+static void test_equal() {
+    test_equal_basic();
+    test_equal_special();
+    test_equal_cached_hash();
+    test_equal_hash_threads();
 }
 
 static void test_access_null() {
@@ -317,16 +1996,403 @@ static void test_access_string() {
     lept_free(&v);
 }
 
+/* 短字符串和短键直接存放在结点中 长字符串和长键另外分配*/
+static void test_access_inline_string() {
+    const char* s15 = "0123456789abcde";
+    const char* s16 = "0123456789abcdef";
+    const char* json = "{\"\":\"\",\"0123456789abcde\":\"0123456789abcdef\",\"0123456789abcdef\":[\"0123456789abcde\"]}";
+    lept_value v;
+    lept_value* e;
+    char* out;
+    lept_init(&v);
+    lept_set_string(&v, s15, 15);
+    EXPECT_EQ_STRING("0123456789abcde", lept_get_string(&v), lept_get_string_length(&v));
+    EXPECT_TRUE(lept_get_string(&v) >= (const char*)&v && lept_get_string(&v) < (const char*)(&v + 1));
+    lept_set_string(&v, s16, 16);
+    EXPECT_EQ_STRING("0123456789abcdef", lept_get_string(&v), lept_get_string_length(&v));
+    lept_set_string(&v, "a\0b", 3);
+    EXPECT_EQ_STRING("a\0b", lept_get_string(&v), lept_get_string_length(&v));
+    lept_free(&v);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+    EXPECT_EQ_SIZE_T(3, lept_get_object_size(&v));
+    EXPECT_EQ_STRING("", lept_get_object_key(&v, 0), lept_get_object_key_length(&v, 0));
+    EXPECT_EQ_STRING("0123456789abcde", lept_get_object_key(&v, 1), lept_get_object_key_length(&v, 1));
+    EXPECT_EQ_STRING("0123456789abcdef", lept_get_object_key(&v, 2), lept_get_object_key_length(&v, 2));
+    e = lept_find_object_value(&v, s15, 15);
+    EXPECT_EQ_STRING("0123456789abcdef", lept_get_string(e), lept_get_string_length(e));
+    /* 给成员赋新值不影响直接存放的键*/
+    lept_set_string(e, "x", 1);
+    lept_set_number(lept_find_object_value(&v, "", 0), 1.0);
+    EXPECT_EQ_STRING("0123456789abcde", lept_get_object_key(&v, 1), lept_get_object_key_length(&v, 1));
+    e = lept_get_array_element(lept_find_object_value(&v, s16, 16), 0);
+    EXPECT_EQ_STRING("0123456789abcde", lept_get_string(e), lept_get_string_length(e));
+    out = lept_stringify(&v, NULL);
+    EXPECT_EQ_BASE(strcmp(out, "{\"\":1,\"0123456789abcde\":\"x\",\"0123456789abcdef\":[\"0123456789abcde\"]}") == 0, "equal", out, "%s");
+    free_json(out);
+    lept_free(&v);
+}
+
+/* 生成的文本与expect相同*/
+#define EXPECT_EQ_JSON(expect, v)\
+    do {\
+        char* out = lept_stringify(v, NULL);\
+        EXPECT_EQ_BASE(strcmp(expect, out) == 0, expect, out, "%s");\
+        free_json(out);\
+    } while(0)
+
+static void test_access_copy() {
+    const char* json = "{\"k\":[1,\"a string longer than inline\",{\"x\":null}],\"key that is not inline\":\"v\"}";
+    lept_arena a;
+    lept_value v1, v2, v3;
+    char buf[128];
+    lept_init(&v1);
+    lept_init(&v2);
+    lept_init(&v3);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v1, json));
+    /* 副本与原来的值共享内存 释放原来的值后仍然有效*/
+    lept_copy(&v2, &v1);
+    lept_copy(&v3, lept_find_object_value(&v1, "k", 1));
+    EXPECT_TRUE(lept_get_object_value(&v1, 0) == lept_get_object_value(&v2, 0));
+    EXPECT_TRUE(lept_get_array_element(&v3, 1) == lept_get_array_element(lept_get_object_value(&v2, 0), 1));
+    lept_free(&v1);
+    EXPECT_EQ_JSON(json, &v2);
+    lept_free(&v2);
+    EXPECT_EQ_JSON("[1,\"a string longer than inline\",{\"x\":null}]", &v3);
+    /* v3独占它的内存 可以修改子结点 复制给成员时保留成员的键*/
+    lept_copy(lept_get_object_value(lept_get_array_element(&v3, 2), 0), lept_get_array_element(&v3, 1));
+    EXPECT_EQ_JSON("[1,\"a string longer than inline\",{\"x\":\"a string longer than inline\"}]", &v3);
+    EXPECT_EQ_STRING("x", lept_get_object_key(lept_get_array_element(&v3, 2), 0), 1);
+    lept_free(&v3);
+
+    /* arena中的值深复制 arena释放后副本仍然有效*/
+    lept_arena_init(&a, 0);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_arena(&v1, &a, json));
+    lept_copy(&v2, &v1);
+    lept_arena_destroy(&a);
+    EXPECT_EQ_JSON(json, &v2);
+    lept_free(&v2);
+
+    /* 修改后数组属于v1 但子结点仍在arena中 同样深复制*/
+    lept_arena_init(&a, 0);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_arena(&v1, &a, json));
+    lept_pushback_array_element(lept_set_object_value(&v1, "k", 1));
+    lept_copy(&v2, lept_find_object_value(&v1, "k", 1));
+    lept_free(&v1);
+    lept_arena_destroy(&a);
+    EXPECT_EQ_JSON("[1,\"a string longer than inline\",{\"x\":null},null]", &v2);
+    lept_free(&v2);
+
+    /* 原地解析的容器属于v1 其中的字符串在输入中 副本不依赖输入*/
+    strcpy(buf, json);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_insitu(&v1, buf, strlen(buf)));
+    lept_copy(&v2, &v1);
+    lept_copy(&v3, lept_find_object_value(&v1, "k", 1));
+    lept_free(&v1);
+    memset(buf, 'X', sizeof(buf));
+    EXPECT_EQ_JSON(json, &v2);
+    EXPECT_EQ_JSON("[1,\"a string longer than inline\",{\"x\":null}]", &v3);
+    lept_free(&v2);
+    lept_free(&v3);
+}
+
+static void test_access_move() {
+    lept_value v1, v2, v3;
+    lept_init(&v1);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v1, "{\"t\":true,\"f\":false,\"n\":null,\"a\":[1,2]}"));
+    lept_init(&v2);
+    lept_init(&v3);
+    lept_set_string(&v3, "a string longer than inline", 27);
+    lept_move(&v2, &v1);
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v1));
+    EXPECT_EQ_SIZE_T(4, lept_get_object_size(&v2));
+    /* 成员的键不随值移动*/
+    lept_move(lept_get_object_value(&v2, 3), &v3);
+    EXPECT_EQ_INT(LEPT_NULL, lept_get_type(&v3));
+    EXPECT_EQ_JSON("{\"t\":true,\"f\":false,\"n\":null,\"a\":\"a string longer than inline\"}", &v2);
+    lept_free(&v2);
+}
+
+static void test_access_swap() {
+    lept_value v1, v2;
+    lept_init(&v1);
+    lept_init(&v2);
+    lept_set_string(&v1, "Hello", 5);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v2, "{\"a\":[\"World!\"]}"));
+    lept_swap(&v1, &v2);
+    EXPECT_EQ_STRING("Hello", lept_get_string(&v2), lept_get_string_length(&v2));
+    EXPECT_EQ_JSON("{\"a\":[\"World!\"]}", &v1);
+    lept_swap(lept_get_array_element(lept_get_object_value(&v1, 0), 0), &v2);
+    lept_swap(&v1, &v1);
+    EXPECT_EQ_JSON("{\"a\":[\"Hello\"]}", &v1);
+    EXPECT_EQ_STRING("World!", lept_get_string(&v2), lept_get_string_length(&v2));
+    lept_free(&v1);
+    lept_free(&v2);
+}
+
+static void test_access_array() {
+    lept_value a, e;
+    size_t i, j;
+
+    lept_init(&a);
+    for (j = 0; j <= 5; j += 5) {
+        lept_set_array(&a, j);
+        EXPECT_EQ_SIZE_T(0, lept_get_array_size(&a));
+        EXPECT_EQ_SIZE_T(j, lept_get_array_capacity(&a));
+        for (i = 0; i < 10; i++) {
+            lept_init(&e);
+            lept_set_number(&e, (double)i);
+            lept_move(lept_pushback_array_element(&a), &e);
+            lept_free(&e);
+        }
+        EXPECT_EQ_SIZE_T(10, lept_get_array_size(&a));
+        for (i = 0; i < 10; i++) {
+            EXPECT_EQ_DOUBLE((double)i, lept_get_number(lept_get_array_element(&a, i)));
+        }
+    }
+
+    lept_popback_array_element(&a);
+    EXPECT_EQ_SIZE_T(9, lept_get_array_size(&a));
+    lept_erase_array_element(&a, 4, 0);
+    EXPECT_EQ_SIZE_T(9, lept_get_array_size(&a));
+    lept_erase_array_element(&a, 8, 1);
+    lept_erase_array_element(&a, 0, 2);
+    EXPECT_EQ_SIZE_T(6, lept_get_array_size(&a));
+    for (i = 0; i < 6; i++) {
+        EXPECT_EQ_DOUBLE((double)i + 2, lept_get_number(lept_get_array_element(&a, i)));
+    }
+    for (i = 0; i < 2; i++) {
+        lept_set_number(lept_insert_array_element(&a, i), (double)i);
+    }
+    EXPECT_EQ_SIZE_T(8, lept_get_array_size(&a));
+    for (i = 0; i < 8; i++) {
+        EXPECT_EQ_DOUBLE((double)i, lept_get_number(lept_get_array_element(&a, i)));
+    }
+    EXPECT_TRUE(lept_get_array_capacity(&a) > 8);
+    lept_shrink_array(&a);
+    EXPECT_EQ_SIZE_T(8, lept_get_array_capacity(&a));
+    lept_set_string(lept_insert_array_element(&a, 8), "a string longer than inline", 27);
+    lept_clear_array(&a);
+    EXPECT_EQ_SIZE_T(0, lept_get_array_size(&a));
+    EXPECT_TRUE(lept_get_array_capacity(&a) > 8);
+    lept_shrink_array(&a);
+    EXPECT_EQ_SIZE_T(0, lept_get_array_capacity(&a));
+    lept_free(&a);
+
+    /* 解析出的数组容量等于大小*/
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&a, "[1,2,3]"));
+    EXPECT_EQ_SIZE_T(3, lept_get_array_capacity(&a));
+    lept_reserve_array(&a, 100);
+    EXPECT_EQ_SIZE_T(100, lept_get_array_capacity(&a));
+    lept_free(&a);
+}
+
+static void test_access_object() {
+    lept_value o, v, *pv;
+    size_t i, j, index;
+    char key[] = "key with a long name  ";
+
+    lept_init(&o);
+    for (j = 0; j <= 5; j += 5) {
+        lept_set_object(&o, j);
+        EXPECT_EQ_SIZE_T(0, lept_get_object_size(&o));
+        EXPECT_EQ_SIZE_T(j, lept_get_object_capacity(&o));
+        for (i = 0; i < 10; i++) {
+            char k[2] = "a";
+            k[0] += (char)i;
+            lept_init(&v);
+            lept_set_number(&v, (double)i);
+            lept_move(lept_set_object_value(&o, k, 1), &v);
+            lept_free(&v);
+        }
+        EXPECT_EQ_SIZE_T(10, lept_get_object_size(&o));
+        for (i = 0; i < 10; i++) {
+            char k[] = "a";
+            k[0] += (char)i;
+            index = lept_find_object_index(&o, k, 1);
+            EXPECT_TRUE(index != LEPT_KEY_NOT_EXIST);
+            pv = lept_get_object_value(&o, index);
+            EXPECT_EQ_DOUBLE((double)i, lept_get_number(pv));
+        }
+    }
+
+    index = lept_find_object_index(&o, "j", 1);
+    EXPECT_TRUE(index != LEPT_KEY_NOT_EXIST);
+    lept_remove_object_value(&o, index);
+    index = lept_find_object_index(&o, "j", 1);
+    EXPECT_TRUE(index == LEPT_KEY_NOT_EXIST);
+    EXPECT_EQ_SIZE_T(9, lept_get_object_size(&o));
+
+    index = lept_find_object_index(&o, "a", 1);
+    EXPECT_TRUE(index != LEPT_KEY_NOT_EXIST);
+    lept_remove_object_value(&o, index);
+    index = lept_find_object_index(&o, "a", 1);
+    EXPECT_TRUE(index == LEPT_KEY_NOT_EXIST);
+    EXPECT_EQ_SIZE_T(8, lept_get_object_size(&o));
+
+    EXPECT_TRUE(lept_get_object_capacity(&o) > 8);
+    lept_shrink_object(&o);
+    EXPECT_EQ_SIZE_T(8, lept_get_object_capacity(&o));
+    for (i = 0; i < 8; i++) {
+        char k[] = "a";
+        k[0] += (char)(i + 1);
+        EXPECT_EQ_DOUBLE((double)i + 1, lept_get_number(lept_get_object_value(&o, lept_find_object_index(&o, k, 1))));
+    }
+
+    lept_set_string(&v, "Hello", 5);
+    lept_move(lept_set_object_value(&o, "World", 5), &v); /* Test if element is freed */
+    lept_free(&v);
+
+    pv = lept_find_object_value(&o, "World", 5);
+    EXPECT_TRUE(pv != NULL);
+    EXPECT_EQ_STRING("Hello", lept_get_string(pv), lept_get_string_length(pv));
+
+    i = lept_get_object_capacity(&o);
+    lept_clear_object(&o);
+    EXPECT_EQ_SIZE_T(0, lept_get_object_size(&o));
+    EXPECT_EQ_SIZE_T(i, lept_get_object_capacity(&o)); /* capacity remains unchanged */
+    lept_shrink_object(&o);
+    EXPECT_EQ_SIZE_T(0, lept_get_object_capacity(&o));
+
+    /* 成员较多时索引随插入和删除保持一致 长键单独存放*/
+    for (i = 0; i < 200; i++) {
+        key[20] = (char)('0' + i / 10 % 10);
+        key[21] = (char)('0' + i % 10);
+        lept_set_number(lept_set_object_value(&o, key, i < 100 ? 22 : 21), (double)i);
+    }
+    EXPECT_EQ_SIZE_T(110, lept_get_object_size(&o));
+    for (i = 0; i < 100; i += 2) {
+        key[20] = (char)('0' + i / 10 % 10);
+        key[21] = (char)('0' + i % 10);
+        lept_remove_object_value(&o, lept_find_object_index(&o, key, 22));
+    }
+    EXPECT_EQ_SIZE_T(60, lept_get_object_size(&o));
+    for (i = 0; i < 100; i++) {
+        key[20] = (char)('0' + i / 10 % 10);
+        key[21] = (char)('0' + i % 10);
+        pv = lept_find_object_value(&o, key, 22);
+        EXPECT_TRUE(i % 2 ? pv != NULL && lept_get_number(pv) == (double)i : pv == NULL);
+    }
+    for (i = 0; i < 10; i++) {
+        key[20] = (char)('0' + i);
+        pv = lept_find_object_value(&o, key, 21);
+        EXPECT_TRUE(pv != NULL && lept_get_number(pv) == (double)(109 + 10 * i));
+    }
+    lept_free(&o);
+}
+
+/* 修改时先复制共享的内存 其他副本不受影响*/
+static void test_access_copy_on_write() {
+    const char* json = "{\"a\":[1,2,{\"b\":\"a string longer than inline\"}],\"c\":{}}";
+    lept_arena arena;
+    lept_value v1, v2, *a;
+    lept_init(&v2);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v1, json));
+    lept_copy(&v2, &v1);
+    a = lept_set_object_value(&v2, "a", 1);
+    lept_pushback_array_element(a);
+    lept_reserve_array(a, 0);
+    lept_set_number(lept_get_array_element(a, 0), 0.0);
+    lept_set_object_value(lept_get_array_element(a, 2), "d", 1);
+    lept_set_boolean(lept_set_object_value(&v2, "e", 1), 1);
+    lept_remove_object_value(&v2, lept_find_object_index(&v2, "c", 1));
+    EXPECT_EQ_JSON(json, &v1);
+    EXPECT_EQ_JSON("{\"a\":[0,2,{\"b\":\"a string longer than inline\",\"d\":null},null],\"e\":true}", &v2);
+    lept_free(&v1);
+    EXPECT_EQ_JSON("{\"a\":[0,2,{\"b\":\"a string longer than inline\",\"d\":null},null],\"e\":true}", &v2);
+    lept_free(&v2);
+
+    /* arena中的容器修改时复制到自己的内存中*/
+    lept_arena_init(&arena, 0);
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse_arena(&v1, &arena, json));
+    lept_erase_array_element(lept_set_object_value(&v1, "a", 1), 0, 2);
+    lept_clear_object(lept_set_object_value(&v1, "c", 1));
+    EXPECT_EQ_JSON("{\"a\":[{\"b\":\"a string longer than inline\"}],\"c\":{}}", &v1);
+    lept_free(&v1);
+    lept_arena_destroy(&arena);
+}
+
+#ifdef TEST_HAVE_PTHREADS
+typedef struct {
+    lept_value v; /* 这个线程自己的副本 与其他线程共享内存*/
+    const char* expect;
+    int ok;
+} copy_thread_arg;
+
+/* 反复复制、读取和释放 最后释放自己的副本 与其他线程同时减少引用计数*/
+static void* copy_thread(void* p) {
+    copy_thread_arg* arg = (copy_thread_arg*)p;
+    lept_value c;
+    char* s;
+    int i;
+    lept_init(&c);
+    arg->ok = 1;
+    for (i = 0; i < 200; i++) {
+        lept_copy(&c, &arg->v);
+        s = lept_stringify(&c, NULL);
+        arg->ok &= strcmp(s, arg->expect) == 0;
+        free_json(s);
+        lept_copy(&c, lept_get_object_value(&arg->v, 0));
+        arg->ok &= lept_get_array_size(&c) == 3;
+        lept_free(&c);
+    }
+    lept_free(&arg->v);
+    return NULL;
+}
+#endif
+
+/* 共享内存的副本可以在多个线程中同时读取和释放*/
+static void test_access_copy_threads() {
+#ifdef TEST_HAVE_PTHREADS
+    const char* json = "{\"k\":[1,\"a string longer than inline\",{\"x\":null}],\"key that is not inline\":\"v\"}";
+    copy_thread_arg args[4];
+    pthread_t threads[4];
+    lept_value v;
+    int i;
+    EXPECT_EQ_INT(LEPT_PARSE_OK, lept_parse(&v, json));
+    for (i = 0; i < 4; i++) {
+        lept_init(&args[i].v);
+        lept_copy(&args[i].v, &v);
+        args[i].expect = json;
+    }
+    lept_free(&v);
+    for (i = 0; i < 4; i++) {
+        EXPECT_EQ_INT(0, pthread_create(&threads[i], NULL, copy_thread, &args[i]));
+    }
+    for (i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+        EXPECT_TRUE(args[i].ok);
+    }
+#endif
+}
+
 static void test_access() {
     test_access_null();
     test_access_boolean();
     test_access_number();
     test_access_string();
+    test_access_inline_string();
+    test_access_copy();
+    test_access_move();
+    test_access_swap();
+    test_access_array();
+    test_access_object();
+    test_access_copy_on_write();
+    test_access_copy_threads();
 }
 
 int main() {
+    size_t i;
+    lept_set_allocator(&test_allocator);
     test_parse();
+    test_stringify();
+    test_equal();
     test_access();
+    EXPECT_EQ_SIZE_T(0, test_allocs.live);
+    lept_set_allocator(NULL);
+    for (i = 0; i < sizeof(parse_counts) / sizeof(parse_counts[0]); i++) {
+        printf("%-9s %4lu parses %6.2f allocations per parse\n", parse_counts[i].name,
+            (unsigned long)parse_counts[i].parses, (double)parse_counts[i].allocs / parse_counts[i].parses);
+    }
     printf("%d/%d (%3.2f%%) passed\n", test_pass, test_count, test_pass * 100.0 / test_count);
     return main_ret;
 }